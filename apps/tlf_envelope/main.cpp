@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "controller/Controller.hpp"
+#include "model/FeasibilityEnvelope.hpp"
+#include "sim/Simulation.hpp"
+
+using namespace tlf;
+
+static void usage() {
+  std::cerr << "Usage: tlf_envelope --out FILE [--threads N] [--s-bins N] [--pitch-bins N] [--samples N] [--check]\n"
+               "Builds the feasibility envelope of the docking demo container (demo rack, forklift and margins)\n"
+               "and writes it to FILE. --check maps the file back and runs the demo with and without it.\n";
+}
+
+static void printRun(const char* label, const sim::RunSummary& r, double wall_s) {
+  std::printf("%-14s completed=%d door=%.1f s end=%.1f s stop=%d min_clear=%.4f m wall=%.3f s\n", label,
+              r.completed ? 1 : 0, r.time_to_door_s, r.time_to_end_s, r.stop_steps,
+              std::min(r.min_clearance_top_m, r.min_clearance_bottom_m), wall_s);
+}
+
+// Offline builder for Controller::setFeasibilityEnvelope tables.
+int main(int argc, char** argv) {
+  std::string out_path;
+  int threads = 1;
+  bool check = false;
+  EnvelopeSpec spec;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (a == "--out" && has_value) {
+      out_path = argv[++i];
+    } else if (a == "--threads" && has_value) {
+      threads = std::stoi(argv[++i]);
+    } else if (a == "--s-bins" && has_value) {
+      spec.s_bins = std::stoi(argv[++i]);
+    } else if (a == "--pitch-bins" && has_value) {
+      spec.pitch_bins = std::stoi(argv[++i]);
+    } else if (a == "--samples" && has_value) {
+      spec.lift_samples = spec.tilt_samples = std::stoi(argv[++i]);
+    } else if (a == "--check") {
+      check = true;
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (out_path.empty()) {
+    usage();
+    return 2;
+  }
+
+  const sim::Scenario sc = sim::dockingDemoScenario();
+  const ControllerConfig cfg = sim::dockingDemoConfig(ControllerKind::GridSearch);
+  spec.margin_top_m = cfg.margin_top_m;
+  spec.margin_bottom_m = cfg.margin_bottom_m;
+
+  EnvironmentGeometry env;
+  env.profile = std::make_shared<const TerrainProfile>(sim::buildTerrainProfile(sc.env));
+
+  const auto t0 = std::chrono::steady_clock::now();
+  const FeasibilityEnvelope built = FeasibilityEnvelope::build(env, sc.rack, sc.forklift, spec, threads);
+  const double build_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  std::size_t feasible = 0;
+  for (int is = 0; is < built.spec().s_bins; ++is) {
+    for (int ip = 0; ip < built.spec().pitch_bins; ++ip) feasible += built.cell(is, ip).anyFeasible() ? 1 : 0;
+  }
+  std::printf("%zu bins (%zu with a feasible band) built in %.2f s\n", built.cellCount(), feasible, build_s);
+
+  if (!built.save(out_path)) {
+    std::cerr << "cannot write " << out_path << "\n";
+    return 1;
+  }
+  std::printf("wrote %s\n", out_path.c_str());
+  if (!check) return 0;
+
+  std::string error;
+  const auto loaded = FeasibilityEnvelope::load(out_path, &error);
+  if (!loaded) {
+    std::cerr << error << "\n";
+    return 1;
+  }
+  for (int with_envelope = 0; with_envelope <= 1; ++with_envelope) {
+    Controller controller(cfg);
+    if (with_envelope) controller.setFeasibilityEnvelope(loaded);
+    const auto t1 = std::chrono::steady_clock::now();
+    const sim::RunSummary r = sim::runScenario(controller, sc);
+    printRun(with_envelope ? "with envelope" : "full window", r,
+             std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count());
+  }
+  return 0;
+}
@@ -0,0 +1,49 @@
+#include <iostream>
+#include <string>
+
+#include "utils/BinaryLog.hpp"
+#include "utils/CsvLog.hpp"
+
+using namespace tlf;
+
+// Converts a BinaryLogger file to the CSV format of docs/log_format.md (for tools/animate.py and
+// the web viewer).
+int main(int argc, char** argv) {
+  std::string in_path;
+  std::string out_path;
+  for (int i = 1; i < argc; ++i) {
+    if (std::string(argv[i]) == "--in" && i + 1 < argc) in_path = argv[++i];
+    if (std::string(argv[i]) == "--out" && i + 1 < argc) out_path = argv[++i];
+  }
+  if (in_path.empty() || out_path.empty()) {
+    std::cerr << "Usage: tlf_log_convert --in <log.tlfb> --out <log.csv>\n";
+    return 2;
+  }
+
+  BinaryLogReader reader(in_path);
+  if (!reader.good()) {
+    std::cerr << "Failed to read " << in_path << ": " << reader.error() << "\n";
+    return 1;
+  }
+
+  CsvLogger csv(out_path);
+  if (!csv.good()) {
+    std::cerr << "Failed to open: " << out_path << "\n";
+    return 1;
+  }
+  csv.writeHeader();
+
+  int count = 0;
+  LogRecord r;
+  while (reader.next(&r)) {
+    csv.writeRecord(r);
+    ++count;
+  }
+  if (!reader.good()) {
+    std::cerr << "Stopped after " << count << " frames: " << reader.error() << "\n";
+    return 1;
+  }
+
+  std::cout << "Converted " << count << " frames to " << out_path << "\n";
+  return 0;
+}
@@ -0,0 +1,93 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "utils/LogAnalytics.hpp"
+
+using namespace tlf;
+
+static void usage() {
+  std::cerr << "Usage: tlf_log_stats [--out summary.json] [--threads N] [--near-miss M] [--hist-min M]\n"
+               "                     [--hist-bin M] [--hist-bins N] <log|dir>...\n"
+               "Streams CSV / .tlfb logs (directories recursively) in one pass per file and reports per-run and\n"
+               "fleet-wide clearance histograms, safety-level and terrain dwell times and near-miss events.\n";
+}
+
+// Fleet log analytics; the JSON summary can be opened in tools/web_viewer.
+int main(int argc, char** argv) {
+  std::string out_path;
+  int threads = 0;
+  LogStatsOptions options;
+  std::vector<std::string> inputs;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (a == "--out" && has_value) {
+      out_path = argv[++i];
+    } else if (a == "--threads" && has_value) {
+      threads = std::stoi(argv[++i]);
+    } else if (a == "--near-miss" && has_value) {
+      options.near_miss_m = std::stod(argv[++i]);
+    } else if (a == "--hist-min" && has_value) {
+      options.hist_min_m = std::stod(argv[++i]);
+    } else if (a == "--hist-bin" && has_value) {
+      options.hist_bin_m = std::stod(argv[++i]);
+    } else if (a == "--hist-bins" && has_value) {
+      options.hist_bins = std::stoi(argv[++i]);
+    } else if (!a.empty() && a[0] != '-') {
+      inputs.push_back(a);
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (inputs.empty()) {
+    usage();
+    return 2;
+  }
+
+  std::vector<std::string> paths;
+  for (const auto& in : inputs) {
+    const auto found = listLogFiles(in);
+    if (found.empty()) std::cerr << "No logs found at " << in << "\n";
+    paths.insert(paths.end(), found.begin(), found.end());
+  }
+  if (paths.empty()) return 1;
+
+  const auto t0 = std::chrono::steady_clock::now();
+  const LogSummary summary = analyzeLogFiles(paths, options, threads);
+  const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  int failed = 0;
+  for (const auto& run : summary.runs) {
+    if (run.error.empty()) continue;
+    std::cerr << run.path << ": " << run.error << "\n";
+    ++failed;
+  }
+
+  const LogStats& f = summary.fleet;
+  std::printf("%zu logs, %llu frames (%.1f h) in %.2f s\n", paths.size(), static_cast<unsigned long long>(f.frames),
+              f.duration_s / 3600.0, wall_s);
+  std::printf("min clearance top/bottom: %.4f / %.4f m\n", f.min_clearance_top_m, f.min_clearance_bottom_m);
+  std::printf("dwell OK/WARN/STOP/DEGRADED: %.1f / %.1f / %.1f / %.1f s, STOP entries: %llu\n", f.level_time_s[0],
+              f.level_time_s[1], f.level_time_s[2], f.level_time_s[3], static_cast<unsigned long long>(f.stop_events));
+  std::printf("near misses (< %.3f m) RB/RT/FB/FT: %llu / %llu / %llu / %llu\n", summary.options.near_miss_m,
+              static_cast<unsigned long long>(f.near_miss_events[0]),
+              static_cast<unsigned long long>(f.near_miss_events[1]),
+              static_cast<unsigned long long>(f.near_miss_events[2]),
+              static_cast<unsigned long long>(f.near_miss_events[3]));
+  if (f.skipped_lines > 0) std::printf("skipped malformed lines: %llu\n", static_cast<unsigned long long>(f.skipped_lines));
+
+  if (!out_path.empty()) {
+    std::string error;
+    if (!writeLogSummary(out_path, summary, &error)) {
+      std::cerr << error << "\n";
+      return 1;
+    }
+    std::cout << "Wrote " << out_path << "\n";
+  }
+  return failed > 0 ? 1 : 0;
+}
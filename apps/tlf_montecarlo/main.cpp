@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "sim/Simulation.hpp"
+
+using namespace tlf;
+
+static void usage() {
+  std::cerr << "Usage: tlf_montecarlo [--n N] [--seed S] [--controller grid|mpc] [--threads N] [--lanes L] [--worst K]\n"
+               "Runs N randomized variants of the docking demo (ramp, container height, rack size and mount,\n"
+               "start lift, speed) and reports completion, STOP and clearance statistics.\n";
+}
+
+static double quantile(std::vector<double> v, double q) {
+  if (v.empty()) return 0.0;
+  const std::size_t k = std::min(v.size() - 1, static_cast<std::size_t>(q * static_cast<double>(v.size())));
+  std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(k), v.end());
+  return v[k];
+}
+
+// Monte-Carlo robustness run of a controller over randomized docking scenarios.
+int main(int argc, char** argv) {
+  int n = 1000;
+  std::uint64_t seed = 1;
+  ControllerKind kind = ControllerKind::GridSearch;
+  int threads = 0;
+  std::size_t lanes = 32;
+  int worst = 5;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (a == "--n" && has_value) {
+      n = std::stoi(argv[++i]);
+    } else if (a == "--seed" && has_value) {
+      seed = std::stoull(argv[++i]);
+    } else if (a == "--controller" && has_value) {
+      kind = controllerKindFromString(argv[++i]);
+    } else if (a == "--threads" && has_value) {
+      threads = std::stoi(argv[++i]);
+    } else if (a == "--lanes" && has_value) {
+      lanes = static_cast<std::size_t>(std::stoul(argv[++i]));
+    } else if (a == "--worst" && has_value) {
+      worst = std::stoi(argv[++i]);
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (n <= 0) {
+    usage();
+    return 2;
+  }
+
+  const sim::Scenario base = sim::dockingDemoScenario();
+  const sim::ScenarioSpread spread;
+  std::vector<sim::Scenario> scenarios;
+  scenarios.reserve(static_cast<std::size_t>(n));
+  for (int i = 0; i < n; ++i) scenarios.push_back(sim::randomizedScenario(base, spread, seed + static_cast<std::uint64_t>(i)));
+
+  const auto t0 = std::chrono::steady_clock::now();
+  const auto results = sim::runScenarios(kind, sim::dockingDemoConfig(kind), scenarios, threads, lanes);
+  const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  std::size_t completed = 0, with_stop = 0;
+  long steps = 0;
+  std::vector<double> min_clear, t_end;
+  for (const auto& r : results) {
+    steps += r.steps;
+    if (r.completed) {
+      ++completed;
+      t_end.push_back(r.time_to_end_s);
+    }
+    if (r.stop_steps > 0) ++with_stop;
+    min_clear.push_back(std::min(r.min_clearance_top_m, r.min_clearance_bottom_m));
+  }
+
+  std::printf("%d scenarios (%ld steps) with %s in %.1f s (%.0f steps/s)\n", n, steps, toString(kind), wall_s,
+              wall_s > 0.0 ? static_cast<double>(steps) / wall_s : 0.0);
+  std::printf("completed: %zu (%.1f%%), with STOP: %zu (%.1f%%)\n", completed, 100.0 * completed / n, with_stop,
+              100.0 * with_stop / n);
+  std::printf("min clearance p1/p10/p50: %.4f / %.4f / %.4f m\n", quantile(min_clear, 0.01), quantile(min_clear, 0.10),
+              quantile(min_clear, 0.50));
+  if (!t_end.empty()) {
+    std::printf("time to end p50/p90: %.1f / %.1f s\n", quantile(t_end, 0.50), quantile(t_end, 0.90));
+  }
+
+  std::vector<std::size_t> order(results.size());
+  for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return min_clear[a] < min_clear[b]; });
+  for (int k = 0; k < worst && k < n; ++k) {
+    const std::size_t i = order[static_cast<std::size_t>(k)];
+    const auto& sc = scenarios[i];
+    std::printf("worst #%d: seed=%llu min_clear=%.4f stop=%d done=%d (ramp %.2f deg/%.2f m, container %.3f m, rack %.3fx%.3f m)\n",
+                k + 1, static_cast<unsigned long long>(seed + i), min_clear[i], results[i].stop_steps,
+                results[i].completed ? 1 : 0, sc.env.ramp_slope_deg, sc.env.ramp_len_m, sc.env.container_h_m,
+                sc.rack.height_m, sc.rack.length_m);
+  }
+  return 0;
+}
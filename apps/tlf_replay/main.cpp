@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "utils/LogReader.hpp"
+#include "utils/Replay.hpp"
+
+using namespace tlf;
+
+static void usage() {
+  std::cerr << "Usage: tlf_replay [options] <log.csv|log.tlfb>...\n"
+               "  --dir <path>            replay every .csv/.tlfb under path (recursive)\n"
+               "  --controller grid|mpc   controller to re-run (default grid)\n"
+               "  --threads N             parallel files (default: all cores)\n"
+               "  --rack-height M --rack-length M --mount-x M --mount-z M --pivot-height M\n"
+               "                          geometry used when the logs were recorded\n"
+               "  --margin-top M --margin-bottom M --lookahead M\n"
+               "  --grid-steps N --mpc-horizon N --mpc-beam N\n"
+               "                          config under test (defaults: ControllerConfig)\n"
+               "  --tol X                 command tolerance for lift/tilt/speed (default 1e-5)\n"
+               "  --quiet                 only print files that differ, plus the summary\n"
+               "  --fail-on-diff          exit with 3 if any file differs\n";
+}
+
+// Re-runs a controller over recorded logs and reports where its commands or safety levels
+// differ from the recording.
+int main(int argc, char** argv) {
+  ReplayOptions opt;
+  std::vector<std::string> paths;
+  int threads = 0;
+  bool quiet = false;
+  bool fail_on_diff = false;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (a == "--dir" && has_value) {
+      const auto found = listLogFiles(argv[++i]);
+      if (found.empty()) {
+        std::cerr << "No logs found at " << argv[i] << "\n";
+        return 1;
+      }
+      paths.insert(paths.end(), found.begin(), found.end());
+    } else if (a == "--controller" && has_value) {
+      opt.kind = controllerKindFromString(argv[++i]);
+    } else if (a == "--threads" && has_value) {
+      threads = std::stoi(argv[++i]);
+    } else if (a == "--rack-height" && has_value) {
+      opt.rack.height_m = std::stod(argv[++i]);
+    } else if (a == "--rack-length" && has_value) {
+      opt.rack.length_m = std::stod(argv[++i]);
+    } else if (a == "--mount-x" && has_value) {
+      opt.rack.mount_offset_m.x = std::stod(argv[++i]);
+    } else if (a == "--mount-z" && has_value) {
+      opt.rack.mount_offset_m.z = std::stod(argv[++i]);
+    } else if (a == "--pivot-height" && has_value) {
+      opt.forklift.mast_pivot_height_m = std::stod(argv[++i]);
+    } else if (a == "--margin-top" && has_value) {
+      opt.config.margin_top_m = std::stod(argv[++i]);
+    } else if (a == "--margin-bottom" && has_value) {
+      opt.config.margin_bottom_m = std::stod(argv[++i]);
+    } else if (a == "--lookahead" && has_value) {
+      opt.config.lookahead_s_m = std::stod(argv[++i]);
+    } else if (a == "--grid-steps" && has_value) {
+      opt.config.grid_lift_steps = opt.config.grid_tilt_steps = std::stoi(argv[++i]);
+    } else if (a == "--mpc-horizon" && has_value) {
+      opt.config.mpc_horizon_steps = std::stoi(argv[++i]);
+    } else if (a == "--mpc-beam" && has_value) {
+      opt.config.mpc_beam_width = std::stoi(argv[++i]);
+    } else if (a == "--tol" && has_value) {
+      opt.lift_tol_m = opt.tilt_tol_rad = opt.speed_tol_m_s = std::stod(argv[++i]);
+    } else if (a == "--quiet") {
+      quiet = true;
+    } else if (a == "--fail-on-diff") {
+      fail_on_diff = true;
+    } else if (!a.empty() && a[0] == '-') {
+      usage();
+      return 2;
+    } else {
+      paths.push_back(a);
+    }
+  }
+  if (paths.empty()) {
+    usage();
+    return 2;
+  }
+  std::sort(paths.begin(), paths.end());
+
+  const auto t0 = std::chrono::steady_clock::now();
+  const auto results = replayFiles(paths, opt, threads);
+  const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  std::size_t frames = 0, failed = 0, differing = 0;
+  for (const auto& r : results) {
+    if (!r.ok) {
+      ++failed;
+      std::cout << r.path << ": ERROR " << r.error << "\n";
+      continue;
+    }
+    frames += r.frames;
+    if (!r.identical()) ++differing;
+    if (quiet && r.identical()) continue;
+
+    std::printf("%s: frames=%zu cmd_diff=%zu safety_diff=%zu first_diff=%ld max_d(lift,tilt,speed)=(%.6f, %.6f, %.6f) "
+                "min_clear(top,bottom) recorded=(%.4f, %.4f) replay=(%.4f, %.4f) stop(recorded/replay)=%zu/%zu\n",
+                r.path.c_str(), r.frames, r.command_diff_frames, r.safety_diff_frames, r.first_diff_frame, r.max_lift_diff_m,
+                r.max_tilt_diff_rad, r.max_speed_diff_m_s, r.recorded_min_clearance_top_m, r.recorded_min_clearance_bottom_m,
+                r.replay_min_clearance_top_m, r.replay_min_clearance_bottom_m,
+                r.recorded_level_counts[static_cast<int>(SafetyLevel::STOP)],
+                r.replay_level_counts[static_cast<int>(SafetyLevel::STOP)]);
+  }
+
+  std::printf("Replayed %zu files (%zu frames) with %s in %.2f s: %zu differ, %zu failed\n", results.size(), frames,
+              toString(opt.kind), wall_s, differing, failed);
+  if (failed > 0) return 1;
+  return (fail_on_diff && differing > 0) ? 3 : 0;
+}
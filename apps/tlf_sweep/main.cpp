@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "sim/Sweep.hpp"
+
+using namespace tlf;
+
+static void usage() {
+  std::cerr << "Usage: tlf_sweep [options] --param <field>=<values> [--param ...]\n"
+               "  values: v1,v2,...  or  lo:hi:n (n evenly spaced values)\n"
+               "  --controller grid|mpc   controller under test (default grid)\n"
+               "  --threads N             parallel runs (default: all cores)\n"
+               "  --max-steps N           cap on sim steps per run (default 6000)\n"
+               "  --out <csv>             also write every combination to a CSV file\n"
+               "Base config is the docking demo's (example_sim_trajectory). Fields:\n ";
+  for (const auto& f : sim::sweepableConfigFields()) std::cerr << ' ' << f;
+  std::cerr << "\n";
+}
+
+static bool parseAxis(const std::string& spec, sim::SweepAxis* axis) {
+  const auto eq = spec.find('=');
+  if (eq == std::string::npos) return false;
+  axis->field = spec.substr(0, eq);
+  const std::string vals = spec.substr(eq + 1);
+  axis->values.clear();
+  try {
+    const auto c1 = vals.find(':');
+    if (c1 != std::string::npos) {
+      const auto c2 = vals.find(':', c1 + 1);
+      if (c2 == std::string::npos) return false;
+      const double lo = std::stod(vals.substr(0, c1));
+      const double hi = std::stod(vals.substr(c1 + 1, c2 - c1 - 1));
+      const int n = std::stoi(vals.substr(c2 + 1));
+      if (n < 1) return false;
+      for (int i = 0; i < n; ++i) axis->values.push_back((n == 1) ? lo : lo + (hi - lo) * i / (n - 1));
+    } else {
+      std::size_t b = 0;
+      while (b <= vals.size()) {
+        const auto e = std::min(vals.find(',', b), vals.size());
+        axis->values.push_back(std::stod(vals.substr(b, e - b)));
+        b = e + 1;
+      }
+    }
+  } catch (const std::exception&) {
+    return false;
+  }
+  return !axis->values.empty();
+}
+
+static void printPoint(std::FILE* out, const std::vector<sim::SweepAxis>& axes, const sim::SweepPoint& p) {
+  for (std::size_t a = 0; a < axes.size(); ++a) std::fprintf(out, "%s=%g ", axes[a].field.c_str(), p.values[a]);
+  const auto& s = p.summary;
+  std::fprintf(out, "| done=%d t_end=%.1fs t_door=%.1fs min_clear(top,bottom)=(%.4f, %.4f) stop=%d warn=%d latency=%.1fus\n",
+               s.completed ? 1 : 0, s.time_to_end_s, s.time_to_door_s, s.min_clearance_top_m, s.min_clearance_bottom_m,
+               s.stop_steps, s.warn_steps, p.mean_step_latency_us);
+}
+
+// Headless parameter sweep over ControllerConfig on the docking demo, reporting the Pareto front.
+int main(int argc, char** argv) {
+  ControllerKind kind = ControllerKind::GridSearch;
+  std::vector<sim::SweepAxis> axes;
+  sim::Scenario scenario;
+  int threads = 0;
+  std::string out_path;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (a == "--param" && has_value) {
+      sim::SweepAxis axis;
+      ControllerConfig probe;
+      if (!parseAxis(argv[++i], &axis) || !sim::setConfigField(&probe, axis.field, 0.0)) {
+        std::cerr << "Bad --param: " << argv[i] << "\n";
+        usage();
+        return 2;
+      }
+      axes.push_back(std::move(axis));
+    } else if (a == "--controller" && has_value) {
+      kind = controllerKindFromString(argv[++i]);
+    } else if (a == "--threads" && has_value) {
+      threads = std::stoi(argv[++i]);
+    } else if (a == "--max-steps" && has_value) {
+      scenario.max_steps = std::stoi(argv[++i]);
+    } else if (a == "--out" && has_value) {
+      out_path = argv[++i];
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (axes.empty()) {
+    usage();
+    return 2;
+  }
+
+  const auto t0 = std::chrono::steady_clock::now();
+  const auto points = sim::runSweep(kind, sim::dockingDemoConfig(kind), scenario, axes, threads);
+  const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  if (!out_path.empty()) {
+    std::ofstream out(out_path);
+    for (const auto& ax : axes) out << ax.field << ',';
+    out << "completed,time_to_end_s,time_to_door_s,min_clearance_top_m,min_clearance_bottom_m,stop_steps,warn_steps,"
+           "mean_step_latency_us\n";
+    for (const auto& p : points) {
+      if (!p.valid()) continue;
+      for (double v : p.values) out << v << ',';
+      const auto& s = p.summary;
+      out << (s.completed ? 1 : 0) << ',' << s.time_to_end_s << ',' << s.time_to_door_s << ',' << s.min_clearance_top_m << ','
+          << s.min_clearance_bottom_m << ',' << s.stop_steps << ',' << s.warn_steps << ',' << p.mean_step_latency_us << '\n';
+    }
+  }
+
+  std::size_t skipped = 0;
+  for (const auto& p : points) {
+    if (p.valid()) continue;
+    ++skipped;
+    for (std::size_t a = 0; a < axes.size(); ++a) std::fprintf(stderr, "%s=%g ", axes[a].field.c_str(), p.values[a]);
+    std::fprintf(stderr, "| skipped: %s\n", p.invalid.c_str());
+  }
+
+  auto front = sim::paretoFront(points);
+  std::sort(front.begin(), front.end(), [&](std::size_t a, std::size_t b) {
+    const auto& sa = points[a].summary;
+    const auto& sb = points[b].summary;
+    if (sa.completed != sb.completed) return sa.completed;
+    return sa.time_to_end_s < sb.time_to_end_s;
+  });
+
+  std::printf("Ran %zu combinations (%zu invalid, skipped) with %s in %.1f s; Pareto front (%zu):\n",
+              points.size() - skipped, skipped, toString(kind), wall_s, front.size());
+  for (std::size_t i : front) printPoint(stdout, axes, points[i]);
+  return 0;
+}
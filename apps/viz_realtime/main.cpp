@@ -1,13 +1,16 @@
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <vector>
 
 #include "controller/Controller.hpp"
 #include "controller/ControllerFactory.hpp"
 #include "model/Geometry.hpp"
+#include "sim/BackgroundSim.hpp"
+#include "utils/LodIndex.hpp"
+#include "utils/LogReader.hpp"
 
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -17,8 +20,6 @@
 
 using namespace tlf;
 
-static double clamp(double v, double lo, double hi) { return std::max(lo, std::min(hi, v)); }
-
 struct VizSample {
   double time_s{0.0};
   double s_m{0.0};
@@ -42,185 +43,117 @@ struct VizSample {
   int worst_point{0};
 };
 
-static std::vector<std::string> splitCsvLine(const std::string& line) {
-  std::vector<std::string> out;
-  std::string cur;
-  for (char ch : line) {
-    if (ch == ',') {
-      out.push_back(cur);
-      cur.clear();
-    } else {
-      cur.push_back(ch);
-    }
-  }
-  out.push_back(cur);
-  return out;
+static VizSample vizSampleFromRecord(const LogRecord& r) {
+  VizSample s;
+  s.time_s = r.time_s;
+  s.s_m = r.s_m;
+  s.pitch_rad = r.pitch_rad;
+  s.pitch_rate_rad_s = r.pitch_rate_rad_s;
+  s.lift_m = r.lift_m;
+  s.tilt_rad = r.tilt_rad;
+  s.ceiling_z = r.ceiling_z_m;
+  s.floor_z = r.floor_z_m;
+
+  s.corners.p[0] = {r.rb_x, r.rb_z};
+  s.corners.p[1] = {r.rt_x, r.rt_z};
+  s.corners.p[2] = {r.fb_x, r.fb_z};
+  s.corners.p[3] = {r.ft_x, r.ft_z};
+
+  s.clearance_top = r.clearance_top_m;
+  s.clearance_bottom = r.clearance_bottom_m;
+
+  s.lift_cmd = r.lift_cmd_m;
+  s.tilt_cmd = r.tilt_cmd_rad;
+  s.speed_limit = r.speed_limit_m_s;
+
+  s.safety_level = r.safety_level;
+  s.terrain_state = r.terrain_state;
+  s.worst_point = r.worst_point_id;
+  return s;
 }
 
-static bool loadCsvLog(const std::string& path, std::vector<VizSample>* out) {
+// Loads a CSV or binary log (see docs/log_format.md) through LogReader.
+static bool loadLog(const std::string& path, std::vector<VizSample>* out) {
   out->clear();
-  std::ifstream in(path);
-  if (!in.good()) return false;
-
-  std::string header;
-  if (!std::getline(in, header)) return false;
-
-  std::string line;
-  while (std::getline(in, line)) {
-    if (line.empty()) continue;
-    const auto f = splitCsvLine(line);
-    // Expect MVP header fields count
-    if (f.size() < 26) continue;
-
-    VizSample s;
-    s.time_s = std::stod(f[0]);
-    s.s_m = std::stod(f[1]);
-    s.pitch_rad = std::stod(f[2]);
-    s.pitch_rate_rad_s = std::stod(f[3]);
-    s.lift_m = std::stod(f[4]);
-    s.tilt_rad = std::stod(f[5]);
-    s.ceiling_z = std::stod(f[6]);
-    s.floor_z = std::stod(f[7]);
-
-    s.corners.p[0] = {std::stod(f[8]), std::stod(f[9])};
-    s.corners.p[1] = {std::stod(f[10]), std::stod(f[11])};
-    s.corners.p[2] = {std::stod(f[12]), std::stod(f[13])};
-    s.corners.p[3] = {std::stod(f[14]), std::stod(f[15])};
-
-    s.clearance_top = std::stod(f[16]);
-    s.clearance_bottom = std::stod(f[17]);
-
-    s.lift_cmd = std::stod(f[18]);
-    s.tilt_cmd = std::stod(f[19]);
-    s.speed_limit = std::stod(f[20]);
-
-    s.safety_level = std::stoi(f[21]);
-    s.terrain_state = std::stoi(f[22]);
-    s.worst_point = std::stoi(f[23]);
-
-    out->push_back(s);
-  }
+  LogReader reader(path);
+  if (!reader.good()) return false;
 
-  return !out->empty();
+  for (const LogRecord& r : reader) out->push_back(vizSampleFromRecord(r));
+  return reader.good() && !out->empty();
 }
 
-static double rampFloorZ(double x_m, double ramp_deg) {
-  const double a = std::tan(ramp_deg * M_PI / 180.0);
-  if (x_m < 0.0) return a * x_m;  // outside is lower
-  return 0.0;
-}
 
-static TerrainState terrainFromS(double s) {
-  if (s < -1.2) return TerrainState::Ground;
-  if (s < -0.6) return TerrainState::FrontOnRamp;
-  if (s < -0.1) return TerrainState::OnRamp;
-  if (s < 0.5) return TerrainState::FrontInContainerRearOnRamp;
-  return TerrainState::InContainer;
+// Channels of the timeline plot, kept in a LodIndex alongside the samples.
+enum PlotChannel : std::size_t { kPlotClearTop, kPlotClearBottom, kPlotLiftCmd, kPlotTiltCmd, kPlotChannels };
+
+static void appendToLod(const VizSample& s, LodIndex* lod) {
+  const double v[kPlotChannels] = {s.clearance_top, s.clearance_bottom, s.lift_cmd, s.tilt_cmd};
+  lod->append(v, s.safety_level);
 }
 
-static double pitchFromTerrain(TerrainState t, double s) {
-  const double ramp = 4.0 * M_PI / 180.0;
-  switch (t) {
-    case TerrainState::Ground:
-      return 0.0;
-    case TerrainState::FrontOnRamp:
-    case TerrainState::OnRamp:
-      return ramp;
-    case TerrainState::FrontInContainerRearOnRamp: {
-      const double t01 = clamp((s - (-0.1)) / (0.6), 0.0, 1.0);
-      return (1.0 - t01) * ramp;
+// Clearance (top/bottom, upper half) and command (lift/tilt, lower half, each scaled on its own)
+// traces over frames [begin, end). Only the LodIndex selection for one bucket per pixel column is
+// drawn, so a full-shift log costs the same as a short one; minima and STOP entries (red) are kept.
+static void drawTimeline(const LodIndex& lod, std::size_t begin, std::size_t end, int cursor, const ImVec2& pos,
+                         const ImVec2& size, std::vector<std::uint32_t>* sel, std::vector<ImVec2>* pts) {
+  ImDrawList* dl = ImGui::GetWindowDrawList();
+  dl->AddRectFilled(pos, ImVec2(pos.x + size.x, pos.y + size.y), IM_COL32(25, 25, 28, 255));
+  dl->AddRect(pos, ImVec2(pos.x + size.x, pos.y + size.y), IM_COL32(80, 80, 90, 255));
+  if (end <= begin + 1) return;
+
+  lod.select(begin, end, static_cast<std::size_t>(size.x), sel);
+  const double span = static_cast<double>(end - 1 - begin);
+  auto frameX = [&](std::size_t f) { return pos.x + static_cast<float>((f - begin) / span) * size.x; };
+
+  const float half = 0.5f * size.y;
+  auto trace = [&](const std::size_t* channels, int n, const ImU32* colors, float top) {
+    // One vertical range over the given channels, from the selected frames (they hold the extrema).
+    double lo = lod.value(channels[0], (*sel)[0]);
+    double hi = lo;
+    for (int k = 0; k < n; ++k) {
+      for (const auto f : *sel) {
+        lo = std::min(lo, lod.value(channels[k], f));
+        hi = std::max(hi, lod.value(channels[k], f));
+      }
     }
-    case TerrainState::InContainer:
-    default:
-      return 0.0;
-  }
-}
+    if (!(hi > lo)) hi = lo + 1e-3;
+    for (int k = 0; k < n; ++k) {
+      pts->clear();
+      for (const auto f : *sel) {
+        const float y = top + half - 4.0f -
+                        static_cast<float>((lod.value(channels[k], f) - lo) / (hi - lo)) * (half - 8.0f);
+        pts->push_back(ImVec2(frameX(f), y));
+      }
+      dl->AddPolyline(pts->data(), static_cast<int>(pts->size()), colors[k], 0, 1.5f);
+    }
+    return lo;
+  };
 
-static std::vector<VizSample> buildBuiltinTrajectory(const ControllerConfig& cfg, ControllerKind kind, int steps = 900) {
-  auto controller = makeController(kind, cfg);
-  controller->reset();
-
-  RackParams rack;
-  rack.height_m = 2.3;
-  rack.length_m = 2.3;
-  rack.mount_offset_m = {0.3, -0.15};
-
-  ForkliftParams fl;
-
-  double time_s = 0.0;
-  double s_m = -1.5;
-  double lift_m = 1.00;
-  double tilt_rad = 0.0;
-  double last_pitch = 0.0;
-
-  const double dt = 0.02;
-  const double v = 0.35;
-
-  std::vector<VizSample> out;
-  out.reserve(static_cast<size_t>(steps));
-
-  for (int k = 0; k < steps; ++k) {
-    const TerrainState terr = terrainFromS(s_m);
-    const double pitch = pitchFromTerrain(terr, s_m);
-    const double pitch_rate = (pitch - last_pitch) / dt;
-
-    EnvironmentGeometry env;
-    env.ceiling_z_m = 2.5;
-    env.floor_z_m = rampFloorZ(s_m, 4.0);
-
-    ControlInput in;
-    in.dt_s = dt;
-    in.s_m = s_m;
-    in.pitch_rad = pitch;
-    in.pitch_rate_rad_s = pitch_rate;
-    in.terrain = terr;
-    in.lift_pos_m = lift_m;
-    in.tilt_rad = tilt_rad;
-    in.env = env;
-    in.rack = rack;
-    in.forklift = fl;
-    in.inputs_valid = true;
-
-    const DebugFrame fr = controller->step(in);
-
-    VizSample vs;
-    vs.time_s = fr.time_s;
-    vs.s_m = in.s_m;
-    vs.pitch_rad = in.pitch_rad;
-    vs.pitch_rate_rad_s = in.pitch_rate_rad_s;
-    vs.lift_m = in.lift_pos_m;
-    vs.tilt_rad = in.tilt_rad;
-    vs.ceiling_z = env.ceiling_z_m.value();
-    vs.floor_z = env.floor_z_m.value();
-    vs.corners = fr.corners;
-    vs.clearance_top = fr.safety.clearance_top_m;
-    vs.clearance_bottom = fr.safety.clearance_bottom_m;
-    vs.lift_cmd = fr.cmd.lift_target_m;
-    vs.tilt_cmd = fr.cmd.tilt_target_rad;
-    vs.speed_limit = fr.cmd.speed_limit_m_s;
-    vs.safety_level = static_cast<int>(fr.safety.level);
-    vs.terrain_state = static_cast<int>(in.terrain);
-    vs.worst_point = static_cast<int>(fr.safety.worst_point);
-
-    out.push_back(vs);
-
-    // apply actuation
-    const double lift_err = fr.cmd.lift_target_m - lift_m;
-    lift_m += clamp(lift_err, -fr.cmd.lift_rate_limit_m_s * dt, fr.cmd.lift_rate_limit_m_s * dt);
-
-    const double tilt_err = fr.cmd.tilt_target_rad - tilt_rad;
-    tilt_rad += clamp(tilt_err, -fr.cmd.tilt_rate_limit_rad_s * dt, fr.cmd.tilt_rate_limit_rad_s * dt);
-
-    const double speed = std::min(v, fr.cmd.speed_limit_m_s);
-    s_m += speed * dt;
-
-    time_s += dt;
-    last_pitch = pitch;
-
-    if (s_m > 1.6) break;
+  const std::size_t clear_ch[] = {kPlotClearTop, kPlotClearBottom};
+  const ImU32 clear_col[] = {IM_COL32(90, 170, 240, 255), IM_COL32(240, 170, 90, 255)};
+  const double clear_lo = trace(clear_ch, 2, clear_col, pos.y);
+  const std::size_t lift_ch[] = {kPlotLiftCmd};
+  const std::size_t tilt_ch[] = {kPlotTiltCmd};
+  const ImU32 lift_col[] = {IM_COL32(120, 220, 140, 255)};
+  const ImU32 tilt_col[] = {IM_COL32(200, 140, 230, 255)};
+  trace(lift_ch, 1, lift_col, pos.y + half);
+  trace(tilt_ch, 1, tilt_col, pos.y + half);
+  dl->AddLine(ImVec2(pos.x, pos.y + half), ImVec2(pos.x + size.x, pos.y + half), IM_COL32(80, 80, 90, 255));
+
+  for (const auto f : lod.stopEntries()) {
+    if (f < begin || f >= end) continue;
+    dl->AddLine(ImVec2(frameX(f), pos.y), ImVec2(frameX(f), pos.y + size.y), IM_COL32(240, 80, 80, 160));
+  }
+  if (cursor >= static_cast<int>(begin) && cursor < static_cast<int>(end)) {
+    const float x = frameX(static_cast<std::size_t>(cursor));
+    dl->AddLine(ImVec2(x, pos.y), ImVec2(x, pos.y + size.y), IM_COL32(230, 230, 230, 200));
   }
 
-  return out;
+  char label[96];
+  std::snprintf(label, sizeof(label), "clear_top / clear_bottom (min %.3f m)   %zu of %zu frames drawn", clear_lo,
+                sel->size(), end - begin);
+  dl->AddText(ImVec2(pos.x + 6, pos.y + 4), IM_COL32(220, 220, 230, 255), label);
+  dl->AddText(ImVec2(pos.x + 6, pos.y + half + 4), IM_COL32(220, 220, 230, 255), "lift_cmd / tilt_cmd");
 }
 
 static ImU32 colorForSafety(int level) {
@@ -261,9 +194,9 @@ static void drawScene2D(const VizSample& s, const ImVec2& canvas_pos, const ImVe
   // Door frame at x=0
   dl->AddLine(W2S(0.0, 0.0), W2S(0.0, s.ceiling_z), IM_COL32(200, 200, 220, 255), 2.0f);
 
-  // Floor: ramp outside + container inside
-  const double ramp_deg = 4.0;
-  auto floorZ = [&](double x) { return rampFloorZ(x, ramp_deg); };
+  // Floor: ramp outside + container inside (the built-in scenario's site)
+  const sim::DockingEnv site = sim::vizRampScenario().env;
+  auto floorZ = [&](double x) { return sim::floorZAtX(site, x); };
 
   // sample floor polyline
   const int N = 60;
@@ -301,7 +234,7 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  GLFWwindow* window = glfwCreateWindow(1280, 720, "tlf viz_realtime", nullptr, nullptr);
+  GLFWwindow* window = glfwCreateWindow(1280, 960, "tlf viz_realtime", nullptr, nullptr);
   if (!window) {
     glfwTerminate();
     return 1;
@@ -318,6 +251,10 @@ int main(int argc, char** argv) {
 
   ControllerConfig cfg;
   std::vector<VizSample> samples;
+  LodIndex lod(kPlotChannels);  // follows `samples`
+  int plot_span = 0;            // timeline frames around the cursor, 0 = whole log
+  std::vector<std::uint32_t> plot_sel;
+  std::vector<ImVec2> plot_pts;
 
   enum class Mode { Builtin, Log };
   Mode mode = log_path.empty() ? Mode::Builtin : Mode::Log;
@@ -327,12 +264,25 @@ int main(int argc, char** argv) {
     std::snprintf(log_path_buf, sizeof(log_path_buf), "%s", log_path.c_str());
   }
 
+  // Built-in trajectory (sim::vizRampScenario) re-simulates on a worker thread and streams frames
+  // into `samples`, so slider changes never block rendering; a newer run cancels the older one.
+  sim::BackgroundSim resim;
+  std::uint64_t shown_generation = 0;
+  std::vector<LogRecord> incoming;
+  int restore_idx = -1;  // timeline position to return to once the new run has produced it
+
   auto rebuild = [&]() {
     if (mode == Mode::Builtin) {
-      samples = buildBuiltinTrajectory(cfg, controller_kind);
+      resim.start(controller_kind, cfg, sim::vizRampScenario());
     } else {
+      resim.cancel();
       std::vector<VizSample> tmp;
-      if (loadCsvLog(std::string(log_path_buf), &tmp)) samples = std::move(tmp);
+      if (loadLog(std::string(log_path_buf), &tmp)) {
+        samples = std::move(tmp);
+        lod.clear();
+        lod.reserve(samples.size());
+        for (const auto& smp : samples) appendToLod(smp, &lod);
+      }
     }
   };
 
@@ -348,7 +298,7 @@ int main(int argc, char** argv) {
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 
-    ImGui::SetNextWindowSize(ImVec2(1200, 680), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(1200, 940), ImGuiCond_FirstUseEver);
     ImGui::Begin("Realtime 2D Debug");
 
     // Controls
@@ -369,7 +319,7 @@ int main(int argc, char** argv) {
     }
 
     if (mode == Mode::Log) {
-      ImGui::InputText("CSV log path", log_path_buf, sizeof(log_path_buf));
+      ImGui::InputText("Log path (CSV or .tlfb)", log_path_buf, sizeof(log_path_buf));
       ImGui::SameLine();
       if (ImGui::Button("Load")) {
         idx = 0;
@@ -387,9 +337,31 @@ int main(int argc, char** argv) {
       }
     }
 
+    if (mode == Mode::Builtin) {
+      incoming.clear();
+      const std::uint64_t gen = resim.takeFrames(&incoming);
+      if (gen != shown_generation) {
+        samples.clear();
+        lod.clear();
+        shown_generation = gen;
+      }
+      for (const auto& r : incoming) {
+        samples.push_back(vizSampleFromRecord(r));
+        appendToLod(samples.back(), &lod);
+      }
+      if (resim.running()) {
+        ImGui::SameLine();
+        ImGui::Text("simulating... %d frames", static_cast<int>(samples.size()));
+      }
+    }
+
     if (samples.empty()) {
-      ImGui::TextColored(ImVec4(1, 0.5f, 0.5f, 1), "No samples loaded.");
+      ImGui::TextColored(ImVec4(1, 0.5f, 0.5f, 1), resim.running() ? "Simulating..." : "No samples loaded.");
     } else {
+      if (restore_idx >= 0) {
+        idx = restore_idx;
+        if (restore_idx < static_cast<int>(samples.size()) || !resim.running()) restore_idx = -1;
+      }
       idx = std::max(0, std::min(idx, static_cast<int>(samples.size()) - 1));
       ImGui::SliderInt("Time", &idx, 0, static_cast<int>(samples.size()) - 1);
 
@@ -439,18 +411,38 @@ int main(int argc, char** argv) {
         ImGui::Text("MPC Params");
         changed |= ImGui::SliderInt("mpc_horizon_steps", &cfg.mpc_horizon_steps, 1, 12);
         changed |= ImGui::SliderInt("mpc_beam_width", &cfg.mpc_beam_width, 5, 120);
+        changed |= ImGui::SliderInt("mpc_num_threads", &cfg.mpc_num_threads, 1, 8);
+        changed |= ImGui::Checkbox("mpc_dedup_states", &cfg.mpc_dedup_states);
         changed |= ImGui::SliderFloat("mpc_assumed_forward_speed", (float*)&cfg.mpc_assumed_forward_speed_m_s, 0.0f, 1.5f);
         changed |= ImGui::SliderFloat("mpc_use_pitch_rate_pred", (float*)&cfg.mpc_use_pitch_rate_prediction, 0.0f, 1.0f);
       }
 
       if (changed && mode == Mode::Builtin) {
-        const int keep = idx;
+        if (restore_idx < 0) restore_idx = idx;
         rebuild();
-        idx = std::min(keep, static_cast<int>(samples.size()) - 1);
       }
 
       ImGui::EndGroup();
 
+      // Timeline of the whole log (or plot_span frames around the cursor).
+      const int total = static_cast<int>(samples.size());
+      ImGui::SliderInt("Plot span (frames, 0 = all)", &plot_span, 0, total, "%d", ImGuiSliderFlags_Logarithmic);
+      int begin = 0;
+      int end = total;
+      if (plot_span > 1 && plot_span < total) {
+        begin = std::max(0, std::min(idx - plot_span / 2, total - plot_span));
+        end = begin + plot_span;
+      }
+      const ImVec2 plot_pos = ImGui::GetCursorScreenPos();
+      const ImVec2 plot_size = ImVec2(1160, 220);
+      if (ImGui::InvisibleButton("timeline", plot_size) && end > begin + 1) {
+        const float u = (ImGui::GetIO().MousePos.x - plot_pos.x) / plot_size.x;
+        idx = begin + static_cast<int>(std::lround(u * static_cast<float>(end - 1 - begin)));
+        playing = false;
+      }
+      drawTimeline(lod, static_cast<std::size_t>(begin), static_cast<std::size_t>(end), idx, plot_pos, plot_size,
+                   &plot_sel, &plot_pts);
+
       if (playing) {
         idx = std::min(idx + 1, static_cast<int>(samples.size()) - 1);
       }
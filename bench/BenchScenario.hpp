@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "controller/Controller.hpp"
+#include "model/Geometry.hpp"
+#include "model/TerrainProfile.hpp"
+#include "sim/Simulation.hpp"
+
+// Ramp -> door -> container scenario shared by the benchmarks (sim::dockingDemoScenario, as run by
+// examples/example_sim_trajectory.cpp), recorded once so every benchmark replays the same inputs.
+namespace tlf::bench {
+
+enum class EnvKind : int { Scalar = 0, Plane = 1, Callback = 2, Profile = 3 };
+
+inline const char* toString(EnvKind k) {
+  switch (k) {
+    case EnvKind::Scalar:
+      return "scalar";
+    case EnvKind::Plane:
+      return "plane";
+    case EnvKind::Callback:
+      return "callback";
+    case EnvKind::Profile:
+      return "profile";
+    default:
+      return "unknown";
+  }
+}
+
+struct EnvSpec {
+  double door_x_m{0.0};
+  double container_len_m{8.0};
+  double container_h_m{2.5};
+  double ramp_len_m{2.5};
+  double ramp_slope_deg{4.0};
+};
+
+inline double rampHeight(const EnvSpec& e) { return std::tan(e.ramp_slope_deg * M_PI / 180.0) * e.ramp_len_m; }
+
+inline double floorZAtX(const EnvSpec& e, double x_m) {
+  const double groundZ = -rampHeight(e);
+  const double rampStartX = e.door_x_m - e.ramp_len_m;
+  if (x_m >= e.door_x_m) return 0.0;
+  if (x_m <= rampStartX) return groundZ;
+  const double t = (x_m - rampStartX) / (e.door_x_m - rampStartX);
+  return (1.0 - t) * groundZ;
+}
+
+inline double ceilingZAtX(const EnvSpec& e, double) { return e.container_h_m; }
+
+// Compiled floor/ceiling for the fixed scenario, shared by every profile environment.
+inline std::shared_ptr<const TerrainProfile> scenarioProfile() {
+  static const std::shared_ptr<const TerrainProfile> profile = [] {
+    const EnvSpec e;
+    auto p = std::make_shared<TerrainProfile>();
+    p->floor = PiecewiseLinear({e.door_x_m - e.ramp_len_m, e.door_x_m}, {-rampHeight(e), 0.0});
+    p->ceiling = PiecewiseLinear(e.container_h_m);
+    return std::shared_ptr<const TerrainProfile>(p);
+  }();
+  return profile;
+}
+
+// Environment for one step at s_m in the requested representation.
+inline EnvironmentGeometry makeEnv(EnvKind kind, double s_m) {
+  const EnvSpec e;
+  EnvironmentGeometry env;
+  switch (kind) {
+    case EnvKind::Scalar:
+      env.ceiling_z_m = ceilingZAtX(e, s_m);
+      env.floor_z_m = floorZAtX(e, s_m);
+      break;
+    case EnvKind::Plane: {
+      // Ramp surface extended as a plane (z = slope * (x - door)), flat ceiling.
+      const double slope = rampHeight(e) / e.ramp_len_m;
+      env.floor_plane = Plane{-slope, 0.0, 1.0, slope * e.door_x_m};
+      env.ceiling_plane = Plane{0.0, 0.0, 1.0, -e.container_h_m};
+      break;
+    }
+    case EnvKind::Callback:
+      env.floor_z_at_x_m = [e](double x) { return floorZAtX(e, x); };
+      env.ceiling_z_at_x_m = [e](double x) { return ceilingZAtX(e, x); };
+      break;
+    case EnvKind::Profile:
+      env.profile = scenarioProfile();
+      break;
+  }
+  return env;
+}
+
+// Config used by example_sim_trajectory (lookahead off by default there).
+inline ControllerConfig scenarioConfig() {
+  ControllerConfig cfg;
+  cfg.margin_top_m = 0.12;
+  cfg.margin_bottom_m = 0.04;
+  cfg.warn_threshold_m = 0.18;
+  cfg.search_lift_half_range_m = 0.20;
+  cfg.search_tilt_half_range_rad = 0.25;
+  cfg.grid_lift_steps = 41;
+  cfg.grid_tilt_steps = 41;
+  cfg.base_lift_rate_limit_m_s = 0.18;
+  cfg.base_tilt_rate_limit_rad_s = 0.28;
+  cfg.mpc_assumed_forward_speed_m_s = 0.1;
+  return cfg;
+}
+
+// Closed-loop drive from the ground, up the ramp and into the container with the grid controller,
+// recorded as controller inputs (profile environment). Computed once.
+inline const std::vector<ControlInput>& scenarioInputs() {
+  static const std::vector<ControlInput> inputs = [] {
+    Controller controller(scenarioConfig());
+    std::vector<ControlInput> out;
+    sim::runScenario(controller, sim::dockingDemoScenario(), [&](const DebugFrame& fr) {
+      ControlInput in = fr.in;
+      in.env = makeEnv(EnvKind::Profile, in.s_m);
+      out.push_back(in);
+    });
+    return out;
+  }();
+  return inputs;
+}
+
+// Scenario inputs with the environment swapped to the requested representation.
+inline std::vector<ControlInput> scenarioInputs(EnvKind kind) {
+  std::vector<ControlInput> inputs = scenarioInputs();
+  for (auto& in : inputs) in.env = makeEnv(kind, in.s_m);
+  return inputs;
+}
+
+// Per-iteration latency samples for percentile counters.
+class LatencyRecorder {
+ public:
+  explicit LatencyRecorder(std::size_t reserve) { samples_ns_.reserve(reserve); }
+
+  template <typename Fn>
+  void time(Fn&& fn) {
+    const auto t0 = std::chrono::steady_clock::now();
+    fn();
+    const auto t1 = std::chrono::steady_clock::now();
+    samples_ns_.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count());
+  }
+
+  // q in [0, 1]; 0 when there are no samples.
+  double percentile(double q) {
+    if (samples_ns_.empty()) return 0.0;
+    const std::size_t k = std::min(samples_ns_.size() - 1, static_cast<std::size_t>(q * static_cast<double>(samples_ns_.size())));
+    std::nth_element(samples_ns_.begin(), samples_ns_.begin() + static_cast<std::ptrdiff_t>(k), samples_ns_.end());
+    return samples_ns_[k];
+  }
+
+ private:
+  std::vector<double> samples_ns_;
+};
+
+}  // namespace tlf::bench
@@ -0,0 +1,144 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BenchScenario.hpp"
+#include "controller/Controller.hpp"
+#include "controller/ControllerFleet.hpp"
+#include "controller/ControllerMPC.hpp"
+
+using namespace tlf;
+using namespace tlf::bench;
+
+// Replays the recorded scenario through one controller; reports mean ns/step (benchmark time) plus
+// p50/p99 per-step latency counters.
+template <typename ControllerT>
+static void runSteps(benchmark::State& state, const ControllerConfig& cfg, EnvKind env, const std::string& label) {
+  const auto inputs = scenarioInputs(env);
+  ControllerT controller(cfg);
+  ControlOutput out;
+
+  controller.warmup(inputs.front());
+
+  LatencyRecorder latency(1u << 20);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    latency.time([&] { controller.step(inputs[i], out); });
+    benchmark::DoNotOptimize(out.cmd.lift_target_m);
+    if (++i == inputs.size()) {
+      i = 0;
+      controller.reset();
+    }
+  }
+  state.counters["p50_ns"] = latency.percentile(0.50);
+  state.counters["p99_ns"] = latency.percentile(0.99);
+  state.counters["evals"] = benchmark::Counter(static_cast<double>(out.candidates_evaluated));
+  state.SetLabel(label + "/" + toString(env));
+}
+
+// Args: {grid steps per axis, lookahead on/off, env kind}
+static void BM_ControllerStep(benchmark::State& state) {
+  ControllerConfig cfg = scenarioConfig();
+  cfg.grid_lift_steps = static_cast<int>(state.range(0));
+  cfg.grid_tilt_steps = static_cast<int>(state.range(0));
+  cfg.lookahead_s_m = state.range(1) ? 0.25 : 0.0;
+  runSteps<Controller>(state, cfg, static_cast<EnvKind>(state.range(2)), state.range(1) ? "lookahead" : "now");
+}
+BENCHMARK(BM_ControllerStep)->ArgsProduct({{9, 21, 41, 61}, {0, 1}, {0, 1, 2, 3}});
+
+// Args: {grid steps per axis, env kind}. Same as BM_ControllerStep (no lookahead) with float32 scoring.
+static void BM_ControllerStepFloat32(benchmark::State& state) {
+  ControllerConfig cfg = scenarioConfig();
+  cfg.grid_lift_steps = static_cast<int>(state.range(0));
+  cfg.grid_tilt_steps = static_cast<int>(state.range(0));
+  cfg.float32_candidates = true;
+  runSteps<Controller>(state, cfg, static_cast<EnvKind>(state.range(1)), "float32");
+}
+BENCHMARK(BM_ControllerStepFloat32)->ArgsProduct({{21, 41, 61}, {0, 1, 2, 3}});
+
+// Args: {horizon steps, beam width, lookahead on/off, env kind}
+static void BM_ControllerMPCStep(benchmark::State& state) {
+  ControllerConfig cfg = scenarioConfig();
+  cfg.mpc_horizon_steps = static_cast<int>(state.range(0));
+  cfg.mpc_beam_width = static_cast<int>(state.range(1));
+  cfg.lookahead_s_m = state.range(2) ? 0.25 : 0.0;
+  runSteps<ControllerMPC>(state, cfg, static_cast<EnvKind>(state.range(3)), state.range(2) ? "lookahead" : "now");
+}
+BENCHMARK(BM_ControllerMPCStep)->ArgsProduct({{5, 8, 12}, {40, 120}, {0, 1}, {0, 1, 2, 3}});
+
+// Args: {step_time_budget_us (0 = unlimited)}; horizon 12, beam 120, scalar env.
+static void BM_ControllerMPCStepBudget(benchmark::State& state) {
+  ControllerConfig cfg = scenarioConfig();
+  cfg.mpc_horizon_steps = 12;
+  cfg.mpc_beam_width = 120;
+  cfg.step_time_budget_us = static_cast<int>(state.range(0));
+  runSteps<ControllerMPC>(state, cfg, EnvKind::Scalar, state.range(0) ? "budget" : "unlimited");
+}
+BENCHMARK(BM_ControllerMPCStepBudget)->Arg(0)->Arg(20)->Arg(50)->Arg(100);
+
+// Truck parked at the doorway with micron-level sensor noise. Args: {grid / MPC, reuse_unchanged_input}
+static void BM_ParkedStep(benchmark::State& state) {
+  ControllerConfig cfg = scenarioConfig();
+  cfg.reuse_unchanged_input = state.range(1) != 0;
+  std::unique_ptr<IController> controller;
+  if (state.range(0) == 0) {
+    controller = std::make_unique<Controller>(cfg);
+  } else {
+    controller = std::make_unique<ControllerMPC>(cfg);
+  }
+  // Last pose before the door.
+  const auto inputs = scenarioInputs(EnvKind::Scalar);
+  ControlInput in = inputs.front();
+  for (const auto& candidate : inputs) {
+    if (candidate.s_m >= 0.0) break;
+    in = candidate;
+  }
+  ControlOutput out;
+  const double s0 = in.s_m;
+  controller->step(in, out);
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    in.s_m = s0 + ((++i & 1) ? 2e-6 : -2e-6);
+    controller->step(in, out);
+    benchmark::DoNotOptimize(out.cmd.lift_target_m);
+  }
+  state.counters["evals"] = benchmark::Counter(static_cast<double>(out.candidates_evaluated));
+  state.SetLabel(std::string(state.range(0) == 0 ? "grid" : "mpc") + (cfg.reuse_unchanged_input ? "/reuse" : "/search"));
+}
+BENCHMARK(BM_ParkedStep)->ArgsProduct({{0, 1}, {0, 1}});
+
+// Args: {trucks, threads}. One fleet tick over the profile scenario, trucks phase-shifted along it;
+// only the measured fields are updated per tick (the site environment is assigned once).
+static void BM_FleetStep(benchmark::State& state) {
+  const auto& inputs = scenarioInputs();
+  const auto trucks = static_cast<std::size_t>(state.range(0));
+  ControllerFleet fleet(ControllerKind::GridSearch, scenarioConfig(), trucks, static_cast<int>(state.range(1)));
+  const std::size_t site = fleet.addSite(inputs.front().env);
+  for (std::size_t t = 0; t < trucks; ++t) fleet.assignSite(t, site);
+
+  std::size_t tick = 0;
+  for (auto _ : state) {
+    for (std::size_t t = 0; t < trucks; ++t) {
+      const ControlInput& src = inputs[(tick + t * 37) % inputs.size()];
+      ControlInput& in = fleet.input(t);
+      in.dt_s = src.dt_s;
+      in.s_m = src.s_m;
+      in.pitch_rad = src.pitch_rad;
+      in.pitch_rate_rad_s = src.pitch_rate_rad_s;
+      in.terrain = src.terrain;
+      in.lift_pos_m = src.lift_pos_m;
+      in.tilt_rad = src.tilt_rad;
+      in.rack = src.rack;
+      in.forklift = src.forklift;
+    }
+    fleet.step();
+    benchmark::DoNotOptimize(fleet.commands()[0].lift_target_m);
+    ++tick;
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * static_cast<std::int64_t>(trucks));
+}
+BENCHMARK(BM_FleetStep)->ArgsProduct({{8, 64}, {1, 2, 4}})->UseRealTime();
@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "BenchScenario.hpp"
+#include "model/Geometry.hpp"
+#include "model/GeometryKernels.hpp"
+
+using namespace tlf;
+using namespace tlf::bench;
+
+// Args: {env kind}
+static void BM_ComputeRackCorners2D(benchmark::State& state) {
+  const auto inputs = scenarioInputs(static_cast<EnvKind>(state.range(0)));
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const ControlInput& in = inputs[i];
+    benchmark::DoNotOptimize(computeRackCorners2D(in.s_m, in.lift_pos_m, in.pitch_rad, in.tilt_rad, in.env, in.rack, in.forklift));
+    if (++i == inputs.size()) i = 0;
+  }
+  state.SetLabel(toString(static_cast<EnvKind>(state.range(0))));
+}
+BENCHMARK(BM_ComputeRackCorners2D)->DenseRange(0, 3);
+
+// Args: {env kind}
+static void BM_ComputeClearances(benchmark::State& state) {
+  const auto inputs = scenarioInputs(static_cast<EnvKind>(state.range(0)));
+  std::vector<CornerPoints2D> corners;
+  corners.reserve(inputs.size());
+  for (const auto& in : inputs) {
+    corners.push_back(computeRackCorners2D(in.s_m, in.lift_pos_m, in.pitch_rad, in.tilt_rad, in.env, in.rack, in.forklift));
+  }
+  std::size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(computeClearances(corners[i], inputs[i].env, 0.12, 0.04));
+    if (++i == inputs.size()) i = 0;
+  }
+  state.SetLabel(toString(static_cast<EnvKind>(state.range(0))));
+}
+BENCHMARK(BM_ComputeClearances)->DenseRange(0, 3);
+
+// One full lift x tilt grid per iteration. Args: {grid steps per axis, env kind}
+static void BM_ComputeClearancesBatch(benchmark::State& state) {
+  const auto inputs = scenarioInputs(static_cast<EnvKind>(state.range(1)));
+  const auto n = static_cast<std::size_t>(state.range(0));
+  std::vector<double> lifts(n), tilts(n);
+  ClearanceBatch batch;
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const ControlInput& in = inputs[i];
+    for (std::size_t k = 0; k < n; ++k) {
+      const double t = static_cast<double>(k) / static_cast<double>(n - 1);
+      lifts[k] = in.lift_pos_m - 0.2 + 0.4 * t;
+      tilts[k] = in.tilt_rad - 0.25 + 0.5 * t;
+    }
+    computeClearancesBatch(in.s_m, lifts.data(), n, tilts.data(), n, in.pitch_rad, in.env, in.rack, in.forklift, 0.12, 0.04, &batch);
+    benchmark::DoNotOptimize(batch.clearance_top_m.data());
+    if (++i == inputs.size()) i = 0;
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(n * n));
+  state.SetLabel(toString(static_cast<EnvKind>(state.range(1))));
+}
+BENCHMARK(BM_ComputeClearancesBatch)->ArgsProduct({{9, 21, 41, 61}, {0, 1, 2, 3}});
+
+// Float32 scoring kernel on the same grids. Args: {grid steps per axis, env kind}
+static void BM_ComputeClearancesBatchF(benchmark::State& state) {
+  const auto inputs = scenarioInputs(static_cast<EnvKind>(state.range(1)));
+  const auto n = static_cast<std::size_t>(state.range(0));
+  std::vector<double> lifts(n), tilts(n);
+  ClearanceBatchF batch;
+  std::size_t i = 0;
+  for (auto _ : state) {
+    const ControlInput& in = inputs[i];
+    for (std::size_t k = 0; k < n; ++k) {
+      const double t = static_cast<double>(k) / static_cast<double>(n - 1);
+      lifts[k] = in.lift_pos_m - 0.2 + 0.4 * t;
+      tilts[k] = in.tilt_rad - 0.25 + 0.5 * t;
+    }
+    visitEnvironment(in.env, [&](const auto& ceiling, const auto& floor) {
+      clearancesBatchWithF(in.s_m, lifts.data(), n, tilts.data(), n, in.pitch_rad, ceiling, floor, in.rack, in.forklift,
+                           0.12, 0.04, &batch);
+    });
+    benchmark::DoNotOptimize(batch.clearance_top_m.data());
+    if (++i == inputs.size()) i = 0;
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(n * n));
+  state.SetLabel(toString(static_cast<EnvKind>(state.range(1))));
+}
+BENCHMARK(BM_ComputeClearancesBatchF)->ArgsProduct({{9, 21, 41, 61}, {0, 1, 2, 3}});
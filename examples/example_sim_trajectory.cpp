@@ -1,125 +1,36 @@
-#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
 
-#include "controller/Controller.hpp"
 #include "controller/ControllerFactory.hpp"
+#include "sim/Simulation.hpp"
+#include "utils/AsyncLogger.hpp"
+#include "utils/BinaryLog.hpp"
 #include "utils/CsvLog.hpp"
+#include "utils/TelemetryServer.hpp"
 
 using namespace tlf;
 
-static double clamp(double v, double lo, double hi) { return std::max(lo, std::min(hi, v)); }
-
-struct SimState {
-  double time_s{0.0};
-  double s_m{-3.6};
-  double pitch_rad{0.0};
-  double pitch_rate_rad_s{0.0};
-  double lift_m{0.0};   // Lower initial lift to fit under door
-  double tilt_rad{0.0};
-  TerrainState terrain{TerrainState::Ground};
-};
-
-struct EnvSpec {
-  double door_x_m{0.0};
-  double container_len_m{8.0};
-  double container_h_m{2.5};
-  double ramp_len_m{2.5};
-  double ramp_slope_deg{4.0};
-  double ground_len_m{4.0};
-};
-
-static double floorZAtX(const EnvSpec& e, double x_m) {
-  const double h = std::tan(e.ramp_slope_deg * M_PI / 180.0) * e.ramp_len_m;
-  const double groundZ = -h;
-  const double rampStartX = e.door_x_m - e.ramp_len_m;
-
-  // inside container (extends +x from door)
-  if (x_m >= e.door_x_m && x_m <= (e.door_x_m + e.container_len_m)) return 0.0;
-
-  // on ground beyond ramp start (further outside)
-  if (x_m <= rampStartX) return groundZ;
-
-  // on ramp: interpolate between rampStartX (groundZ) and door (0)
-  if (x_m > rampStartX && x_m < e.door_x_m) {
-    const double t = (x_m - rampStartX) / (e.door_x_m - rampStartX);
-    return (1.0 - t) * groundZ + t * 0.0;
-  }
-
-  // outside (beyond container far end): assume container floor
-  return 0.0;
-}
-
-static double ceilingZAtX(const EnvSpec& e, double x_m) {
-  // Inside container: use container ceiling height
-  if (x_m >= e.door_x_m && x_m <= (e.door_x_m + e.container_len_m)) return e.container_h_m;
-  // Outside container: use a conservative “virtual ceiling” equal to the door height.
-  // This prevents the controller from drifting upward to center within an unrealistically high outside ceiling,
-  // which can later cause a hard ceiling strike as the front of the load enters the container region.
-  return e.container_h_m;
-}
-
-static double pitchFromWheelContact(const EnvSpec& e,
-                                   double mast_x_m,
-                                   double wheelbase_m,
-                                   double rear_to_mast_m) {
-  // Vehicle heads +x into container: wheels are behind mast in -x.
-  // "Near" wheel is closer to mast (more forward), "far" wheel is further outside.
-  const double x_near = mast_x_m - rear_to_mast_m;
-  const double x_far = x_near - wheelbase_m;
-  const double z_near = floorZAtX(e, x_near);
-  const double z_far = floorZAtX(e, x_far);
-  return std::atan2(z_near - z_far, x_near - x_far);
-}
-
-static TerrainState terrainFromPitch(double pitch_rad) {
-  const double deg = std::abs(pitch_rad) * 180.0 / M_PI;
-  if (deg < 0.5) return TerrainState::Ground;
-  return TerrainState::OnRamp;
-}
-
 int main(int argc, char** argv) {
   // Default to a local file (easier to pick in the web viewer than macOS /tmp).
   std::string out_path = "tlf_log.csv";
+  std::string bin_path;  // optional binary log written alongside the CSV
   ControllerKind controller_kind = ControllerKind::GridSearch;
+  int live_port = -1;  // --live PORT: stream to the web viewer and run in real time
   for (int i = 1; i < argc; ++i) {
     if (std::string(argv[i]) == "--out" && i + 1 < argc) out_path = argv[++i];
+    if (std::string(argv[i]) == "--out-bin" && i + 1 < argc) bin_path = argv[++i];
     if (std::string(argv[i]) == "--controller" && i + 1 < argc) controller_kind = controllerKindFromString(argv[++i]);
+    if (std::string(argv[i]) == "--live" && i + 1 < argc) live_port = std::atoi(argv[++i]);
   }
 
-  ControllerConfig cfg;
-  {
-    // Keep more headroom to the ceiling throughout.
-    // Note: total required (top+bottom) margin must remain physically feasible given rack height.
-    cfg.margin_top_m = 0.12;
-    cfg.margin_bottom_m = 0.04;
-    // Start slowing down earlier when clearance gets tight.
-    cfg.warn_threshold_m = 0.18;
-
-    cfg.search_lift_half_range_m = 0.20;
-    cfg.search_tilt_half_range_rad = 0.25;
-    cfg.grid_lift_steps = 41;
-    cfg.grid_tilt_steps = 41;
-
-    cfg.lookahead_s_m = 0.25;
-
-  // Disable lookahead for this simple open-loop sim.
-  // With a tall load near the doorway, enforcing feasibility at both s and (s + lookahead)
-  // using the same (lift, tilt) can be overly conservative and lead to stalling.
-  cfg.lookahead_s_m = 0.0;
-
-    // If using MPC in this sim, give it a reasonable forward-speed guess for s prediction.
-    // (The plant actually advances using min(v, speed_limit).)
-    if (controller_kind == ControllerKind::MPC) {
-      cfg.mpc_assumed_forward_speed_m_s = 0.1;
-    }
-
-    cfg.base_lift_rate_limit_m_s = 0.18;
-    cfg.base_tilt_rate_limit_rad_s = 0.28;
-  }
-
+  // Scenario, plant and tuned config live in the sim module (shared with tlf_sweep).
+  const ControllerConfig cfg = sim::dockingDemoConfig(controller_kind);
   auto controller = makeController(controller_kind, cfg);
-  controller->reset();
 
   CsvLogger log(out_path);
   if (!log.good()) {
@@ -128,87 +39,57 @@ int main(int argc, char** argv) {
   }
   log.writeHeader();
 
-  SimState st;
-
-  const EnvSpec envSpec;
-
-  RackParams rack;
-  rack.height_m = 2.32;
-  rack.length_m = 2.2;
-  rack.mount_offset_m = {0.25, 0.00};  // Lower cargo mounting
-
-  ForkliftParams fl;
-
-  const double dt = 0.1;
-  const double v = 0.1;  // base forward speed
-
-  // Vehicle geometry used for pitch-from-wheel-contact model.
-  const double wheelbase_m = 2.0;
-  const double rear_to_mast_m = 0.1;
-  const double pivot_height_above_floor_m = 0.15;  // Lower mast pivot to reduce overall height
-
-  fl.mast_pivot_height_m = pivot_height_above_floor_m;
-
-  double current_speed = 0.0;  // current forward speed for smooth acceleration
-
-  for (int k = 0; k < 6000; ++k) {
-    const double pitch = pitchFromWheelContact(envSpec, st.s_m, wheelbase_m, rear_to_mast_m);
-    const double pitch_rate = (pitch - st.pitch_rad) / dt;
-
-    const TerrainState terr = terrainFromPitch(pitch);
-
-    EnvironmentGeometry env;
-    env.ceiling_z_at_x_m = [&](double x) { return ceilingZAtX(envSpec, x); };
-    env.floor_z_at_x_m = [&](double x) { return floorZAtX(envSpec, x); };
-    env.ceiling_z_m = ceilingZAtX(envSpec, st.s_m);
-    env.floor_z_m = floorZAtX(envSpec, st.s_m);
-
-    ControlInput in;
-    in.dt_s = dt;
-    in.s_m = st.s_m;
-    in.pitch_rad = pitch;
-    in.pitch_rate_rad_s = pitch_rate;
-    in.terrain = terr;
-
-    // Kinematics contract: lift_pos_m is carriage travel along mast (meters).
-    in.lift_pos_m = st.lift_m;
-    in.tilt_rad = st.tilt_rad;
-
-    in.env = env;
-    in.rack = rack;
-    in.forklift = fl;
-    in.inputs_valid = true;
-
-    const DebugFrame fr = controller->step(in);
-
-    // simple actuator following: rate-limited towards targets
-    const double lift_err = fr.cmd.lift_target_m - st.lift_m;
-    const double lift_step = clamp(lift_err, -fr.cmd.lift_rate_limit_m_s * dt, fr.cmd.lift_rate_limit_m_s * dt);
-    st.lift_m += lift_step;
-
-    const double tilt_err = fr.cmd.tilt_target_rad - st.tilt_rad;
-    const double tilt_step = clamp(tilt_err, -fr.cmd.tilt_rate_limit_rad_s * dt, fr.cmd.tilt_rate_limit_rad_s * dt);
-    st.tilt_rad += tilt_step;
-
-    // move forward with speed limit and smooth acceleration
-    const double target_speed = std::min(v, fr.cmd.speed_limit_m_s);
-    const double accel_limit = 0.4;  // m/s² acceleration limit for smooth motion
-    const double speed_err = target_speed - current_speed;
-    const double speed_step = clamp(speed_err, -accel_limit * dt, accel_limit * dt);
-    current_speed += speed_step;
-    // Move into container (+x): s increases.
-    st.s_m += current_speed * dt;
+  std::unique_ptr<BinaryLogger> bin_log;
+  if (!bin_path.empty()) {
+    bin_log = std::make_unique<BinaryLogger>(bin_path, LogCodec::Zstd);
+    if (!bin_log->good()) {
+      std::cerr << "Failed to open log: " << bin_path << "\n";
+      return 1;
+    }
+  }
 
-    st.time_s += dt;
-    st.pitch_rate_rad_s = pitch_rate;
-    st.pitch_rad = pitch;
-    st.terrain = terr;
+  // Writers run on background threads; Block keeps the logs complete even if the disk falls behind.
+  auto log_async = std::make_unique<AsyncLogger>(log, 4096, LogOverflowPolicy::Block);
+  std::unique_ptr<AsyncLogger> bin_async;
+  if (bin_log) bin_async = std::make_unique<AsyncLogger>(*bin_log, 4096, LogOverflowPolicy::Block);
+
+  // Live telemetry is best effort: Drop rather than ever stall the control loop on a slow viewer.
+  std::unique_ptr<WebSocketTelemetrySink> live;
+  std::unique_ptr<AsyncLogger> live_async;
+  if (live_port >= 0) {
+    TelemetryOptions opt;
+    opt.port = static_cast<std::uint16_t>(live_port);
+    live = std::make_unique<WebSocketTelemetrySink>(opt);
+    if (!live->good()) {
+      std::cerr << "Failed to start telemetry server: " << live->error() << "\n";
+      return 1;
+    }
+    live_async = std::make_unique<AsyncLogger>(*live, 4096, LogOverflowPolicy::Drop);
+    std::cout << "Streaming telemetry on ws://" << opt.bind_address << ":" << live->port() << std::endl;
+  }
 
-    log.writeFrame(fr);
+  const sim::Scenario scenario = sim::dockingDemoScenario();
+  const auto period = std::chrono::duration<double>(scenario.dt_s);
+  auto next_tick = std::chrono::steady_clock::now();
+  sim::runScenario(*controller, scenario, [&](const DebugFrame& fr) {
+    log_async->pushFrame(fr);
+    if (bin_async) bin_async->pushFrame(fr);
+    if (live_async) {
+      live_async->pushFrame(fr);
+      next_tick += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+      std::this_thread::sleep_until(next_tick);
+    }
+  });
 
-    if (st.s_m > 5) break;
-  }
+  // Drain and flush both logs before reporting them.
+  log_async.reset();
+  bin_async.reset();
+  live_async.reset();
 
   std::cout << "Wrote log: " << out_path << "\n";
+  if (bin_log) {
+    bin_log->flush();
+    std::cout << "Wrote binary log: " << bin_path << " (codec " << toString(bin_log->codec()) << ")\n";
+  }
   return 0;
 }
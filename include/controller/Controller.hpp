@@ -1,6 +1,15 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "controller/IController.hpp"
+#include "controller/SearchCore.hpp"
+#include "model/ClearanceCache.hpp"
+#include "model/FeasibilityEnvelope.hpp"
+#include "model/GeometryKernels.hpp"
+#include "controller/SolveAnchor.hpp"
 #include "controller/Types.hpp"
 
 namespace tlf {
@@ -10,20 +19,77 @@ class Controller : public IController {
   explicit Controller(ControllerConfig cfg = {});
 
   const ControllerConfig& config() const override { return cfg_; }
-  ControllerConfig& config() override { return cfg_; }
+  ControllerConfig& config() override {
+    config_dirty_ = true;
+    return cfg_;
+  }
+  bool configure(const ControllerConfig& cfg, std::string* error = nullptr) override;
+  void warmup(const ControlInput& in) override;
 
   // Stateless from caller perspective; internal state is used only for smoothing.
   DebugFrame step(const ControlInput& in) override;
+  void step(const ControlInput& in, ControlOutput& out) override;
 
   void reset() override;
 
+  // Clearance memo (see ControllerConfig::clearance_cache_*); cumulative hit/miss counters for tuning.
+  const ClearanceCache& clearanceCache() const { return cache_; }
+
+  // Optional precomputed feasible bands for the current container type: while the input is inside the
+  // table (and rack/forklift/margins match, see FeasibilityEnvelope::accepts) the search window is
+  // clamped to the bin's bands, so the same grid samples a smaller area. Otherwise the full window is
+  // searched. The envelope must match the geometry passed in ControlInput::env. nullptr disables it.
+  void setFeasibilityEnvelope(std::shared_ptr<const FeasibilityEnvelope> envelope) { envelope_ = std::move(envelope); }
+  const std::shared_ptr<const FeasibilityEnvelope>& feasibilityEnvelope() const { return envelope_; }
+
+  const ControllerInstrumentation& instrumentation() const override { return instr_; }
+  ControllerInstrumentation& instrumentation() override { return instr_; }
+
  private:
+  // Shared implementation; dbg (optional) receives the diagnostics-only fields.
+  void solve(const ControlInput& in, ControlOutput& out, DebugFrame* dbg);
+
+  // Recomputes tables_ and sizes the workspaces for cfg_ (the constructor accepts any config, as the
+  // step clamps grid sizes itself).
+  void applyConfig();
+
   ControllerConfig cfg_;
+  ConfigTables tables_;
+  bool config_dirty_{false};
+  bool warming_up_{false};
   double time_s_{0.0};
 
   // smoothing memory
   double prev_lift_rate_m_s_{0.0};
   double prev_tilt_rate_rad_s_{0.0};
+
+  // Per-step workspaces, reused across steps.
+  std::vector<double> lift_grid_;
+  std::vector<double> tilt_grid_;
+  ClearanceBatch batch_;
+  ClearanceBatch batch_ahead_;
+  ClearanceBatchF batchf_;
+  ClearanceBatchF batchf_ahead_;
+  // float32_candidates workspaces.
+  struct PendingCandidate {
+    std::uint32_t key;  // i_lift * n_tilt + j_tilt
+    double cost_lo;     // lower cost bound; -inf while feasibility is undecided, +inf if surely infeasible
+    double min_clear;
+    bool surely_feasible;
+  };
+  std::vector<PendingCandidate> pending_;
+  std::vector<double> cost_lift_terms_;
+  std::vector<double> cost_tilt_terms_;
+
+  ClearanceCache cache_;
+  std::shared_ptr<const FeasibilityEnvelope> envelope_;
+
+  // reuse_unchanged_input: last fully solved input and the target it selected.
+  SolveAnchor anchor_;
+  double anchor_lift_target_m_{0.0};
+  double anchor_tilt_target_rad_{0.0};
+
+  ControllerInstrumentation instr_;
 };
 
 }  // namespace tlf
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "controller/ControllerFactory.hpp"
+#include "controller/IController.hpp"
+#include "controller/Types.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace tlf {
+
+// Hosts N independent controllers (one per truck) and steps them together on a persistent worker pool.
+//
+// Each truck owns an input slot. Environments are registered once per container ("site") and copied into
+// the slots of the trucks assigned to it, so a site's TerrainProfile is shared read-only through its
+// shared_ptr and per-tick updates only touch the measured fields (s, pitch, lift, tilt, ...).
+// After step(), commands() is a contiguous array of size() commands, in truck order, that a fieldbus
+// publisher can send in place. To log a truck, push toLogRecord(input(i), output(i)) (or
+// AsyncLogger::pushFrame(input(i), output(i))) after step().
+//
+// Trucks are independent, so results match stepping each controller serially for any thread count.
+// Environment callbacks (if a site uses them) must be safe to call concurrently; keep
+// mpc_num_threads = 1 so MPC controllers do not start pools of their own inside the fleet's.
+class ControllerFleet {
+ public:
+  // `threads` is the total parallelism including the calling thread (see ThreadPool).
+  ControllerFleet(ControllerKind kind, const ControllerConfig& cfg, std::size_t trucks, int threads = 1);
+
+  std::size_t size() const { return controllers_.size(); }
+  int threads() const { return pool_ ? pool_->size() : 1; }
+
+  // Registers a container/ramp environment and returns its site index.
+  std::size_t addSite(EnvironmentGeometry env);
+  std::size_t sites() const { return sites_.size(); }
+  // Points the truck's input slot at a site's environment (one copy, not per tick).
+  void assignSite(std::size_t truck, std::size_t site);
+
+  // Per-truck input slot; update the measured fields before each step().
+  ControlInput& input(std::size_t truck) { return inputs_[truck]; }
+  const ControlInput& input(std::size_t truck) const { return inputs_[truck]; }
+
+  // Steps every truck from its input slot.
+  void step();
+  // Steps every truck from a caller-owned batch of size() inputs (environments included).
+  void step(const ControlInput* inputs);
+
+  // Results of the last step, indexed by truck.
+  const ControlCommand* commands() const { return commands_.data(); }
+  const ControlOutput* outputs() const { return outputs_.data(); }
+  const ControlOutput& output(std::size_t truck) const { return outputs_[truck]; }
+
+  IController& controller(std::size_t truck) { return *controllers_[truck]; }
+  const IController& controller(std::size_t truck) const { return *controllers_[truck]; }
+
+  void reset();
+
+  // Warms every truck's controller from its input slot (see IController::warmup), on the fleet's
+  // workers so they are started too. Call once the slots hold representative inputs.
+  void warmup();
+
+ private:
+  void stepFrom(const ControlInput* inputs);
+
+  std::vector<std::unique_ptr<IController>> controllers_;
+  std::vector<ControlInput> inputs_;
+  std::vector<ControlOutput> outputs_;
+  std::vector<ControlCommand> commands_;
+  std::vector<EnvironmentGeometry> sites_;
+  std::unique_ptr<ThreadPool> pool_;  // null when threads <= 1
+};
+
+}  // namespace tlf
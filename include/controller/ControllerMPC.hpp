@@ -1,6 +1,15 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "controller/IController.hpp"
+#include "controller/SearchCore.hpp"
+#include "controller/SolveAnchor.hpp"
+#include "model/ClearanceCache.hpp"
+#include "utils/ThreadPool.hpp"
 
 namespace tlf {
 
@@ -11,18 +20,137 @@ class ControllerMPC final : public IController {
   explicit ControllerMPC(ControllerConfig cfg = {});
 
   const ControllerConfig& config() const override { return cfg_; }
-  ControllerConfig& config() override { return cfg_; }
+  ControllerConfig& config() override {
+    config_dirty_ = true;
+    return cfg_;
+  }
+  bool configure(const ControllerConfig& cfg, std::string* error = nullptr) override;
+  void warmup(const ControlInput& in) override;
 
   DebugFrame step(const ControlInput& in) override;
+  void step(const ControlInput& in, ControlOutput& out) override;
   void reset() override;
 
+  // Clearance memo (see ControllerConfig::clearance_cache_*); cumulative hit/miss counters for tuning.
+  const ClearanceCache& clearanceCache() const { return cache_; }
+
+  const ControllerInstrumentation& instrumentation() const override { return instr_; }
+  ControllerInstrumentation& instrumentation() override { return instr_; }
+
  private:
+  struct SeqNode {
+    double cost{0.0};
+    // predicted state
+    double s_m{0.0};
+    double lift_m{0.0};
+    double tilt_rad{0.0};
+    double last_lift_rate{0.0};
+    double last_tilt_rate{0.0};
+    // first action (to output)
+    double u0_lift_rate{0.0};
+    double u0_tilt_rate{0.0};
+    bool has_u0{false};
+    // Action indices (lift_idx * 5 + tilt_idx), 5 bits per step for the first kMaxWarmStartSteps steps.
+    std::uint64_t actions{0};
+    // Warm-start seed this node follows (-1 if none); seeded nodes survive pruning.
+    std::int8_t seed{-1};
+    // Lattice coordinates (units of 0.5 * rate_limit * dt from the step's start); used by mpc_dedup_states.
+    std::int16_t lift_q{0};
+    std::int16_t tilt_q{0};
+  };
+
+  // One point of the per-level state lattice (mpc_dedup_states). stamp == lattice_epoch_ marks it as
+  // used at the current level; node is its surviving entry in next_ (-1 until the dedup pass).
+  struct LatticeCell {
+    std::uint32_t stamp{0};
+    int node{-1};
+    double clearance_top_m{0.0};
+    double clearance_bottom_m{0.0};
+    bool feasible{false};
+  };
+
+  static constexpr int kActionsPerAxis = 5;
+  static constexpr int kActionCount = kActionsPerAxis * kActionsPerAxis;
+  // Lattice displacement of each action index for mpc_dedup_states (rates are {-1, -0.5, 0, 0.5, 1} x limit).
+  static constexpr int kLatticeMoves[kActionsPerAxis] = {-2, -1, 0, 1, 2};
+  static constexpr int kMaxWarmStartSteps = 12;
+  static constexpr int kMaxSeeds = 5;  // shifted previous plan + 4 first-action neighbors
+
+  // Recomputes tables_ and the action rates for cfg_, then sizes the workspaces (the constructor accepts
+  // any config, as the step clamps beam, horizon and grid sizes itself).
+  void applyConfig();
+
+  // Sizes the node arena and fallback-grid buffers for the current config. Only reallocates when the
+  // beam width, thread count, horizon, dedup mode or grid size changed since the last call.
+  void ensureWorkspace();
+
+  // Shared implementation; dbg (optional) receives the diagnostics-only fields.
+  void solve(const ControlInput& in, ControlOutput& out, DebugFrame* dbg);
+
   ControllerConfig cfg_;
+  ConfigTables tables_;
+  // Action set: lift / tilt rates {-1, -0.5, 0, 0.5, 1} x rate limit, without / with the degraded multiplier.
+  double lift_rates_[2][kActionsPerAxis]{};
+  double tilt_rates_[2][kActionsPerAxis]{};
+  bool config_dirty_{false};
+  bool warming_up_{false};
   double time_s_{0.0};
 
   // smoothing memory (for cost regularization, not plant feedback)
   double prev_lift_rate_m_s_{0.0};
   double prev_tilt_rate_rad_s_{0.0};
+
+  // Double-buffered beam arena: frontier_ holds level k, next_ collects level k+1, then they swap.
+  // Both keep capacity for beam * 25 children.
+  std::vector<SeqNode> frontier_;
+  std::vector<SeqNode> next_;
+  int ws_beam_{0};
+  int ws_threads_{0};
+  int ws_horizon_{0};
+  bool ws_dedup_{false};
+  int ws_grid_lift_steps_{0};
+  int ws_grid_tilt_steps_{0};
+
+  // Parallel expansion (mpc_num_threads > 1): the frontier is split into contiguous chunks, each expanded
+  // into its own buffer; buffers are appended to next_ in chunk order so pruning sees the serial order.
+  std::unique_ptr<ThreadPool> pool_;
+  std::vector<std::vector<SeqNode>> chunk_children_;
+  std::vector<int> chunk_evaluated_;
+
+  // step_time_budget_us: frontier indices in expansion order (cheapest first), each frontier node's
+  // children range in next_, and the children regrouped in frontier order (same capacity as next_).
+  std::vector<int> expand_order_;
+  std::vector<int> child_begin_;
+  std::vector<int> child_counts_;
+  std::vector<SeqNode> regrouped_;
+
+  // State lattice for duplicate pruning: (4H+1)^2 cells, epoch-cleared per level.
+  std::vector<LatticeCell> lattice_;
+  std::vector<int> lattice_points_;  // indices of cells touched at the current level, in first-touch order
+  int lattice_half_{0};
+  std::uint32_t lattice_epoch_{0};
+
+  // Warm start: best action sequence of the previous step (receding horizon), and the seeds built from it.
+  std::array<std::uint8_t, kMaxWarmStartSteps> prev_plan_{};
+  int prev_plan_len_{0};
+  std::array<std::array<std::uint8_t, kMaxWarmStartSteps>, kMaxSeeds> seeds_{};
+  int n_seeds_{0};
+
+  // Fallback-grid workspaces, reused across steps.
+  std::vector<double> lift_grid_;
+  std::vector<double> tilt_grid_;
+  ClearanceBatch batch_;
+  ClearanceBatch batch_ahead_;
+
+  // Serves current-pose and horizon-state evaluations (serial expansion only).
+  ClearanceCache cache_;
+
+  // reuse_unchanged_input: last fully solved input, its best node and completed horizon levels.
+  SolveAnchor anchor_;
+  SeqNode anchor_node_;
+  int anchor_levels_{0};
+
+  ControllerInstrumentation instr_;
 };
 
 }  // namespace tlf
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <string>
+
 #include "controller/Types.hpp"
+#include "utils/Instrumentation.hpp"
 
 namespace tlf {
 
@@ -9,10 +12,34 @@ class IController {
   virtual ~IController() = default;
 
   virtual const ControllerConfig& config() const = 0;
+  // Changes made through this reference are picked up (tables recomputed, workspaces resized) on the
+  // next step(); call it again for every change rather than keeping the reference across steps.
   virtual ControllerConfig& config() = 0;
 
+  // Validates cfg (see validateConfig) and, if it is valid, applies it and precomputes everything
+  // step() derives from the config: limits with and without the degraded multipliers, grid axis
+  // fractions, action tables and workspace capacities. An invalid cfg leaves the controller unchanged.
+  virtual bool configure(const ControllerConfig& cfg, std::string* error = nullptr) = 0;
+
+  // Runs a few steps from `in` (nominal and degraded) so buffers, the clearance cache, worker threads
+  // and the code paths are touched before the first real control cycle, then reset()s. Warmup steps
+  // are not recorded in instrumentation(). Call it after configure() and before the control loop, with
+  // an input that resembles the first real one (same environment, rack and forklift).
+  virtual void warmup(const ControlInput& in) = 0;
+
+  // Full diagnostics (copies the input and corner geometry into the frame).
   virtual DebugFrame step(const ControlInput& in) = 0;
+
+  // Hot-path entry point: writes command + safety into caller-owned storage. Same decisions as the
+  // DebugFrame overload, without the input copy.
+  virtual void step(const ControlInput& in, ControlOutput& out) = 0;
+
   virtual void reset() = 0;
+
+  // Per-step latency and search counters, accumulated across steps (not cleared by reset()).
+  // snapshot() is safe from another thread while step() runs.
+  virtual const ControllerInstrumentation& instrumentation() const = 0;
+  virtual ControllerInstrumentation& instrumentation() = 0;
 };
 
 }  // namespace tlf
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "controller/Types.hpp"
+#include "model/AxisSampling.hpp"
+#include "model/ClearanceCache.hpp"
+#include "model/Geometry.hpp"
+#include "utils/Deadline.hpp"
+
+namespace tlf {
+
+// Building blocks shared by the controllers (grid search, MPC and any later ControllerKind): input
+// validation and degraded limits, current-pose evaluation, safety classification, the speed policy and
+// command composition, candidate axes, and the max-min-clearance grid used when nothing is feasible.
+// Each controller keeps its own candidate cost and pruning; everything around them lives here.
+
+// Per-step values derived from the config and the input (degraded multipliers applied).
+struct StepLimits {
+  double dt_s{0.02};
+  bool degraded{false};
+  SafetyCode degraded_code{SafetyCode::None};
+
+  double margin_top_m{0.0};
+  double margin_bottom_m{0.0};
+  double lift_rate_limit_m_s{0.0};
+  double tilt_rate_limit_rad_s{0.0};
+  double speed_mult{1.0};
+
+  // Spatial lookahead (ControllerConfig::lookahead_s_m > 0) and the station it looks at.
+  bool use_lookahead{false};
+  double s_look_m{0.0};
+};
+
+// Rejects configs the controllers cannot run as intended: non-finite values, non-positive rate limits
+// or degraded multipliers, negative search ranges, cache quanta, reuse thresholds or budgets, a warn
+// threshold below the hard threshold, grid / horizon / beam / thread counts below 1, a coarse_grid_steps
+// below 4 and a local_refine_evals below 2. error (optional) names the first offending field.
+bool validateConfig(const ControllerConfig& cfg, std::string* error = nullptr);
+
+// Everything step() derives from the config alone, computed once by the controllers' configure() (and
+// again on the first step after the mutable config() accessor was used) instead of on every step.
+struct ConfigTables {
+  // Margins, rate limits and speed multiplier without / with the degraded multipliers.
+  struct Limits {
+    double margin_top_m{0.0};
+    double margin_bottom_m{0.0};
+    double lift_rate_limit_m_s{0.0};
+    double tilt_rate_limit_rad_s{0.0};
+    double speed_mult{1.0};
+  };
+  Limits nominal;
+  Limits degraded;
+  double pitch_rate_jitter_threshold_rad_s{0.0};
+  bool use_lookahead{false};
+  double lookahead_s_m{0.0};
+
+  // Grid sizes (at least 3; coarse at least 4) and the fillAxis fractions i / (n - 1) for each.
+  int grid_lift_steps{3};
+  int grid_tilt_steps{3};
+  int coarse_grid_steps{4};
+  std::vector<double> grid_lift_t;
+  std::vector<double> grid_tilt_t;
+  std::vector<double> coarse_t;
+};
+
+// Reuses the vectors' capacity in *tables.
+void makeConfigTables(const ControllerConfig& cfg, ConfigTables* tables);
+
+// Steps IController::warmup() runs from the caller's input, before one degraded step.
+inline constexpr int kWarmupSteps = 3;
+
+bool inputsFinite(const ControlInput& in);
+
+// Invalid, non-finite or jittery (pitch rate) inputs are DEGRADED: larger margins, lower rates/speed.
+StepLimits makeStepLimits(const ConfigTables& tables, const ControlInput& in);
+StepLimits makeStepLimits(const ControllerConfig& cfg, const ControlInput& in);
+
+// Per-side minimum of two clearance results, with the corner ids of the side minima.
+ClearanceResult worstCaseClearance(const ClearanceResult& now, const ClearanceResult& ahead);
+
+// Clearance of the current pose, and its worst case over now / lookahead (== now without lookahead).
+// Always exact: the cache serves these lookups only when it keys on the exact pose.
+struct CurrentPose {
+  ClearanceResult now;
+  ClearanceResult worst;
+};
+CurrentPose evaluateCurrentPose(ClearanceCache& cache, const ControlInput& in, const StepLimits& limits);
+
+// Corner and surface diagnostics of the current pose.
+void fillPoseDebug(const ControlInput& in, DebugFrame& dbg);
+
+// Level from the worst-case clearance; code_override replaces the geometric code (and is reported
+// even when OK). Degraded inputs are always DEGRADED.
+SafetyStatus makeSafety(const ControllerConfig& cfg,
+                        double clearance_top_m,
+                        double clearance_bottom_m,
+                        CornerId worst,
+                        bool degraded,
+                        SafetyCode code_override = SafetyCode::None);
+
+// Safety level of the current pose, without a search code.
+inline SafetyLevel currentSafetyLevel(const ControllerConfig& cfg, const StepLimits& limits, const CurrentPose& pose) {
+  return makeSafety(cfg, pose.worst.clearance_top_m, pose.worst.clearance_bottom_m, pose.worst.worst_point,
+                    limits.degraded)
+      .level;
+}
+
+// Writes targets, rate limits, the speed limit (reduced as the current min clearance approaches 0 and
+// when the pitch rate is high; 0 below the hard threshold) and the safety status. search_code is
+// reported unless the input is degraded.
+void composeCommand(const ControllerConfig& cfg,
+                    const StepLimits& limits,
+                    const ControlInput& in,
+                    const CurrentPose& pose,
+                    double lift_target_m,
+                    double tilt_target_rad,
+                    SafetyCode search_code,
+                    ControlOutput& out);
+
+// Smoothing memory: the rate that reaches target from current in one step, clamped to the limit.
+double smoothedRate(double target, double current, double dt, double limit);
+
+// Lift x tilt pose with the largest worst-case (now / lookahead) min clearance, the lowest lift-major
+// index winning ties. With an active deadline the rows of constant tilt are evaluated from the middle
+// row outwards until it expires; the result still matches the full pass when every row was evaluated.
+// If no row was evaluated the pose stays at (default_lift_m, default_tilt_rad).
+struct MaxMinClearancePick {
+  double min_clearance_m;
+  double lift_m;
+  double tilt_rad;
+  int evaluated;
+};
+MaxMinClearancePick maxMinClearanceGrid(const ControlInput& in,
+                                        const StepLimits& limits,
+                                        const std::vector<double>& lifts,
+                                        const std::vector<double>& tilts,
+                                        double default_lift_m,
+                                        double default_tilt_rad,
+                                        Deadline& deadline,
+                                        ClearanceBatch* batch,
+                                        ClearanceBatch* batch_ahead);
+
+}  // namespace tlf
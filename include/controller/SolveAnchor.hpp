@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cmath>
+
+#include "controller/Types.hpp"
+
+namespace tlf {
+
+// The input of the last full search and the safety level of its current pose, for
+// ControllerConfig::reuse_unchanged_input. Deltas are taken against this input (not the last reused
+// one), so slow creep cannot accumulate past the thresholds; a level change forces a search.
+struct SolveAnchor {
+  bool valid{false};
+  SafetyLevel level{SafetyLevel::OK};
+  double s_m{0.0};
+  double pitch_rad{0.0};
+  double lift_pos_m{0.0};
+  double tilt_rad{0.0};
+
+  void set(const ControlInput& in, SafetyLevel current_level) {
+    valid = true;
+    level = current_level;
+    s_m = in.s_m;
+    pitch_rad = in.pitch_rad;
+    lift_pos_m = in.lift_pos_m;
+    tilt_rad = in.tilt_rad;
+  }
+
+  bool matches(const ControlInput& in, SafetyLevel current_level, const ControllerConfig& cfg) const {
+    return valid && current_level == level && std::abs(in.s_m - s_m) <= cfg.reuse_threshold_s_m &&
+           std::abs(in.pitch_rad - pitch_rad) <= cfg.reuse_threshold_pitch_rad &&
+           std::abs(in.lift_pos_m - lift_pos_m) <= cfg.reuse_threshold_lift_m &&
+           std::abs(in.tilt_rad - tilt_rad) <= cfg.reuse_threshold_tilt_rad;
+  }
+};
+
+}  // namespace tlf
@@ -32,6 +32,31 @@ enum class SafetyCode : int {
   NoFeasibleSolution = 5,
 };
 
+// Static, allocation-free description of a safety code (also used as SafetyStatus::message).
+inline const char* toString(SafetyCode code) {
+  switch (code) {
+    case SafetyCode::None:
+      return "OK";
+    case SafetyCode::ClearanceHardViolated:
+      return "STOP: hard clearance violated";
+    case SafetyCode::ClearanceSoftNear:
+      return "WARN: clearance near boundary";
+    case SafetyCode::InputInvalid:
+      return "Invalid inputs";
+    case SafetyCode::PitchJitter:
+      return "Pitch rate jitter";
+    case SafetyCode::NoFeasibleSolution:
+      return "No feasible solution in search neighborhood";
+    default:
+      return "Unknown";
+  }
+}
+
+enum class SearchMode : int {
+  Dense = 0,         // grid_lift_steps x grid_tilt_steps over the whole neighborhood
+  CoarseToFine = 1,  // coarse_grid_steps^2, then refine_levels windows around the best cells
+};
+
 struct ControlInput {
   double dt_s{0.02};
 
@@ -67,13 +92,35 @@ struct ControlCommand {
 struct SafetyStatus {
   SafetyLevel level{SafetyLevel::OK};
   SafetyCode code{SafetyCode::None};
-  std::string message;
+  const char* message{"OK"};  // toString(code); static storage, never owned
 
   double clearance_top_m{0.0};
   double clearance_bottom_m{0.0};
   CornerId worst_point{CornerId::RearBottom};
 };
 
+// Slim per-step result: command + safety, no input copy, no strings, no geometry.
+// Filled by IController::step(in, out) into caller-owned storage.
+struct ControlOutput {
+  double time_s{0.0};
+
+  ControlCommand cmd;
+  SafetyStatus safety;
+
+  double selected_cost{0.0};
+  bool had_feasible_solution{false};
+
+  // (lift, tilt) candidates (grid) or predicted states (MPC) whose clearance was evaluated this step.
+  int candidates_evaluated{0};
+
+  // MPC only: the beam was seeded from the previous step's plan.
+  bool warm_start_used{false};
+
+  // step_time_budget_us ran out: the command is the best one found before the deadline.
+  bool budget_exhausted{false};
+};
+
+// Full diagnostics for logging/visualization (opt-in: copies the input every step).
 struct DebugFrame {
   double time_s{0.0};
 
@@ -83,9 +130,34 @@ struct DebugFrame {
 
   CornerPoints2D corners;
 
+  // Environment surfaces at x = s_m (the ceiling_z/floor_z log columns), looked up once per frame.
+  double ceiling_z_m{0.0};
+  double floor_z_m{0.0};
+
   // Candidate selection
   double selected_cost{0.0};
   bool had_feasible_solution{false};
+  int candidates_evaluated{0};
+  bool warm_start_used{false};
+  bool budget_exhausted{false};  // see ControlOutput::budget_exhausted
+
+  // MPC beam statistics: feasible children generated over the horizon, and how many of them were
+  // dropped as duplicates of a cheaper node at the same lattice state (mpc_dedup_states).
+  int mpc_nodes_expanded{0};
+  int mpc_nodes_deduplicated{0};
+
+  // Clearance cache lookups this step (clearance_cache_capacity > 0).
+  int clearance_cache_hits{0};
+  int clearance_cache_misses{0};
+
+  // Grid controller: the search window was clamped to a FeasibilityEnvelope band this step.
+  bool envelope_used{false};
+
+  // Grid controller, float32_candidates: candidates re-evaluated in double after the float32 pass.
+  int float32_rechecks{0};
+
+  // reuse_unchanged_input: the previous command was reused instead of searching.
+  bool search_reused{false};
 };
 
 struct ControllerConfig {
@@ -101,10 +173,68 @@ struct ControllerConfig {
   int grid_lift_steps{9};
   int grid_tilt_steps{9};
 
+  // Grid controller search strategy. CoarseToFine evaluates a coarse_grid_steps^2 grid, then for each of
+  // refine_levels levels a +/- one-cell window (same density) around the best feasible cell and around
+  // the max-min-clearance cell. Each level scales the spacing by 2 / (coarse_grid_steps - 1) (halves it
+  // at 5), so coarse_grid_steps must be at least 4: at 3 the window would never narrow.
+  SearchMode search_mode{SearchMode::Dense};
+  int coarse_grid_steps{5};
+  int refine_levels{4};
+
+  // Optional continuous refinement after either search mode: local_refine_iterations rounds of four
+  // golden-section line searches (along lift, along tilt and along both lift/tilt diagonals), bracketed
+  // by +/- one final grid cell around the best feasible candidate, or around the max-min-clearance cell
+  // while none is feasible (the bracket halves each round). Each line search costs local_refine_evals
+  // clearance evaluations (at least 2, the first golden-section pair). Only feasible, cheaper points are
+  // accepted, so the result is never worse than the grid's. 0 iterations disables.
+  int local_refine_iterations{0};
+  int local_refine_evals{8};
+
+  // Score grid candidates with the float32 batch kernel (twice the SIMD lanes of double). Every candidate
+  // whose float32 clearances or cost are within the kernel's error bound of deciding the selection is
+  // re-evaluated in double, so the selected pose, its clearances and the safety status are the same as
+  // with the double kernel; only the work differs. Applies to scalar and plane surfaces only: callback
+  // and profile surfaces may step, which the float error bound does not cover, so they use the double kernel.
+  bool float32_candidates{false};
+
   // Simple lookahead: evaluate clearance also at s + lookahead_s_m, and constrain/optimize
   // against the worst-case over {now, ahead}. This helps avoid stalling at the doorway.
   double lookahead_s_m{0.0};
 
+  // Clearance memoization for per-pose evaluations (current pose, its lookahead, MPC horizon states).
+  // Capacity 0 disables it. Zero quanta key on the exact pose, so results are unchanged; positive
+  // quanta (m for s/lift, rad for pitch+tilt) merge nearby poses; the current pose and its lookahead
+  // are then evaluated directly, so only candidates are approximated. With clearance_cache_across_steps,
+  // entries survive to the next step when env/rack/forklift are unchanged (never for callback envs).
+  // The grid batch kernel is not cached; the MPC cache is bypassed when mpc_num_threads > 1.
+  int clearance_cache_capacity{0};
+  double clearance_cache_quantum_m{0.0};
+  double clearance_cache_quantum_rad{0.0};
+  bool clearance_cache_across_steps{false};
+
+  // Event-triggered evaluation: while s, pitch, lift and tilt stay within these deltas of the last fully
+  // solved input and env/rack/forklift are unchanged (never for callback envs), the previous command
+  // is reused after re-checking its target instead of searching again. The current-pose clearance,
+  // speed limit and safety status are still computed every step; the search runs again as soon as a
+  // delta is exceeded, the input is invalid or degraded, the current pose is at STOP or its safety
+  // level differs from the solved step's.
+  bool reuse_unchanged_input{false};
+  double reuse_threshold_s_m{1e-4};
+  double reuse_threshold_pitch_rad{1e-4};
+  double reuse_threshold_lift_m{1e-4};
+  double reuse_threshold_tilt_rad{1e-4};
+
+  // Anytime search: step time budget in microseconds from the start of step(); 0 disables. The
+  // current-pose clearance, speed limit and safety status always complete. Once the budget is spent
+  // the grid controller skips the remaining CoarseToFine windows and local refinement line searches
+  // (its first grid pass always completes). ControllerMPC expands each level's nodes cheapest first,
+  // stops after the node being expanded (per level with mpc_num_threads > 1 or mpc_dedup_states),
+  // keeps the partial level if it produced children, and evaluates the fallback grid row by row from
+  // the current tilt outwards until the deadline (holding the current pose if no row fit). The overrun
+  // is then about one node expansion plus pruning the partial level. Steps that finish within the
+  // budget select exactly what an unlimited search selects.
+  int step_time_budget_us{0};
+
   // Cost weights
   double w_center{8.0};
   double w_dl{2.0};
@@ -133,6 +263,21 @@ struct ControllerConfig {
   int mpc_horizon_steps{5};
   int mpc_beam_width{40};
 
+  // Receding-horizon warm start: seed the beam with the previous step's best plan shifted by one step
+  // (plus its first-action neighbors) and keep those seeds through pruning, so a narrower beam holds
+  // plan quality. Covers the first 12 horizon steps.
+  bool mpc_warm_start{false};
+
+  // Parallel beam expansion: total threads (including the caller) used to expand each horizon level.
+  // 1 keeps expansion serial. Results are identical to the serial path for any thread count.
+  // Any EnvironmentGeometry callbacks must then be safe to call concurrently.
+  int mpc_num_threads{1};
+
+  // Duplicate-state pruning: predicted (lift, tilt) are snapped to the action lattice
+  // (0.5 * rate_limit * dt) and only the cheapest node per lattice point is kept at each horizon
+  // level. Each lattice point's clearance is evaluated once. Warm-start seeds are exempt.
+  bool mpc_dedup_states{false};
+
   // Assumed forward speed used for predicting s over the horizon.
   // If set to 0, MPC will assume s is constant (no forward motion prediction).
   double mpc_assumed_forward_speed_m_s{0.0};
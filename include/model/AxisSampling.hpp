@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace tlf {
+
+// n evenly spaced samples from lo to hi (inclusive).
+inline void fillAxis(std::vector<double>& axis, int n, double lo, double hi) {
+  axis.resize(static_cast<std::size_t>(n));
+  for (int i = 0; i < n; ++i) {
+    const double t = (n == 1) ? 0.0 : static_cast<double>(i) / static_cast<double>(n - 1);
+    axis[static_cast<std::size_t>(i)] = lo + (hi - lo) * t;
+  }
+}
+
+// Same samples from precomputed fractions (ConfigTables); axis gets t.size() entries.
+inline void fillAxis(std::vector<double>& axis, const std::vector<double>& t, double lo, double hi) {
+  axis.resize(t.size());
+  for (std::size_t i = 0; i < t.size(); ++i) axis[i] = lo + (hi - lo) * t[i];
+}
+
+}  // namespace tlf
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "model/Geometry.hpp"
+
+namespace tlf {
+
+// Fixed-capacity, open-addressing memo of rack clearances keyed on the quantized pose
+// (s_m, lift_m, pitch_rad + tilt_rad); the corners depend on pitch and tilt only through their sum.
+// Entries hold margin-free clearances, so margins may change between lookups (e.g. DEGRADED).
+//
+// With zero quanta the key is the exact pose and results are bit-identical to
+// computeRackCorners2D + computeClearances. Not thread-safe: use one cache per thread.
+class ClearanceCache {
+ public:
+  // capacity is rounded up to a power of two; 0 disables caching (evaluate() always computes).
+  // No-op when the settings are unchanged, so it may be called every step; otherwise it allocates
+  // and drops all entries.
+  void configure(std::size_t capacity, double quantum_m, double quantum_rad);
+
+  bool enabled() const { return !slots_.empty(); }
+  std::size_t capacity() const { return slots_.size(); }
+  // Whether lookups are keyed on the exact pose (both quanta zero), i.e. bit-identical to direct evaluation.
+  bool exact() const { return inv_quantum_m_ == 0.0 && inv_quantum_rad_ == 0.0; }
+
+  // Starts a control step. Entries survive only if keep_entries is set and the environment, rack and
+  // forklift match the previous step (callback environments are opaque and always invalidate).
+  void beginStep(const EnvironmentGeometry& env, const RackParams& rack, const ForkliftParams& forklift, bool keep_entries);
+
+  // Whether the last beginStep() saw the same environment, rack and forklift as the step before it
+  // (regardless of keep_entries; never for callback environments).
+  bool geometryUnchanged() const { return geometry_unchanged_; }
+
+  // Invalidates every entry in O(1).
+  void clear();
+
+  // Same result as computeClearances(computeRackCorners2D(...), env, margin_top_m, margin_bottom_m),
+  // served from the cache when an entry with the same quantized pose exists.
+  ClearanceResult evaluate(double s_m,
+                           double lift_m,
+                           double pitch_rad,
+                           double tilt_rad,
+                           const EnvironmentGeometry& env,
+                           const RackParams& rack,
+                           const ForkliftParams& forklift,
+                           double margin_top_m,
+                           double margin_bottom_m);
+
+  // Cumulative lookup statistics since the last resetCounters().
+  std::uint64_t hits() const { return hits_; }
+  std::uint64_t misses() const { return misses_; }
+  void resetCounters() {
+    hits_ = 0;
+    misses_ = 0;
+  }
+
+ private:
+  struct Key {
+    std::int64_t s;
+    std::int64_t lift;
+    std::int64_t theta;
+    bool operator==(const Key& o) const { return s == o.s && lift == o.lift && theta == o.theta; }
+  };
+
+  struct Slot {
+    std::uint32_t epoch{0};  // valid iff == epoch_
+    Key key{};
+    double top_m{0.0};
+    double bottom_m{0.0};
+    CornerId top_worst{CornerId::RearTop};
+    CornerId bottom_worst{CornerId::RearBottom};
+  };
+
+  // Environment identity used to decide whether entries may survive a step. The profile is held (not
+  // just its address) so a profile freed and rebuilt at the same address is never taken as unchanged.
+  struct Signature {
+    std::shared_ptr<const TerrainProfile> profile;
+    bool has_callbacks{false};
+    std::optional<double> ceiling_z_m;
+    std::optional<double> floor_z_m;
+    std::optional<Plane> ceiling_plane;
+    std::optional<Plane> floor_plane;
+    RackParams rack;
+    ForkliftParams forklift;
+  };
+
+  Key makeKey(double s_m, double lift_m, double theta) const;
+
+  std::size_t requested_capacity_{0};
+  double quantum_m_{0.0};
+  double quantum_rad_{0.0};
+
+  std::vector<Slot> slots_;
+  std::size_t mask_{0};
+  double inv_quantum_m_{0.0};
+  double inv_quantum_rad_{0.0};
+  std::uint32_t epoch_{1};
+
+  Signature last_;
+  bool has_last_{false};
+  bool geometry_unchanged_{false};
+
+  std::uint64_t hits_{0};
+  std::uint64_t misses_{0};
+};
+
+}  // namespace tlf
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model/Geometry.hpp"
+#include "utils/MappedFile.hpp"
+
+namespace tlf {
+
+// Table extent and sampling. Bins are [s_min + i * ds, s_min + (i + 1) * ds) (same for pitch).
+struct EnvelopeSpec {
+  double s_min_m{-4.0};
+  double s_max_m{8.0};
+  int s_bins{240};
+  double pitch_min_rad{-0.10};
+  double pitch_max_rad{0.10};
+  int pitch_bins{40};
+
+  // Absolute (lift, tilt) box sampled in every bin.
+  double lift_min_m{-0.30};
+  double lift_max_m{0.60};
+  int lift_samples{61};
+  double tilt_min_rad{-0.30};
+  double tilt_max_rad{0.30};
+  int tilt_samples{61};
+
+  // Feasibility margins (ControllerConfig::margin_*). Online use requires margins >= these.
+  double margin_top_m{0.04};
+  double margin_bottom_m{0.04};
+};
+
+// One (s, pitch) bin. Bands are the bounding box of every sampled pose that is feasible at any corner
+// (s, pitch) of the bin, padded by one sample, so they contain the feasible set anywhere inside the bin
+// up to the sampling resolution. NaN bands mean nothing in the sampled box was feasible.
+struct EnvelopeCell {
+  float lift_lo_m;
+  float lift_hi_m;
+  float tilt_lo_rad;
+  float tilt_hi_rad;
+  // Sampled pose with the largest min(top, bottom) clearance at the bin centre, and that clearance.
+  float best_lift_m;
+  float best_tilt_rad;
+  float best_min_clearance_m;
+  float feasible_fraction;  // share of sampled poses feasible at the bin centre
+
+  bool anyFeasible() const { return lift_lo_m == lift_lo_m; }  // false for NaN bands
+};
+static_assert(sizeof(EnvelopeCell) == 32, "EnvelopeCell is the on-disk record layout");
+
+// Precomputed feasible (lift, tilt) bands over (s, pitch) for one container/ramp geometry, rack and
+// forklift. Built once per container type (offline or at startup), saved to a flat little-endian file
+// and memory-mapped back, so a lookup is two index computations and a pointer offset.
+//
+// The grid controller uses it to narrow its search window (Controller::setFeasibilityEnvelope). Callers
+// must pair an envelope with the geometry it was built for; rack/forklift parameters and margins are
+// checked by accepts().
+class FeasibilityEnvelope {
+ public:
+  static constexpr std::uint16_t kVersion = 1;
+
+  // Samples every bin; `threads` is the total parallelism including the caller.
+  static FeasibilityEnvelope build(const EnvironmentGeometry& env,
+                                   const RackParams& rack,
+                                   const ForkliftParams& forklift,
+                                   const EnvelopeSpec& spec,
+                                   int threads = 1);
+
+  // Maps a file written by save(); nullptr (and *error) if it is missing, truncated or of another version.
+  static std::shared_ptr<const FeasibilityEnvelope> load(const std::string& path, std::string* error = nullptr);
+  bool save(const std::string& path) const;
+
+  const EnvelopeSpec& spec() const { return spec_; }
+  const RackParams& rack() const { return rack_; }
+  const ForkliftParams& forklift() const { return forklift_; }
+
+  std::size_t cellCount() const { return static_cast<std::size_t>(spec_.s_bins) * static_cast<std::size_t>(spec_.pitch_bins); }
+  const EnvelopeCell& cell(int i_s, int i_pitch) const { return cells_[static_cast<std::size_t>(i_s) * spec_.pitch_bins + i_pitch]; }
+
+  // Bin holding (s, pitch); nullptr outside the table's coverage.
+  const EnvelopeCell* lookup(double s_m, double pitch_rad) const {
+    const double fs = (s_m - spec_.s_min_m) * inv_ds_;
+    const double fp = (pitch_rad - spec_.pitch_min_rad) * inv_dp_;
+    if (!(fs >= 0.0 && fs < spec_.s_bins && fp >= 0.0 && fp < spec_.pitch_bins)) return nullptr;
+    return &cell(static_cast<int>(fs), static_cast<int>(fp));
+  }
+
+  // True if the table was built for this rack/forklift and for margins no larger than the given ones
+  // (larger margins only shrink the feasible set, so the bands stay valid).
+  bool accepts(const RackParams& rack, const ForkliftParams& forklift, double margin_top_m, double margin_bottom_m) const;
+
+ private:
+  void finishSetup();
+
+  EnvelopeSpec spec_;
+  RackParams rack_;
+  ForkliftParams forklift_;
+  double inv_ds_{0.0};
+  double inv_dp_{0.0};
+
+  std::vector<EnvelopeCell> owned_;  // built tables
+  MappedFile file_;                  // loaded tables (cells_ points into the mapping)
+  const EnvelopeCell* cells_{nullptr};
+};
+
+}  // namespace tlf
@@ -2,11 +2,15 @@
 
 #include <array>
 #include <cmath>
+#include <cstddef>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "model/Math2D.hpp"
+#include "model/TerrainProfile.hpp"
 
 namespace tlf {
 
@@ -74,8 +78,16 @@ struct EnvironmentGeometry {
   // If provided, they take precedence over ceiling_z_m/floor_z_m.
   std::function<double(double)> ceiling_z_at_x_m;
   std::function<double(double)> floor_z_at_x_m;
+
+  // Optional compiled profile (takes precedence over everything above when valid).
+  // Build it once per container/ramp; lookups are inline and avoid the callback indirection.
+  std::shared_ptr<const TerrainProfile> profile;
 };
 
+// Surface height lookups with the precedence documented on EnvironmentGeometry.
+double envCeilingZAtX(const EnvironmentGeometry& env, double x);
+double envFloorZAtX(const EnvironmentGeometry& env, double x);
+
 // Kinematics contract (2D side view):
 // - s_m: mast base x in world.
 // - pitch_rad: chassis pitch.
@@ -92,11 +104,87 @@ CornerPoints2D computeRackCorners2D(double s_m,
                                    const RackParams& rack,
                                    const ForkliftParams& forklift);
 
+// Same as above with a compiled profile (must be valid()).
+CornerPoints2D computeRackCorners2D(double s_m,
+                                   double lift_m,
+                                   double pitch_rad,
+                                   double tilt_rad,
+                                   const TerrainProfile& profile,
+                                   const RackParams& rack,
+                                   const ForkliftParams& forklift);
+
 ClearanceResult computeClearances(const CornerPoints2D& corners,
                                  const EnvironmentGeometry& env,
                                  double margin_top_m,
                                  double margin_bottom_m);
 
+ClearanceResult computeClearances(const CornerPoints2D& corners,
+                                 const TerrainProfile& profile,
+                                 double margin_top_m,
+                                 double margin_bottom_m);
+
+// Structure-of-arrays clearances for a lift x tilt candidate grid.
+// Element (i_lift, j_tilt) lives at j_tilt * n_lift + i_lift so every tilt column is contiguous.
+struct ClearanceBatch {
+  std::size_t n_lift{0};
+  std::size_t n_tilt{0};
+
+  std::vector<double> clearance_top_m;
+  std::vector<double> clearance_bottom_m;
+  std::vector<CornerId> top_worst_point;
+  std::vector<CornerId> bottom_worst_point;
+
+  // Sizes outputs and per-column scratch; does not reallocate once capacity suffices.
+  void resize(std::size_t lifts, std::size_t tilts);
+
+  std::size_t index(std::size_t i_lift, std::size_t j_tilt) const { return j_tilt * n_lift + i_lift; }
+
+  // Same fields as computeClearances() would return for that candidate.
+  ClearanceResult at(std::size_t i_lift, std::size_t j_tilt) const {
+    const std::size_t k = index(i_lift, j_tilt);
+    ClearanceResult r;
+    r.clearance_top_m = clearance_top_m[k];
+    r.clearance_bottom_m = clearance_bottom_m[k];
+    r.top_worst_point = top_worst_point[k];
+    r.bottom_worst_point = bottom_worst_point[k];
+    r.worst_point = (r.clearance_top_m < r.clearance_bottom_m) ? r.top_worst_point : r.bottom_worst_point;
+    return r;
+  }
+
+  // Per-column scratch: 4 corners x (x, z), then ceiling at the top corners and floor at the bottom ones.
+  enum Scratch : int { RbX, RbZ, RtX, RtZ, FbX, FbZ, FtX, FtZ, CeilRt, CeilFt, FloorRb, FloorFb, kScratchCount };
+  std::array<std::vector<double>, kScratchCount> scratch;
+};
+
+// Evaluates computeRackCorners2D + computeClearances for every (lifts[i], tilts[j]) at one s_m/pitch.
+// Results are bit-identical to the per-candidate functions; the rotation is computed once per tilt
+// and the per-lift loops are branch-free so the compiler can vectorize them.
+void computeClearancesBatch(double s_m,
+                            const double* lifts,
+                            std::size_t n_lift,
+                            const double* tilts,
+                            std::size_t n_tilt,
+                            double pitch_rad,
+                            const EnvironmentGeometry& env,
+                            const RackParams& rack,
+                            const ForkliftParams& forklift,
+                            double margin_top_m,
+                            double margin_bottom_m,
+                            ClearanceBatch* out);
+
+void computeClearancesBatch(double s_m,
+                            const double* lifts,
+                            std::size_t n_lift,
+                            const double* tilts,
+                            std::size_t n_tilt,
+                            double pitch_rad,
+                            const TerrainProfile& profile,
+                            const RackParams& rack,
+                            const ForkliftParams& forklift,
+                            double margin_top_m,
+                            double margin_bottom_m,
+                            ClearanceBatch* out);
+
 std::string toString(CornerId id);
 
 }  // namespace tlf
@@ -0,0 +1,352 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "model/Geometry.hpp"
+
+namespace tlf {
+
+// Compile-time surface representations. visitEnvironment() resolves EnvironmentGeometry's precedence
+// (profile, then callbacks, then planes, then scalars) once and hands the kernels below concrete
+// functors, so per-corner lookups carry no representation branches and inline into the loops.
+struct ConstantSurface {
+  double z;
+  double operator()(double) const { return z; }
+};
+
+struct PlaneSurface {
+  Plane plane;
+  double operator()(double x) const { return plane.zAtX(x); }
+};
+
+struct CallbackSurface {
+  const std::function<double(double)>* fn;
+  double operator()(double x) const { return (*fn)(x); }
+};
+
+struct ProfileCeiling {
+  const TerrainProfile* profile;
+  double operator()(double x) const { return profile->ceilingZAtX(x); }
+};
+
+struct ProfileFloor {
+  const TerrainProfile* profile;
+  double operator()(double x) const { return profile->floorZAtX(x); }
+};
+
+namespace detail {
+
+template <typename Fn>
+decltype(auto) visitFloor(const EnvironmentGeometry& env, Fn&& fn) {
+  if (env.floor_z_at_x_m) return fn(CallbackSurface{&env.floor_z_at_x_m});
+  if (env.floor_plane && env.floor_plane->valid()) return fn(PlaneSurface{*env.floor_plane});
+  return fn(ConstantSurface{env.floor_z_m.value_or(0.0)});
+}
+
+}  // namespace detail
+
+// Calls fn(ceiling, floor) with the surface functors matching env (same values as envCeilingZAtX /
+// envFloorZAtX). fn is instantiated for every combination, so it must return the same type for all.
+template <typename Fn>
+decltype(auto) visitEnvironment(const EnvironmentGeometry& env, Fn&& fn) {
+  if (env.profile && env.profile->valid()) {
+    return fn(ProfileCeiling{env.profile.get()}, ProfileFloor{env.profile.get()});
+  }
+  auto withCeiling = [&](const auto& ceiling) {
+    return detail::visitFloor(env, [&](const auto& floor) { return fn(ceiling, floor); });
+  };
+  if (env.ceiling_z_at_x_m) return withCeiling(CallbackSurface{&env.ceiling_z_at_x_m});
+  if (env.ceiling_plane && env.ceiling_plane->valid()) return withCeiling(PlaneSurface{*env.ceiling_plane});
+  return withCeiling(ConstantSurface{env.ceiling_z_m.value_or(10.0)});
+}
+
+// Rack corners for a mast base standing on base_floor_z (see computeRackCorners2D).
+inline CornerPoints2D rackCornersAtBase(double s_m,
+                                        double base_floor_z,
+                                        double lift_m,
+                                        double pitch_rad,
+                                        double tilt_rad,
+                                        const RackParams& rack,
+                                        const ForkliftParams& forklift) {
+  const double theta = pitch_rad + tilt_rad;
+  const Rot2 R = Rot2::fromRad(theta);
+
+  // Mast base at local floor + fixed pivot height.
+  const double base_z = base_floor_z + forklift.mast_pivot_height_m;
+  const Vec2 mast_base{s_m, base_z};
+
+  // Carriage (fork pivot) moves along mast (+z in rack frame).
+  const Vec2 pivot_world = mast_base + R.apply(Vec2{0.0, lift_m});
+
+  // Rear-bottom corner position
+  const Vec2 rb = pivot_world + R.apply(rack.mount_offset_m);
+
+  const Vec2 rt = rb + R.apply(Vec2{0.0, rack.height_m});
+  const Vec2 fb = rb + R.apply(Vec2{rack.length_m, 0.0});
+  const Vec2 ft = rb + R.apply(Vec2{rack.length_m, rack.height_m});
+
+  return CornerPoints2D{{rb, rt, fb, ft}};
+}
+
+template <typename Ceiling, typename Floor>
+ClearanceResult clearancesWith(const CornerPoints2D& corners,
+                               const Ceiling& ceilingAt,
+                               const Floor& floorAt,
+                               double margin_top_m,
+                               double margin_bottom_m) {
+  struct Candidate {
+    CornerId id;
+    double value;
+  };
+
+  // Top clearance: min over top corners of (ceiling - z)
+  Candidate topWorst{CornerId::RearTop, std::numeric_limits<double>::infinity()};
+  for (CornerId id : {CornerId::RearTop, CornerId::FrontTop}) {
+    const auto& p = corners.p[static_cast<int>(id)];
+    const double c = ceilingAt(p.x) - p.z;
+    if (c < topWorst.value) topWorst = {id, c};
+  }
+
+  // Bottom clearance: min over bottom corners of (z - floor)
+  Candidate botWorst{CornerId::RearBottom, std::numeric_limits<double>::infinity()};
+  for (CornerId id : {CornerId::RearBottom, CornerId::FrontBottom}) {
+    const auto& p = corners.p[static_cast<int>(id)];
+    const double c = p.z - floorAt(p.x);
+    if (c < botWorst.value) botWorst = {id, c};
+  }
+
+  const double clearance_top_m = topWorst.value - margin_top_m;
+  const double clearance_bottom_m = botWorst.value - margin_bottom_m;
+
+  const CornerId worst = (clearance_top_m < clearance_bottom_m) ? topWorst.id : botWorst.id;
+
+  ClearanceResult out;
+  out.clearance_top_m = clearance_top_m;
+  out.clearance_bottom_m = clearance_bottom_m;
+  out.top_worst_point = topWorst.id;
+  out.bottom_worst_point = botWorst.id;
+  out.worst_point = worst;
+  return out;
+}
+
+// computeClearancesBatch for concrete surfaces. Mirrors rackCornersAtBase + clearancesWith operation for
+// operation so results stay bit-identical.
+template <typename Ceiling, typename Floor>
+void clearancesBatchWith(double s_m,
+                         const double* lifts,
+                         std::size_t n_lift,
+                         const double* tilts,
+                         std::size_t n_tilt,
+                         double pitch_rad,
+                         const Ceiling& ceilingAt,
+                         const Floor& floorAt,
+                         const RackParams& rack,
+                         const ForkliftParams& forklift,
+                         double margin_top_m,
+                         double margin_bottom_m,
+                         ClearanceBatch* out) {
+  out->resize(n_lift, n_tilt);
+
+  using S = ClearanceBatch;
+  auto& w = out->scratch;
+  double* rbx = w[S::RbX].data();
+  double* rbz = w[S::RbZ].data();
+  double* rtx = w[S::RtX].data();
+  double* rtz = w[S::RtZ].data();
+  double* fbx = w[S::FbX].data();
+  double* fbz = w[S::FbZ].data();
+  double* ftx = w[S::FtX].data();
+  double* ftz = w[S::FtZ].data();
+  double* ceil_rt = w[S::CeilRt].data();
+  double* ceil_ft = w[S::CeilFt].data();
+  double* floor_rb = w[S::FloorRb].data();
+  double* floor_fb = w[S::FloorFb].data();
+
+  const double base_z = floorAt(s_m) + forklift.mast_pivot_height_m;
+  const double inf = std::numeric_limits<double>::infinity();
+
+  for (std::size_t j = 0; j < n_tilt; ++j) {
+    const Rot2 R = Rot2::fromRad(pitch_rad + tilts[j]);
+    const Vec2 mount = R.apply(rack.mount_offset_m);
+    const Vec2 up = R.apply(Vec2{0.0, rack.height_m});
+    const Vec2 fwd = R.apply(Vec2{rack.length_m, 0.0});
+    const Vec2 diag = R.apply(Vec2{rack.length_m, rack.height_m});
+
+    for (std::size_t i = 0; i < n_lift; ++i) {
+      const double lift = lifts[i];
+      const double px = s_m + (R.c * 0.0 - R.s * lift);
+      const double pz = base_z + (R.s * 0.0 + R.c * lift);
+      rbx[i] = px + mount.x;
+      rbz[i] = pz + mount.z;
+      rtx[i] = rbx[i] + up.x;
+      rtz[i] = rbz[i] + up.z;
+      fbx[i] = rbx[i] + fwd.x;
+      fbz[i] = rbz[i] + fwd.z;
+      ftx[i] = rbx[i] + diag.x;
+      ftz[i] = rbz[i] + diag.z;
+    }
+
+    for (std::size_t i = 0; i < n_lift; ++i) ceil_rt[i] = ceilingAt(rtx[i]);
+    for (std::size_t i = 0; i < n_lift; ++i) ceil_ft[i] = ceilingAt(ftx[i]);
+    for (std::size_t i = 0; i < n_lift; ++i) floor_rb[i] = floorAt(rbx[i]);
+    for (std::size_t i = 0; i < n_lift; ++i) floor_fb[i] = floorAt(fbx[i]);
+
+    const std::size_t k0 = j * n_lift;
+    double* top = out->clearance_top_m.data() + k0;
+    double* bot = out->clearance_bottom_m.data() + k0;
+    CornerId* top_id = out->top_worst_point.data() + k0;
+    CornerId* bot_id = out->bottom_worst_point.data() + k0;
+
+    for (std::size_t i = 0; i < n_lift; ++i) {
+      const double c_rt = ceil_rt[i] - rtz[i];
+      const double c_ft = ceil_ft[i] - ftz[i];
+      double t = (c_rt < inf) ? c_rt : inf;
+      const bool front_top = c_ft < t;
+      t = front_top ? c_ft : t;
+
+      const double c_rb = rbz[i] - floor_rb[i];
+      const double c_fb = fbz[i] - floor_fb[i];
+      double b = (c_rb < inf) ? c_rb : inf;
+      const bool front_bottom = c_fb < b;
+      b = front_bottom ? c_fb : b;
+
+      top[i] = t - margin_top_m;
+      bot[i] = b - margin_bottom_m;
+      top_id[i] = front_top ? CornerId::FrontTop : CornerId::RearTop;
+      bot_id[i] = front_bottom ? CornerId::FrontBottom : CornerId::RearBottom;
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------------------------------
+// Float32 candidate scoring. Corners are computed relative to the mast base (x - s_m, z - base_z), so
+// every float operand stays within a few meters of zero regardless of where the truck is; the absolute
+// error of the resulting clearances is then a few 1e-6 m (kFloatClearanceTolM is the bound callers
+// may rely on, for continuous surfaces: a callback or profile step within ~1e-6 m of a corner may be
+// read on the other side, off by the whole step). Results are for ranking only: anything that decides
+// a command must be rechecked in double (see Controller, ControllerConfig::float32_candidates).
+
+constexpr float kFloatClearanceTolM = 1e-4f;
+
+// Surfaces for which kFloatClearanceTolM holds unconditionally. Callbacks and profiles may step (a
+// profile with a repeated x), so bounds derived from the float pass are not sound for them.
+template <typename Surface>
+constexpr bool kFloatBoundedSurface = std::is_same_v<Surface, ConstantSurface> || std::is_same_v<Surface, PlaneSurface>;
+
+// Float counterpart of ClearanceBatch (same element layout, no worst-corner ids).
+struct ClearanceBatchF {
+  std::size_t n_lift{0};
+  std::size_t n_tilt{0};
+
+  std::vector<float> clearance_top_m;
+  std::vector<float> clearance_bottom_m;
+
+  void resize(std::size_t lifts, std::size_t tilts) {
+    n_lift = lifts;
+    n_tilt = tilts;
+    clearance_top_m.resize(lifts * tilts);
+    clearance_bottom_m.resize(lifts * tilts);
+    lift_scratch.resize(lifts);
+  }
+
+  std::size_t index(std::size_t i_lift, std::size_t j_tilt) const { return j_tilt * n_lift + i_lift; }
+
+  std::vector<float> lift_scratch;
+};
+
+// Surface heights in the mast-base frame: z(s_m + x_rel) - base_z as a function of x_rel.
+struct RelativeConstantF {
+  float z;
+  float operator()(float) const { return z; }
+};
+
+struct RelativeLinearF {
+  float z0;
+  float slope;
+  float operator()(float x_rel) const { return z0 + slope * x_rel; }
+};
+
+template <typename Surface>
+struct RelativeSampledF {
+  Surface surface;
+  double s_m;
+  double base_z;
+  float operator()(float x_rel) const { return static_cast<float>(surface(s_m + x_rel) - base_z); }
+};
+
+inline RelativeConstantF relativeSurfaceF(const ConstantSurface& c, double, double base_z) {
+  return {static_cast<float>(c.z - base_z)};
+}
+
+inline RelativeLinearF relativeSurfaceF(const PlaneSurface& p, double s_m, double base_z) {
+  return {static_cast<float>(p(s_m) - base_z), static_cast<float>(-p.plane.a / p.plane.c)};
+}
+
+// Callbacks and profiles are sampled in double at the absolute x.
+template <typename Surface>
+RelativeSampledF<Surface> relativeSurfaceF(const Surface& surface, double s_m, double base_z) {
+  return {surface, s_m, base_z};
+}
+
+// clearancesBatchWith in float32 (within kFloatClearanceTolM of it).
+template <typename Ceiling, typename Floor>
+void clearancesBatchWithF(double s_m,
+                          const double* lifts,
+                          std::size_t n_lift,
+                          const double* tilts,
+                          std::size_t n_tilt,
+                          double pitch_rad,
+                          const Ceiling& ceiling,
+                          const Floor& floor,
+                          const RackParams& rack,
+                          const ForkliftParams& forklift,
+                          double margin_top_m,
+                          double margin_bottom_m,
+                          ClearanceBatchF* out) {
+  out->resize(n_lift, n_tilt);
+
+  float* lift = out->lift_scratch.data();
+  for (std::size_t i = 0; i < n_lift; ++i) lift[i] = static_cast<float>(lifts[i]);
+
+  const double base_z = floor(s_m) + forklift.mast_pivot_height_m;
+  const auto ceilingAt = relativeSurfaceF(ceiling, s_m, base_z);
+  const auto floorAt = relativeSurfaceF(floor, s_m, base_z);
+  const float margin_top = static_cast<float>(margin_top_m);
+  const float margin_bottom = static_cast<float>(margin_bottom_m);
+
+  for (std::size_t j = 0; j < n_tilt; ++j) {
+    // Rotation and rack offsets in double, then rounded once.
+    const Rot2 R = Rot2::fromRad(pitch_rad + tilts[j]);
+    const Vec2 mount = R.apply(rack.mount_offset_m);
+    const Vec2 up = R.apply(Vec2{0.0, rack.height_m});
+    const Vec2 fwd = R.apply(Vec2{rack.length_m, 0.0});
+    const Vec2 diag = R.apply(Vec2{rack.length_m, rack.height_m});
+    const float c = static_cast<float>(R.c), sn = static_cast<float>(R.s);
+    const float mx = static_cast<float>(mount.x), mz = static_cast<float>(mount.z);
+    const float ux = static_cast<float>(up.x), uz = static_cast<float>(up.z);
+    const float fx = static_cast<float>(fwd.x), fz = static_cast<float>(fwd.z);
+    const float dx = static_cast<float>(diag.x), dz = static_cast<float>(diag.z);
+
+    // One fused pass with three streams (lift in, top/bottom out) so the loop vectorizes for constant
+    // and plane surfaces; callback/profile lookups stay scalar.
+    float* top = out->clearance_top_m.data() + j * n_lift;
+    float* bot = out->clearance_bottom_m.data() + j * n_lift;
+    for (std::size_t i = 0; i < n_lift; ++i) {
+      const float rbx = mx - sn * lift[i];
+      const float rbz = mz + c * lift[i];
+      const float c_rt = ceilingAt(rbx + ux) - (rbz + uz);
+      const float c_ft = ceilingAt(rbx + dx) - (rbz + dz);
+      const float c_rb = rbz - floorAt(rbx);
+      const float c_fb = (rbz + fz) - floorAt(rbx + fx);
+      top[i] = (c_ft < c_rt ? c_ft : c_rt) - margin_top;
+      bot[i] = (c_fb < c_rb ? c_fb : c_rb) - margin_bottom;
+    }
+  }
+}
+
+}  // namespace tlf
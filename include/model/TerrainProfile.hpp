@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace tlf {
+
+// Piecewise-linear z(x) over sorted breakpoints.
+// - Outside [x_front, x_back] the end values are held constant.
+// - Repeated x values encode a step; at the step x itself the right-hand value applies.
+// Lookups are a binary search over the breakpoints and write nothing, so one profile may be shared
+// read-only across threads.
+class PiecewiseLinear {
+ public:
+  PiecewiseLinear() : PiecewiseLinear(0.0) {}
+  explicit PiecewiseLinear(double constant_z) : PiecewiseLinear(std::vector<double>{0.0}, std::vector<double>{constant_z}) {}
+  PiecewiseLinear(std::vector<double> xs, std::vector<double> zs);
+
+  // Samples fn at `samples` evenly spaced points in [x_min, x_max]. Kinks between samples are smoothed,
+  // so prefer the explicit-breakpoint constructor when the geometry is known.
+  static PiecewiseLinear sampled(const std::function<double(double)>& fn, double x_min, double x_max, int samples);
+
+  // Non-empty, equal-length, finite and non-decreasing breakpoints. Evaluated once at construction.
+  bool valid() const { return valid_; }
+
+  std::size_t size() const { return x_.size(); }
+  const std::vector<double>& xs() const { return x_; }
+  const std::vector<double>& zs() const { return z_; }
+
+  double zAtX(double x) const {
+    const std::size_t n = x_.size();
+    if (n < 2 || x < x_.front()) return z_.front();
+    if (x >= x_.back()) return z_.back();
+
+    const std::size_t i = locate(x);
+    return z_[i] + slope_[i] * (x - x_[i]);
+  }
+
+ private:
+  // Index i of the segment with x_[i] <= x < x_[i + 1]; requires x_front <= x < x_back.
+  std::size_t locate(double x) const {
+    const auto it = std::upper_bound(x_.begin(), x_.end(), x);
+    return static_cast<std::size_t>(it - x_.begin()) - 1;
+  }
+
+  void finalize();
+
+  std::vector<double> x_;
+  std::vector<double> z_;
+  std::vector<double> slope_;  // per segment; 0 for zero-length (step) segments
+  bool valid_{false};
+};
+
+// Compiled floor/ceiling of one container + ramp. Build once per site and share via
+// EnvironmentGeometry::profile; defaults match EnvironmentGeometry's (floor 0 m, ceiling 10 m).
+struct TerrainProfile {
+  PiecewiseLinear floor{0.0};
+  PiecewiseLinear ceiling{10.0};
+
+  bool valid() const { return floor.valid() && ceiling.valid(); }
+
+  double floorZAtX(double x) const { return floor.zAtX(x); }
+  double ceilingZAtX(double x) const { return ceiling.zAtX(x); }
+};
+
+}  // namespace tlf
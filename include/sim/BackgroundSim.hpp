@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "controller/ControllerFactory.hpp"
+#include "sim/Scenario.hpp"
+#include "utils/LogRecord.hpp"
+
+namespace tlf::sim {
+
+// Runs one simulation at a time on a worker thread and streams its frames back as they are produced,
+// so a UI thread can keep rendering while an expensive controller re-simulates. Starting a new run
+// cancels the previous one; frames of cancelled runs are never delivered.
+class BackgroundSim {
+ public:
+  BackgroundSim();
+  // Cancels the current run and joins the worker.
+  ~BackgroundSim();
+
+  BackgroundSim(const BackgroundSim&) = delete;
+  BackgroundSim& operator=(const BackgroundSim&) = delete;
+
+  // Cancels any running simulation and queues this one; returns its generation (> 0).
+  std::uint64_t start(ControllerKind kind, const ControllerConfig& cfg, const Scenario& sc);
+  // Cancels the current run and discards its frames (takeFrames then reports a new, empty generation).
+  void cancel();
+
+  // Appends the frames of the latest started run produced since the previous call and returns that
+  // run's generation (0 before the first start). When the generation changed since the previous call,
+  // the caller should drop frames it already holds.
+  std::uint64_t takeFrames(std::vector<LogRecord>* out);
+
+  // The latest started run has not finished (or been cancelled) yet.
+  bool running() const { return running_.load(std::memory_order_acquire); }
+
+ private:
+  struct Job {
+    std::uint64_t generation{0};
+    ControllerKind kind{ControllerKind::GridSearch};
+    ControllerConfig cfg;
+    Scenario scenario;
+  };
+
+  void workerLoop();
+
+  std::thread worker_;
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::optional<Job> job_;  // queued, not yet picked up
+  bool stop_{false};
+
+  std::uint64_t generation_{0};  // latest started (or cancelled) run (guarded by mutex_)
+  std::vector<LogRecord> frames_;  // frames of generation_ not yet taken (guarded by mutex_)
+  std::atomic<bool> cancel_{false};
+  std::atomic<bool> running_{false};
+};
+
+}  // namespace tlf::sim
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "controller/Types.hpp"
+
+namespace tlf::sim {
+
+// State of one simulated truck. pitch_rad is the previous step's pitch (for the pitch-rate input).
+struct PlantState {
+  double time_s{0.0};
+  double s_m{0.0};
+  double lift_m{0.0};
+  double tilt_rad{0.0};
+  double speed_m_s{0.0};
+  double pitch_rad{0.0};
+};
+
+struct PlantParams {
+  double dt_s{0.1};
+  double base_speed_m_s{0.1};
+  double accel_limit_m_s2{0.4};  // <= 0: speed jumps to its target
+};
+
+// Actuators follow the command at its rate limits; forward speed tracks min(base speed, speed limit)
+// under the acceleration limit.
+class Plant {
+ public:
+  static void step(const PlantParams& p, const ControlCommand& cmd, PlantState* st) {
+    const double dt = p.dt_s;
+    st->lift_m += clampTo(cmd.lift_target_m - st->lift_m, cmd.lift_rate_limit_m_s * dt);
+    st->tilt_rad += clampTo(cmd.tilt_target_rad - st->tilt_rad, cmd.tilt_rate_limit_rad_s * dt);
+
+    const double target_speed = std::min(p.base_speed_m_s, cmd.speed_limit_m_s);
+    st->speed_m_s = (p.accel_limit_m_s2 > 0.0)
+                        ? st->speed_m_s + clampTo(target_speed - st->speed_m_s, p.accel_limit_m_s2 * dt)
+                        : target_speed;
+    st->s_m += st->speed_m_s * dt;
+    st->time_s += dt;
+  }
+
+  static double clampTo(double v, double limit) { return std::max(-limit, std::min(limit, v)); }
+};
+
+// Structure-of-arrays plant for many independent trucks stepped in lockstep; step() is a flat loop
+// over lanes that the compiler can vectorize.
+class PlantBatch {
+ public:
+  void resize(std::size_t lanes);
+  std::size_t size() const { return s_m.size(); }
+
+  // Lane i advances only if active[i] != 0; commands are read from the cmd_* arrays.
+  void step(const unsigned char* active);
+
+  // Per-lane parameters
+  std::vector<double> dt_s, base_speed_m_s, accel_limit_m_s2;
+  // Per-lane state
+  std::vector<double> time_s, s_m, lift_m, tilt_rad, speed_m_s, pitch_rad;
+  // Per-lane command of the current step
+  std::vector<double> cmd_lift_m, cmd_lift_rate_m_s, cmd_tilt_rad, cmd_tilt_rate_rad_s, cmd_speed_limit_m_s;
+
+  PlantState state(std::size_t i) const { return {time_s[i], s_m[i], lift_m[i], tilt_rad[i], speed_m_s[i], pitch_rad[i]}; }
+};
+
+}  // namespace tlf::sim
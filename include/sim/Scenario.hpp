@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "controller/ControllerFactory.hpp"
+#include "controller/Types.hpp"
+#include "model/TerrainProfile.hpp"
+
+namespace tlf::sim {
+
+// Ground -> ramp -> container side profile (door at door_x_m, container towards +x).
+// ramp_len_m <= 0 means an unbounded ramp: the floor keeps falling at the ramp slope for x < door.
+struct DockingEnv {
+  double door_x_m{0.0};
+  double container_len_m{8.0};
+  double container_h_m{2.5};
+  double ramp_len_m{2.5};
+  double ramp_slope_deg{4.0};
+  double ground_len_m{4.0};
+};
+
+double floorZAtX(const DockingEnv& e, double x_m);
+double ceilingZAtX(const DockingEnv& e, double x_m);
+
+// Same floor/ceiling as floorZAtX/ceilingZAtX, compiled once so the controller's inner loop avoids callbacks.
+TerrainProfile buildTerrainProfile(const DockingEnv& e);
+
+// Chassis pitch from the floor height under the two axles (wheels behind the mast, in -x).
+double pitchFromWheelContact(const DockingEnv& e, double mast_x_m, double wheelbase_m, double rear_to_mast_m);
+
+TerrainState terrainFromPitch(double pitch_rad);
+
+// Scripted terrain phases by mast position relative to the door, and the pitch of each phase.
+TerrainState scriptedTerrainFromS(const DockingEnv& e, double s_m);
+double scriptedPitch(const DockingEnv& e, TerrainState t, double s_m);
+
+enum class PitchModel {
+  WheelContact,  // pitch from the floor under the axles, terrain state from the pitch
+  Scripted,      // terrain state from s, fixed pitch per phase (viz_realtime's built-in trajectory)
+};
+
+// One closed-loop run: site, vehicle/load, plant limits and start/stop conditions. The plant follows
+// the commands with pure rate limits and advances at min(base speed, speed limit) under an
+// acceleration limit (accel_limit_m_s2 <= 0: the speed jumps to its target).
+struct Scenario {
+  DockingEnv env;
+  PitchModel pitch_model{PitchModel::WheelContact};
+  // Hand the controller the compiled TerrainProfile; otherwise only the scalar surfaces at s.
+  bool use_profile{true};
+
+  RackParams rack{2.32, 2.2, {0.25, 0.00}};
+  ForkliftParams forklift{0.15};  // mast pivot height above the floor
+
+  double wheelbase_m{2.0};
+  double rear_to_mast_m{0.1};
+
+  double dt_s{0.1};
+  double base_speed_m_s{0.1};
+  double accel_limit_m_s2{0.4};
+
+  double start_s_m{-3.6};
+  double start_lift_m{0.0};
+  double start_tilt_rad{0.0};
+  double end_s_m{5.0};
+  int max_steps{6000};
+};
+
+// The docking demo run by example_sim_trajectory (the Scenario defaults).
+inline Scenario dockingDemoScenario() { return Scenario{}; }
+
+// viz_realtime's built-in trajectory: unbounded 4 deg ramp, scripted pitch, scalar environment.
+Scenario vizRampScenario();
+
+// Controller settings tuned for the docking demo.
+ControllerConfig dockingDemoConfig(ControllerKind kind);
+
+// Half-widths of the uniform perturbations applied by randomizedScenario (0 keeps the base value).
+struct ScenarioSpread {
+  double ramp_slope_deg{1.0};
+  double ramp_len_m{0.5};
+  double container_h_m{0.08};
+  double rack_height_m{0.04};
+  double rack_length_m{0.1};
+  double mount_x_m{0.05};
+  double start_lift_m{0.1};
+  double base_speed_frac{0.2};  // relative to base.base_speed_m_s
+};
+
+// Monte-Carlo variant of base; deterministic in seed on every platform.
+Scenario randomizedScenario(const Scenario& base, const ScenarioSpread& spread, std::uint64_t seed);
+
+}  // namespace tlf::sim
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "controller/ControllerFactory.hpp"
+#include "sim/Plant.hpp"
+#include "sim/Scenario.hpp"
+
+namespace tlf::sim {
+
+struct RunSummary {
+  int steps{0};
+  // Reached end_s_m within max_steps.
+  bool completed{false};
+  // Sim time when the mast first crossed the door, and when the run reached end_s_m (-1 if never).
+  double time_to_door_s{-1.0};
+  double time_to_end_s{-1.0};
+
+  double min_clearance_top_m{0.0};
+  double min_clearance_bottom_m{0.0};
+  int warn_steps{0};
+  int stop_steps{0};
+  int degraded_steps{0};
+};
+
+// Controller input for the plant state st; *pitch_rad receives this step's pitch.
+ControlInput scenarioInput(const Scenario& sc,
+                           const PlantState& st,
+                           const std::shared_ptr<const TerrainProfile>& profile,
+                           double* pitch_rad);
+
+// Runs the closed loop from a reset controller. on_frame (optional) sees every step's frame.
+// The run stops early (completed = false) once *cancel becomes true.
+RunSummary runScenario(IController& controller,
+                       const Scenario& sc,
+                       const std::function<void(const DebugFrame&)>& on_frame = {},
+                       const std::atomic<bool>* cancel = nullptr);
+
+// Many independent scenarios stepped in lockstep, one controller per lane. Controllers run the slim
+// step(in, out) path and the plant update is a SoA loop across lanes. Summaries match runScenario.
+class BatchSim {
+ public:
+  BatchSim(ControllerKind kind, const ControllerConfig& cfg, const std::vector<Scenario>& scenarios);
+
+  std::size_t lanes() const { return lanes_.size(); }
+  std::size_t activeLanes() const { return active_count_; }
+
+  // Advances every unfinished lane by one step; false once all lanes have finished.
+  bool step();
+  void run() {
+    while (step()) {
+    }
+  }
+
+  const RunSummary& summary(std::size_t lane) const { return lanes_[lane].summary; }
+  IController& controller(std::size_t lane) { return *lanes_[lane].controller; }
+
+ private:
+  struct Lane {
+    Scenario scenario;
+    std::unique_ptr<IController> controller;
+    std::shared_ptr<const TerrainProfile> profile;
+    RunSummary summary;
+    double pitch_rad{0.0};  // this step's pitch, committed after the plant update
+    SafetyStatus safety;     // this step's safety status, booked after the plant update
+  };
+
+  std::vector<Lane> lanes_;
+  PlantBatch plant_;
+  std::vector<unsigned char> active_;
+  std::size_t active_count_{0};
+  ControlOutput out_;
+};
+
+// Runs every scenario with `threads` parallel workers (<= 0: hardware concurrency), each stepping a
+// batch of up to lanes_per_batch scenarios in lockstep. Results in input order.
+std::vector<RunSummary> runScenarios(ControllerKind kind,
+                                     const ControllerConfig& cfg,
+                                     const std::vector<Scenario>& scenarios,
+                                     int threads,
+                                     std::size_t lanes_per_batch = 32);
+
+}  // namespace tlf::sim
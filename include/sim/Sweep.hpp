@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "controller/ControllerFactory.hpp"
+#include "sim/Simulation.hpp"
+
+namespace tlf::sim {
+
+// Numeric ControllerConfig fields that a sweep may vary, by field name (e.g. "margin_top_m",
+// "w_center", "grid_lift_steps"). "grid_steps" sets grid_lift_steps and grid_tilt_steps together.
+const std::vector<std::string>& sweepableConfigFields();
+
+// Sets the named field (integers are rounded); false if the name is unknown.
+bool setConfigField(ControllerConfig* cfg, const std::string& name, double value);
+
+struct SweepAxis {
+  std::string field;
+  std::vector<double> values;
+};
+
+struct SweepPoint {
+  std::vector<double> values;  // one per axis, in axis order
+  RunSummary summary;
+  double mean_step_latency_us{0.0};  // from the controller's instrumentation (0 if compiled out)
+  // validateConfig's error when the combination is not a valid config: the run is skipped and the
+  // point never enters the Pareto front. Empty for points that ran.
+  std::string invalid;
+  bool valid() const { return invalid.empty(); }
+};
+
+// Runs the docking scenario for every combination of axis values (cartesian product, last axis
+// fastest) with `threads` parallel runs (<= 0: hardware concurrency). One controller per run.
+// Combinations that validateConfig rejects (e.g. coarse_grid_steps = 3) are reported, not run.
+std::vector<SweepPoint> runSweep(ControllerKind kind,
+                                 const ControllerConfig& base,
+                                 const Scenario& scenario,
+                                 const std::vector<SweepAxis>& axes,
+                                 int threads);
+
+// Indices of the non-dominated points under: completed runs first, then lower time_to_end_s,
+// higher min(clearance_top, clearance_bottom), fewer STOP steps and lower mean step latency.
+// Invalid points are never on the front.
+std::vector<std::size_t> paretoFront(const std::vector<SweepPoint>& points);
+
+}  // namespace tlf::sim
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "controller/Types.hpp"
+#include "utils/LogRecord.hpp"
+#include "utils/LogSink.hpp"
+#include "utils/SpscRing.hpp"
+
+namespace tlf {
+
+// What push() does when the ring is full.
+enum class LogOverflowPolicy {
+  Drop,   // discard the frame and count it in dropped()
+  Block,  // spin (yielding) until the writer frees a slot; no frame is lost
+};
+
+// Moves log writing off the control thread: push() copies a LogRecord into a bounded SPSC ring and a
+// background thread drains it into the sink. push() never locks or allocates, so a slow disk or a
+// stream flush cannot stall the next controller step (unless the Block policy is chosen and the ring fills).
+//
+// One producer thread only. The sink is used exclusively by the writer thread until the logger is destroyed.
+class AsyncLogger {
+ public:
+  AsyncLogger(LogSink& sink,
+              std::size_t capacity = 4096,
+              LogOverflowPolicy policy = LogOverflowPolicy::Drop,
+              std::chrono::microseconds idle_poll = std::chrono::microseconds(500));
+
+  // Drains every queued record, flushes the sink and joins the writer.
+  ~AsyncLogger();
+
+  AsyncLogger(const AsyncLogger&) = delete;
+  AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+  // False if the record was dropped (Drop policy, ring full).
+  bool push(const LogRecord& r);
+  bool pushFrame(const DebugFrame& f) { return push(toLogRecord(f)); }
+  bool pushFrame(const ControlInput& in, const ControlOutput& out) { return push(toLogRecord(in, out)); }
+
+  LogOverflowPolicy policy() const { return policy_; }
+  std::size_t capacity() const { return ring_.capacity(); }
+
+  // Counters are safe to read from any thread.
+  std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+  std::uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+
+ private:
+  void run();
+
+  LogSink& sink_;
+  SpscRing<LogRecord> ring_;
+  LogOverflowPolicy policy_;
+  std::chrono::microseconds idle_poll_;
+
+  std::atomic<bool> stop_{false};
+  std::atomic<std::uint64_t> dropped_{0};
+  std::atomic<std::uint64_t> written_{0};
+  std::thread writer_;
+};
+
+}  // namespace tlf
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "controller/Types.hpp"
+#include "utils/LogRecord.hpp"
+#include "utils/LogSink.hpp"
+
+namespace tlf {
+
+// Per-block compression. LZ4/Zstd are available only when the library was built against them
+// (see logCodecAvailable); otherwise BinaryLogger stores blocks uncompressed.
+enum class LogCodec : std::uint8_t { None = 0, LZ4 = 1, Zstd = 2 };
+
+bool logCodecAvailable(LogCodec codec);
+const char* toString(LogCodec codec);
+
+// Binary columnar log (format in docs/log_format.md): a versioned header with the column list, then
+// blocks of up to records_per_block frames, each stored column by column (little-endian) and
+// optionally compressed. Same columns and values as CsvLogger.
+class BinaryLogger final : public LogSink {
+ public:
+  static constexpr std::uint16_t kVersion = 1;
+
+  explicit BinaryLogger(std::string path, LogCodec codec = LogCodec::None, std::size_t records_per_block = 1024);
+  ~BinaryLogger() override;
+
+  BinaryLogger(const BinaryLogger&) = delete;
+  BinaryLogger& operator=(const BinaryLogger&) = delete;
+
+  bool good() const { return out_.good(); }
+
+  // Codec actually used (None if the requested one is unavailable).
+  LogCodec codec() const { return codec_; }
+
+  void writeFrame(const DebugFrame& f) { writeRecord(toLogRecord(f)); }
+  void writeRecord(const LogRecord& r) override;
+
+  // Writes the pending partial block and flushes the stream.
+  void flush() override;
+
+ private:
+  void writeBlock();
+
+  std::ofstream out_;
+  LogCodec codec_{LogCodec::None};
+  std::size_t records_per_block_{1024};
+
+  std::vector<LogRecord> pending_;
+  std::vector<unsigned char> raw_;
+  std::vector<unsigned char> packed_;
+};
+
+// Sequential reader for BinaryLogger files. Columns are matched by name, so files with extra
+// columns still load and missing columns read as zero.
+class BinaryLogReader {
+ public:
+  explicit BinaryLogReader(const std::string& path);
+
+  // False after a malformed header/block or an unsupported codec; see error().
+  bool good() const { return error_.empty(); }
+  const std::string& error() const { return error_; }
+
+  std::uint16_t version() const { return version_; }
+  const std::vector<std::string>& columnNames() const { return column_names_; }
+
+  // Next record in file order; false at end of file or on error.
+  bool next(LogRecord* r);
+
+ private:
+  bool readBlock();
+
+  std::ifstream in_;
+  std::string error_;
+  std::uint16_t version_{0};
+  std::vector<std::string> column_names_;
+  std::vector<LogColumnType> column_types_;
+  std::vector<int> column_map_;  // file column -> kLogColumns index (-1 if unknown)
+
+  std::vector<LogRecord> block_;
+  std::size_t block_pos_{0};
+  std::vector<unsigned char> raw_;
+  std::vector<unsigned char> packed_;
+};
+
+// True if the file starts with the BinaryLogger magic.
+bool isBinaryLog(const std::string& path);
+
+}  // namespace tlf
@@ -4,16 +4,20 @@
 #include <string>
 
 #include "controller/Types.hpp"
+#include "utils/LogRecord.hpp"
+#include "utils/LogSink.hpp"
 
 namespace tlf {
 
-class CsvLogger {
+class CsvLogger final : public LogSink {
  public:
   explicit CsvLogger(std::string path);
   bool good() const { return out_.good(); }
 
   void writeHeader();
   void writeFrame(const DebugFrame& f);
+  void writeRecord(const LogRecord& r) override;
+  void flush() override { out_.flush(); }
 
  private:
   std::ofstream out_;
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <chrono>
+
+namespace tlf {
+
+// Step time budget (ControllerConfig::step_time_budget_us), measured from construction on the steady
+// clock independently of TLF_ENABLE_INSTRUMENTATION. A budget <= 0 never expires and never reads the
+// clock. Once expired() has returned true it stays true without further clock reads.
+class Deadline {
+ public:
+  explicit Deadline(int budget_us) : active_(budget_us > 0) {
+    if (active_) end_ = std::chrono::steady_clock::now() + std::chrono::microseconds(budget_us);
+  }
+
+  bool active() const { return active_; }
+
+  bool expired() {
+    if (!active_ || hit_) return hit_;
+    hit_ = std::chrono::steady_clock::now() >= end_;
+    return hit_;
+  }
+
+  // Whether an expired() check has seen the deadline pass.
+  bool hit() const { return hit_; }
+
+ private:
+  bool active_;
+  bool hit_{false};
+  std::chrono::steady_clock::time_point end_{};
+};
+
+}  // namespace tlf
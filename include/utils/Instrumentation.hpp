@@ -0,0 +1,203 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Build with TLF_ENABLE_INSTRUMENTATION=0 (CMake option of the same name) to compile every recording
+// call down to nothing; snapshots then stay all-zero.
+#ifndef TLF_ENABLE_INSTRUMENTATION
+#define TLF_ENABLE_INSTRUMENTATION 1
+#endif
+
+namespace tlf {
+
+inline constexpr bool kInstrumentationEnabled = (TLF_ENABLE_INSTRUMENTATION != 0);
+
+// Plain copy of a Histogram, safe to inspect on any thread.
+struct HistogramSnapshot {
+  // Bucket b counts values v with bit_width(v) == b: bucket 0 holds 0, bucket b holds [2^(b-1), 2^b).
+  static constexpr int kBuckets = 64;
+
+  std::array<std::uint64_t, kBuckets> buckets{};
+  std::uint64_t count{0};
+  std::uint64_t sum{0};
+  std::uint64_t max{0};
+
+  double mean() const { return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+
+  // Upper edge of the bucket holding the q-quantile (q in [0, 1]), capped at max; 0 when empty.
+  std::uint64_t percentile(double q) const {
+    if (count == 0) return 0;
+    const double target = q * static_cast<double>(count);
+    std::uint64_t seen = 0;
+    for (int b = 0; b < kBuckets; ++b) {
+      seen += buckets[static_cast<size_t>(b)];
+      if (static_cast<double>(seen) >= target && seen > 0) {
+        const std::uint64_t upper = (b == 0) ? 0 : ((1ull << b) - 1);
+        return upper < max ? upper : max;
+      }
+    }
+    return max;
+  }
+};
+
+// Fixed-bucket (log2) histogram with a single writer and any number of concurrent readers.
+// The writer uses relaxed load + store instead of read-modify-write, so recording never locks or
+// contends; readers see each counter untorn, with at most one in-flight sample missing.
+class Histogram {
+ public:
+  void record(std::uint64_t v) {
+    if constexpr (kInstrumentationEnabled) {
+      bump(buckets_[static_cast<size_t>(bucketOf(v))], 1);
+      bump(count_, 1);
+      bump(sum_, v);
+      if (v > max_.load(std::memory_order_relaxed)) max_.store(v, std::memory_order_relaxed);
+    } else {
+      (void)v;
+    }
+  }
+
+  HistogramSnapshot snapshot() const {
+    HistogramSnapshot s;
+    for (int b = 0; b < HistogramSnapshot::kBuckets; ++b) {
+      s.buckets[static_cast<size_t>(b)] = buckets_[static_cast<size_t>(b)].load(std::memory_order_relaxed);
+    }
+    s.count = count_.load(std::memory_order_relaxed);
+    s.sum = sum_.load(std::memory_order_relaxed);
+    s.max = max_.load(std::memory_order_relaxed);
+    return s;
+  }
+
+  // Writer thread only (or while the writer is idle).
+  void reset() {
+    for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  static int bucketOf(std::uint64_t v) {
+    int b = 0;
+    while (v != 0 && b < HistogramSnapshot::kBuckets - 1) {
+      v >>= 1;
+      ++b;
+    }
+    return b;
+  }
+
+  static void bump(std::atomic<std::uint64_t>& a, std::uint64_t d) {
+    a.store(a.load(std::memory_order_relaxed) + d, std::memory_order_relaxed);
+  }
+
+  std::array<std::atomic<std::uint64_t>, HistogramSnapshot::kBuckets> buckets_{};
+  std::atomic<std::uint64_t> count_{0};
+  std::atomic<std::uint64_t> sum_{0};
+  std::atomic<std::uint64_t> max_{0};
+};
+
+// What one controller step did; filled by the controller and handed to ControllerInstrumentation.
+struct StepMetrics {
+  std::uint64_t latency_ns{0};
+  int candidates_evaluated{0};
+  // Candidates / predicted states that passed the hard clearance constraints.
+  int candidates_feasible{0};
+  // MPC only: frontier nodes expanded, and children dropped by deduplication or the beam cut.
+  int beam_nodes_expanded{0};
+  int beam_nodes_pruned{0};
+  // MPC only: the horizon search found nothing and the single-step fallback grid ran.
+  bool fallback_grid{false};
+  // The step ran out of ControllerConfig::step_time_budget_us.
+  bool budget_exhausted{false};
+};
+
+struct InstrumentationSnapshot {
+  HistogramSnapshot step_latency_ns;
+  HistogramSnapshot candidates_evaluated;
+  HistogramSnapshot candidates_feasible;
+  HistogramSnapshot beam_nodes_expanded;
+  HistogramSnapshot beam_nodes_pruned;
+  std::uint64_t fallback_grid_steps{0};
+  std::uint64_t budget_exhausted_steps{0};
+};
+
+// Per-controller accumulation of StepMetrics. record() runs on the control thread; snapshot() may be
+// called concurrently from a telemetry thread and never blocks the writer.
+class ControllerInstrumentation {
+ public:
+  void record(const StepMetrics& m) {
+    if constexpr (kInstrumentationEnabled) {
+      step_latency_ns_.record(m.latency_ns);
+      candidates_evaluated_.record(static_cast<std::uint64_t>(m.candidates_evaluated));
+      candidates_feasible_.record(static_cast<std::uint64_t>(m.candidates_feasible));
+      beam_nodes_expanded_.record(static_cast<std::uint64_t>(m.beam_nodes_expanded));
+      beam_nodes_pruned_.record(static_cast<std::uint64_t>(m.beam_nodes_pruned));
+      if (m.fallback_grid) {
+        fallback_grid_steps_.store(fallback_grid_steps_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      }
+      if (m.budget_exhausted) {
+        budget_exhausted_steps_.store(budget_exhausted_steps_.load(std::memory_order_relaxed) + 1,
+                                      std::memory_order_relaxed);
+      }
+    } else {
+      (void)m;
+    }
+  }
+
+  InstrumentationSnapshot snapshot() const {
+    InstrumentationSnapshot s;
+    s.step_latency_ns = step_latency_ns_.snapshot();
+    s.candidates_evaluated = candidates_evaluated_.snapshot();
+    s.candidates_feasible = candidates_feasible_.snapshot();
+    s.beam_nodes_expanded = beam_nodes_expanded_.snapshot();
+    s.beam_nodes_pruned = beam_nodes_pruned_.snapshot();
+    s.fallback_grid_steps = fallback_grid_steps_.load(std::memory_order_relaxed);
+    s.budget_exhausted_steps = budget_exhausted_steps_.load(std::memory_order_relaxed);
+    return s;
+  }
+
+  // Control thread only (or while the controller is idle).
+  void reset() {
+    step_latency_ns_.reset();
+    candidates_evaluated_.reset();
+    candidates_feasible_.reset();
+    beam_nodes_expanded_.reset();
+    beam_nodes_pruned_.reset();
+    fallback_grid_steps_.store(0, std::memory_order_relaxed);
+    budget_exhausted_steps_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  Histogram step_latency_ns_;
+  Histogram candidates_evaluated_;
+  Histogram candidates_feasible_;
+  Histogram beam_nodes_expanded_;
+  Histogram beam_nodes_pruned_;
+  std::atomic<std::uint64_t> fallback_grid_steps_{0};
+  std::atomic<std::uint64_t> budget_exhausted_steps_{0};
+};
+
+// Monotonic step timer; free when instrumentation is compiled out.
+class StepTimer {
+ public:
+  StepTimer() {
+    if constexpr (kInstrumentationEnabled) t0_ = std::chrono::steady_clock::now();
+  }
+
+  std::uint64_t elapsedNs() const {
+    if constexpr (kInstrumentationEnabled) {
+      return static_cast<std::uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0_).count());
+    } else {
+      return 0;
+    }
+  }
+
+ private:
+  std::chrono::steady_clock::time_point t0_{};
+};
+
+}  // namespace tlf
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tlf {
+
+// Min/max-preserving multi-resolution index over a log's time series (clearances, commands, ...)
+// for plotting long logs at any zoom. Level k stores, per channel and per aligned bucket of 2^k
+// frames, the frames holding the bucket's minimum and maximum (first one on ties). select() picks
+// the level that fits the requested point budget and returns frame indices to draw: every bucket's
+// min and max frame of every channel, so no extremum (in particular no clearance minimum) is
+// decimated out, plus every entry into STOP in the range.
+//
+// Frames are appended in order (append() extends the open bucket of every level in O(levels)), so
+// the index can follow a log that is still growing. Memory is about 2 bytes per channel per frame on
+// top of the channel values (an 8-byte min/max pair per 2^k frames, summed over the levels k >= 3).
+class LodIndex {
+ public:
+  explicit LodIndex(std::size_t channels = 0);
+
+  std::size_t channelCount() const { return values_.size(); }
+  std::size_t frames() const { return frames_; }
+  double value(std::size_t channel, std::size_t frame) const { return values_[channel][frame]; }
+  const std::vector<double>& channel(std::size_t c) const { return values_[c]; }
+  // Frames whose safety level is STOP while the previous one was not, in order.
+  const std::vector<std::uint32_t>& stopEntries() const { return stop_entries_; }
+
+  void clear();
+  void reserve(std::size_t frames);
+
+  // values[c] for every channel; safety_level as in LogRecord.
+  void append(const double* values, std::int32_t safety_level);
+
+  // Sorted, unique frame indices in [begin, end) to plot that range with about max_buckets buckets:
+  // all frames if they fit, otherwise per bucket the min / max frame of each channel, plus begin,
+  // end - 1 and the STOP entries. At most 2 * channels * (max_buckets + 2) + 2 + STOP entries.
+  void select(std::size_t begin, std::size_t end, std::size_t max_buckets, std::vector<std::uint32_t>* out) const;
+
+ private:
+  // Levels below this are not stored; select() scans the (at most 2^kMinLevel * max_buckets) frames.
+  static constexpr int kMinLevel = 3;
+
+  struct Extrema {
+    std::uint32_t min_frame;
+    std::uint32_t max_frame;
+  };
+
+  void scan(std::size_t begin, std::size_t end, std::vector<std::uint32_t>* out) const;
+
+  std::vector<std::vector<double>> values_;
+  // levels_[k - kMinLevel][bucket * channels + c]
+  std::vector<std::vector<Extrema>> levels_;
+  std::vector<std::uint32_t> stop_entries_;
+  std::size_t frames_{0};
+  bool prev_stop_{false};
+};
+
+}  // namespace tlf
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "utils/LogReader.hpp"  // listLogFiles
+#include "utils/LogRecord.hpp"
+
+namespace tlf {
+
+inline constexpr std::size_t kSafetyLevelCount = 4;   // SafetyLevel OK..DEGRADED
+inline constexpr std::size_t kTerrainStateCount = 5;  // TerrainState Ground..InContainer
+inline constexpr std::size_t kCornerCount = 4;        // CornerId RearBottom..FrontTop
+
+struct LogStatsOptions {
+  // Histogram of min(clearance_top, clearance_bottom) per frame: bins of hist_bin_m starting at
+  // hist_min_m; values outside fall into the first / last bin.
+  double hist_min_m{-0.10};
+  double hist_bin_m{0.01};
+  int hist_bins{60};
+
+  // A near miss starts when the min clearance drops below this (rising edge), attributed to the
+  // frame's worst_point_id.
+  double near_miss_m{0.05};
+};
+
+// Aggregates of one log (or of several, see merge()). Times are dwell times: the interval from a
+// frame to the next one is attributed to the first frame's state. Non-positive or non-finite
+// intervals (clock resets between concatenated runs) count as zero. Frames with an out-of-range
+// enum value still count towards frames / histogram but not towards that enum's totals.
+struct LogStats {
+  std::string path;   // empty for aggregates
+  std::string error;  // read error (the frames before it are still counted)
+
+  std::uint64_t frames{0};
+  std::uint64_t skipped_lines{0};
+  double duration_s{0.0};
+
+  double min_clearance_top_m{std::numeric_limits<double>::infinity()};
+  double min_clearance_bottom_m{std::numeric_limits<double>::infinity()};
+  std::vector<std::uint64_t> clearance_hist;
+
+  std::array<double, kSafetyLevelCount> level_time_s{};
+  std::array<std::uint64_t, kSafetyLevelCount> level_frames{};
+  std::array<double, kTerrainStateCount> terrain_time_s{};
+
+  std::array<std::uint64_t, kCornerCount> near_miss_events{};
+  std::uint64_t stop_events{0};  // entries into STOP
+
+  // Adds another log's totals (histograms must have the same bins). Event counts are summed, so
+  // an event spanning two files counts in both.
+  void merge(const LogStats& o);
+};
+
+// Single-pass, constant-memory accumulation of LogStats over frames in file order.
+class LogStatsAccumulator {
+ public:
+  explicit LogStatsAccumulator(const LogStatsOptions& options = {});
+
+  void add(const LogRecord& r);
+
+  const LogStats& stats() const { return stats_; }
+  LogStats& stats() { return stats_; }
+
+ private:
+  LogStatsOptions options_;
+  LogStats stats_;
+
+  bool have_prev_{false};
+  double prev_time_s_{0.0};
+  std::int32_t prev_level_{0};
+  std::int32_t prev_terrain_{0};
+  bool in_near_miss_{false};
+  bool in_stop_{false};
+};
+
+// Streams one CSV or binary log (LogReader) through a LogStatsAccumulator.
+LogStats analyzeLogFile(const std::string& path, const LogStatsOptions& options = {});
+
+struct LogSummary {
+  LogStatsOptions options;
+  std::vector<LogStats> runs;  // one per input file, in input order
+  LogStats fleet;              // merge of all runs
+};
+
+// Analyzes the files with `threads` files in flight (<= 0: hardware concurrency). Each worker holds
+// one reader and one accumulator, so memory does not grow with log size. Results do not depend on
+// the thread count.
+LogSummary analyzeLogFiles(const std::vector<std::string>& paths, const LogStatsOptions& options = {}, int threads = 0);
+
+// Compact JSON summary (docs/log_format.md), loadable by tools/web_viewer.
+std::string logSummaryToJson(const LogSummary& summary);
+bool writeLogSummary(const std::string& path, const LogSummary& summary, std::string* error = nullptr);
+
+}  // namespace tlf
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "utils/LogRecord.hpp"
+#include "utils/MappedFile.hpp"
+
+namespace tlf {
+
+class BinaryLogReader;
+
+// Columnar copy of a log: column(i) holds every frame's value of kLogColumns[i]
+// (I32 columns widened to double, which is exact).
+struct LogColumnData {
+  std::size_t rows{0};
+  std::array<std::vector<double>, kLogColumnCount> columns;
+
+  const std::vector<double>& column(std::size_t i) const { return columns[i]; }
+  // nullptr if the name is not one of kLogColumns.
+  const std::vector<double>* column(const std::string& name) const;
+};
+
+// Reads CSV (docs/log_format.md) and BinaryLogger files through one interface; the format is
+// detected from the file magic. CSV files are memory-mapped and parsed in place with
+// std::from_chars; columns are matched by header name, so extra columns are ignored and missing
+// ones read as zero. Malformed CSV lines are skipped and counted. Frames are read strictly forward
+// and consumed parts of the mapping are released, so memory stays bounded for files larger than RAM.
+class LogReader {
+ public:
+  enum class Format { Csv, Binary };
+
+  explicit LogReader(const std::string& path);
+  ~LogReader();
+
+  LogReader(const LogReader&) = delete;
+  LogReader& operator=(const LogReader&) = delete;
+
+  bool good() const { return error_.empty(); }
+  const std::string& error() const { return error_; }
+  Format format() const { return format_; }
+  const std::vector<std::string>& columnNames() const { return column_names_; }
+
+  // Next frame in file order; false at end of file or on error.
+  bool next(LogRecord* r);
+
+  // CSV data lines that were skipped (wrong field count or unparsable field).
+  std::size_t skippedLines() const { return skipped_lines_; }
+
+  // Single-pass input iterator over the remaining frames.
+  class iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = LogRecord;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const LogRecord*;
+    using reference = const LogRecord&;
+
+    iterator() = default;
+    explicit iterator(LogReader* reader) : reader_(reader) { ++*this; }
+
+    reference operator*() const { return record_; }
+    pointer operator->() const { return &record_; }
+    iterator& operator++() {
+      if (reader_ && !reader_->next(&record_)) reader_ = nullptr;
+      return *this;
+    }
+    bool operator==(const iterator& o) const { return reader_ == o.reader_; }
+    bool operator!=(const iterator& o) const { return reader_ != o.reader_; }
+
+   private:
+    LogReader* reader_{nullptr};
+    LogRecord record_{};
+  };
+
+  iterator begin() { return iterator(this); }
+  iterator end() { return iterator(); }
+
+  // Reads every remaining frame into columns.
+  LogColumnData readColumns();
+
+ private:
+  bool parseCsvHeader();
+  bool parseCsvLine(const char* b, const char* e, LogRecord* r);
+
+  Format format_{Format::Csv};
+  std::string error_;
+  std::vector<std::string> column_names_;
+
+  MappedFile file_;
+  std::size_t pos_{0};
+  std::size_t discarded_{0};  // prefix of file_ already handed back (MappedFile::discardBefore)
+  std::vector<int> column_map_;  // CSV field -> kLogColumns index (-1 if unknown)
+  std::size_t skipped_lines_{0};
+
+  std::unique_ptr<BinaryLogReader> binary_;
+};
+
+// Reads a whole CSV or binary log into memory; returns false (with *error set) on failure.
+bool readLogFile(const std::string& path, std::vector<LogRecord>* out, std::string* error = nullptr);
+
+// `path` itself if it is a file, otherwise every *.csv / *.tlfb below it (recursively), sorted.
+std::vector<std::string> listLogFiles(const std::string& path);
+
+}  // namespace tlf
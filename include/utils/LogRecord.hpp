@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "controller/Types.hpp"
+#include "model/Geometry.hpp"
+
+namespace tlf {
+
+// One log frame with the fixed column set of docs/log_format.md, as a trivially copyable POD.
+// Shared by CsvLogger and BinaryLogger so both formats carry exactly the same values.
+struct LogRecord {
+  double time_s{0.0};
+  double s_m{0.0};
+  double pitch_rad{0.0};
+  double pitch_rate_rad_s{0.0};
+  double lift_m{0.0};
+  double tilt_rad{0.0};
+  double ceiling_z_m{0.0};
+  double floor_z_m{0.0};
+
+  double rb_x{0.0};
+  double rb_z{0.0};
+  double rt_x{0.0};
+  double rt_z{0.0};
+  double fb_x{0.0};
+  double fb_z{0.0};
+  double ft_x{0.0};
+  double ft_z{0.0};
+
+  double clearance_top_m{0.0};
+  double clearance_bottom_m{0.0};
+
+  double lift_cmd_m{0.0};
+  double tilt_cmd_rad{0.0};
+  double speed_limit_m_s{0.0};
+
+  std::int32_t safety_level{0};
+  std::int32_t terrain_state{0};
+  std::int32_t worst_point_id{0};
+};
+
+enum class LogColumnType : std::uint8_t { F64 = 0, I32 = 1 };
+
+struct LogColumn {
+  const char* name;  // CSV header name
+  LogColumnType type;
+  std::size_t offset;  // offsetof(LogRecord, field)
+};
+
+// Column order of both formats (CSV header order).
+inline constexpr std::size_t kLogColumnCount = 24;
+inline constexpr std::array<LogColumn, kLogColumnCount> kLogColumns{{
+    {"time", LogColumnType::F64, offsetof(LogRecord, time_s)},
+    {"s", LogColumnType::F64, offsetof(LogRecord, s_m)},
+    {"pitch", LogColumnType::F64, offsetof(LogRecord, pitch_rad)},
+    {"pitch_rate", LogColumnType::F64, offsetof(LogRecord, pitch_rate_rad_s)},
+    {"lift", LogColumnType::F64, offsetof(LogRecord, lift_m)},
+    {"tilt", LogColumnType::F64, offsetof(LogRecord, tilt_rad)},
+    {"ceiling_z", LogColumnType::F64, offsetof(LogRecord, ceiling_z_m)},
+    {"floor_z", LogColumnType::F64, offsetof(LogRecord, floor_z_m)},
+    {"rb_x", LogColumnType::F64, offsetof(LogRecord, rb_x)},
+    {"rb_z", LogColumnType::F64, offsetof(LogRecord, rb_z)},
+    {"rt_x", LogColumnType::F64, offsetof(LogRecord, rt_x)},
+    {"rt_z", LogColumnType::F64, offsetof(LogRecord, rt_z)},
+    {"fb_x", LogColumnType::F64, offsetof(LogRecord, fb_x)},
+    {"fb_z", LogColumnType::F64, offsetof(LogRecord, fb_z)},
+    {"ft_x", LogColumnType::F64, offsetof(LogRecord, ft_x)},
+    {"ft_z", LogColumnType::F64, offsetof(LogRecord, ft_z)},
+    {"clearance_top", LogColumnType::F64, offsetof(LogRecord, clearance_top_m)},
+    {"clearance_bottom", LogColumnType::F64, offsetof(LogRecord, clearance_bottom_m)},
+    {"lift_cmd", LogColumnType::F64, offsetof(LogRecord, lift_cmd_m)},
+    {"tilt_cmd", LogColumnType::F64, offsetof(LogRecord, tilt_cmd_rad)},
+    {"speed_limit", LogColumnType::F64, offsetof(LogRecord, speed_limit_m_s)},
+    {"safety_level", LogColumnType::I32, offsetof(LogRecord, safety_level)},
+    {"terrain_state", LogColumnType::I32, offsetof(LogRecord, terrain_state)},
+    {"worst_point_id", LogColumnType::I32, offsetof(LogRecord, worst_point_id)},
+}};
+
+namespace detail {
+
+inline LogRecord makeLogRecord(double time_s,
+                               const ControlInput& in,
+                               const CornerPoints2D& corners,
+                               double ceiling_z_m,
+                               double floor_z_m,
+                               const ControlCommand& cmd,
+                               const SafetyStatus& safety) {
+  const auto& c = corners.p;
+
+  LogRecord r;
+  r.time_s = time_s;
+  r.s_m = in.s_m;
+  r.pitch_rad = in.pitch_rad;
+  r.pitch_rate_rad_s = in.pitch_rate_rad_s;
+  r.lift_m = in.lift_pos_m;
+  r.tilt_rad = in.tilt_rad;
+  r.ceiling_z_m = ceiling_z_m;
+  r.floor_z_m = floor_z_m;
+  r.rb_x = c[0].x;
+  r.rb_z = c[0].z;
+  r.rt_x = c[1].x;
+  r.rt_z = c[1].z;
+  r.fb_x = c[2].x;
+  r.fb_z = c[2].z;
+  r.ft_x = c[3].x;
+  r.ft_z = c[3].z;
+  r.clearance_top_m = safety.clearance_top_m;
+  r.clearance_bottom_m = safety.clearance_bottom_m;
+  r.lift_cmd_m = cmd.lift_target_m;
+  r.tilt_cmd_rad = cmd.tilt_target_rad;
+  r.speed_limit_m_s = cmd.speed_limit_m_s;
+  r.safety_level = static_cast<std::int32_t>(safety.level);
+  r.terrain_state = static_cast<std::int32_t>(in.terrain);
+  r.worst_point_id = static_cast<std::int32_t>(safety.worst_point);
+  return r;
+}
+
+}  // namespace detail
+
+inline LogRecord toLogRecord(const DebugFrame& f) {
+  return detail::makeLogRecord(f.time_s, f.in, f.corners, f.ceiling_z_m, f.floor_z_m, f.cmd, f.safety);
+}
+
+// Same record from the slim step(in, out) path (ControllerFleet, BatchSim): the pose diagnostics a
+// DebugFrame would carry are recomputed from the input, so the two overloads agree exactly.
+inline LogRecord toLogRecord(const ControlInput& in, const ControlOutput& out) {
+  const CornerPoints2D corners =
+      computeRackCorners2D(in.s_m, in.lift_pos_m, in.pitch_rad, in.tilt_rad, in.env, in.rack, in.forklift);
+  return detail::makeLogRecord(out.time_s, in, corners, envCeilingZAtX(in.env, in.s_m), envFloorZAtX(in.env, in.s_m),
+                               out.cmd, out.safety);
+}
+
+}  // namespace tlf
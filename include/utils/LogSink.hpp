@@ -0,0 +1,18 @@
+#pragma once
+
+#include "utils/LogRecord.hpp"
+
+namespace tlf {
+
+// Destination for log records (CsvLogger, BinaryLogger, ...). Called from one thread at a time.
+class LogSink {
+ public:
+  virtual ~LogSink() = default;
+
+  virtual void writeRecord(const LogRecord& r) = 0;
+  virtual void flush() = 0;
+  // Called by AsyncLogger's writer whenever its ring is empty; lets network sinks service sockets.
+  virtual void idle() {}
+};
+
+}  // namespace tlf
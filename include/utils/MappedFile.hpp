@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace tlf {
+
+// Read-only view of a whole file: memory-mapped where supported, otherwise read into a buffer.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& o) noexcept;
+  MappedFile& operator=(MappedFile&& o) noexcept;
+
+  bool good() const { return ok_; }
+  const char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+  // Hint that [0, offset) will not be read again: drops those resident pages of a mapping so a
+  // forward scan over a file larger than RAM keeps a bounded footprint. Later reads of the range
+  // still work (pages fault back in). No-op for the buffered fallback.
+  void discardBefore(std::size_t offset);
+
+ private:
+  void release();
+
+  const char* data_{nullptr};
+  std::size_t size_{0};
+  bool ok_{false};
+  bool mapped_{false};
+  std::vector<char> buffer_;
+};
+
+}  // namespace tlf
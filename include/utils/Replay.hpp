@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "controller/ControllerFactory.hpp"
+#include "controller/Types.hpp"
+#include "utils/LogRecord.hpp"
+
+namespace tlf {
+
+// How recorded frames are turned back into controller inputs, and what counts as a difference.
+// Logs carry neither the rack/forklift geometry nor the terrain profile, so those come from here;
+// the environment is rebuilt as the recorded scalar ceiling_z/floor_z at each frame's s.
+struct ReplayOptions {
+  ControllerKind kind{ControllerKind::GridSearch};
+  ControllerConfig config;
+  RackParams rack;
+  ForkliftParams forklift;
+
+  // dt for a frame whose time delta cannot be derived (non-increasing time column).
+  double fallback_dt_s{0.1};
+
+  // A frame differs when any command moves by more than these (CSV logs keep 6 decimals).
+  double lift_tol_m{1e-5};
+  double tilt_tol_rad{1e-5};
+  double speed_tol_m_s{1e-5};
+};
+
+struct ReplayResult {
+  std::string path;
+  bool ok{false};
+  std::string error;
+
+  std::size_t frames{0};
+  std::size_t command_diff_frames{0};
+  std::size_t safety_diff_frames{0};
+  long first_diff_frame{-1};  // first frame with any difference, -1 if none
+
+  double max_lift_diff_m{0.0};
+  double max_tilt_diff_rad{0.0};
+  double max_speed_diff_m_s{0.0};
+
+  // Safety levels of the re-run (index = SafetyLevel) and the recorded log.
+  std::size_t replay_level_counts[4]{0, 0, 0, 0};
+  std::size_t recorded_level_counts[4]{0, 0, 0, 0};
+
+  double recorded_min_clearance_top_m{0.0};
+  double recorded_min_clearance_bottom_m{0.0};
+  double replay_min_clearance_top_m{0.0};
+  double replay_min_clearance_bottom_m{0.0};
+
+  bool identical() const { return ok && command_diff_frames == 0 && safety_diff_frames == 0; }
+};
+
+// Input of the frame r; dt_s is the time since the previous frame.
+ControlInput controlInputFromRecord(const LogRecord& r, double dt_s, const ReplayOptions& opt);
+
+// Runs a fresh controller over the frames in order and diffs its output against the recording.
+ReplayResult replayRecords(const std::vector<LogRecord>& records, const ReplayOptions& opt);
+
+// Same for one CSV or binary log file.
+ReplayResult replayFile(const std::string& path, const ReplayOptions& opt);
+
+// Replays every file with `threads` parallel workers (<= 0: hardware concurrency); one controller
+// per file, results in input order.
+std::vector<ReplayResult> replayFiles(const std::vector<std::string>& paths, const ReplayOptions& opt, int threads);
+
+}  // namespace tlf
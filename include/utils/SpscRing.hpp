@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace tlf {
+
+// Bounded single-producer / single-consumer ring buffer for trivially copyable items.
+// Storage is allocated once in the constructor; tryPush/tryPop never lock or allocate.
+template <typename T>
+class SpscRing {
+  static_assert(std::is_trivially_copyable_v<T>, "SpscRing holds trivially copyable items");
+
+ public:
+  // capacity is rounded up to a power of two (at least 2).
+  explicit SpscRing(std::size_t capacity) {
+    std::size_t n = 2;
+    while (n < capacity) n <<= 1;
+    slots_.resize(n);
+    mask_ = n - 1;
+  }
+
+  std::size_t capacity() const { return slots_.size(); }
+
+  // Producer thread only. False if the ring is full.
+  bool tryPush(const T& item) {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - cached_tail_ == slots_.size()) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head - cached_tail_ == slots_.size()) return false;
+    }
+    slots_[head & mask_] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer thread only. False if the ring is empty.
+  bool tryPop(T* item) {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == cached_head_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail == cached_head_) return false;
+    }
+    *item = slots_[tail & mask_];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate when called concurrently with push/pop.
+  std::size_t size() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+
+ private:
+  std::vector<T> slots_;
+  std::size_t mask_{0};
+
+  // Producer and consumer indices on separate cache lines; each side caches the other's index.
+  alignas(64) std::atomic<std::size_t> head_{0};
+  std::size_t cached_tail_{0};
+  alignas(64) std::atomic<std::size_t> tail_{0};
+  std::size_t cached_head_{0};
+};
+
+}  // namespace tlf
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "controller/Types.hpp"
+#include "utils/LogRecord.hpp"
+#include "utils/LogSink.hpp"
+
+namespace tlf {
+
+struct TelemetryOptions {
+  std::string bind_address{"127.0.0.1"};
+  std::uint16_t port{8765};  // 0 picks a free port (see WebSocketTelemetrySink::port())
+  // Publish every decimation-th record; 1 sends every frame.
+  int decimation{5};
+  int max_clients{4};
+  // A client whose unsent backlog exceeds this skips frames until it catches up.
+  std::size_t max_backlog_bytes{1u << 20};
+};
+
+// One LogRecord as a JSON object keyed by the CSV column names (the web viewer's sample format).
+std::string logRecordToJson(const LogRecord& r);
+
+// Minimal WebSocket (RFC 6455) publisher of decimated log records for tools/web_viewer live mode.
+// Meant to be driven by an AsyncLogger: all serialization and socket I/O happen on its writer thread,
+// and every socket is non-blocking, so neither step() nor the writer ever waits on a slow client.
+//
+// Server-to-client text frames only; client messages other than close are ignored, and a client that
+// sends more than a handshake's or a control frame's worth of data is disconnected. POSIX only:
+// elsewhere good() is false and records are discarded.
+class WebSocketTelemetrySink final : public LogSink {
+ public:
+  explicit WebSocketTelemetrySink(TelemetryOptions options = {});
+  ~WebSocketTelemetrySink() override;
+
+  WebSocketTelemetrySink(const WebSocketTelemetrySink&) = delete;
+  WebSocketTelemetrySink& operator=(const WebSocketTelemetrySink&) = delete;
+
+  // False if the listening socket could not be opened; see error().
+  bool good() const { return listen_fd_ >= 0; }
+  const std::string& error() const { return error_; }
+  // Bound port (the chosen one when options.port was 0).
+  std::uint16_t port() const { return port_; }
+
+  void writeFrame(const DebugFrame& f) { writeRecord(toLogRecord(f)); }
+  void writeRecord(const LogRecord& r) override;
+  // Services connections and sends what the sockets accept right now; never blocks.
+  void flush() override;
+  void idle() override { flush(); }
+
+  // Writer thread only.
+  int clients() const;
+  std::uint64_t framesSent() const { return frames_sent_; }
+  std::uint64_t framesSkipped() const { return frames_skipped_; }
+
+ private:
+  struct Client {
+    int fd{-1};
+    bool open{false};  // handshake done
+    std::string in;
+    std::string out;
+    std::size_t out_pos{0};
+  };
+
+  void acceptClients();
+  void serviceClient(Client& c);
+  void closeClient(Client& c);
+
+  TelemetryOptions options_;
+  int listen_fd_{-1};
+  std::uint16_t port_{0};
+  std::string error_;
+  std::vector<Client> clients_;
+
+  std::uint64_t seen_{0};
+  std::uint64_t frames_sent_{0};
+  std::uint64_t frames_skipped_{0};
+  std::string message_;
+};
+
+}  // namespace tlf
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace tlf {
+
+// Fixed set of persistent worker threads for fork-join loops on the control path.
+// parallelFor() does not allocate: the loop body is passed by reference, not wrapped in std::function.
+// One parallelFor() runs at a time per pool; calls from several threads are serialized.
+class ThreadPool {
+ public:
+  // `threads` is the total parallelism including the calling thread, so threads - 1 workers are started.
+  explicit ThreadPool(int threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int size() const { return static_cast<int>(workers_.size()) + 1; }
+
+  // Runs fn(i) for every i in [0, n) across the workers and the calling thread, and returns once all
+  // calls finished. Indices are handed out dynamically (an atomic counter), so uneven tasks balance.
+  template <typename Fn>
+  void parallelFor(int n, Fn&& fn) {
+    using F = std::remove_reference_t<Fn>;
+    run(n, const_cast<void*>(static_cast<const void*>(&fn)), [](void* ctx, int i) { (*static_cast<F*>(ctx))(i); });
+  }
+
+ private:
+  using InvokeFn = void (*)(void*, int);
+
+  void run(int n, void* ctx, InvokeFn invoke);
+  void workerLoop();
+  void drain();
+
+  std::vector<std::thread> workers_;
+
+  std::mutex run_mutex_;  // serializes parallelFor() callers
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  std::size_t generation_{0};
+  int active_workers_{0};
+  bool stop_{false};
+
+  // Current job
+  void* ctx_{nullptr};
+  InvokeFn invoke_{nullptr};
+  int n_{0};
+  std::atomic<int> next_{0};
+};
+
+}  // namespace tlf
@@ -0,0 +1,46 @@
+#include "utils/AsyncLogger.hpp"
+
+namespace tlf {
+
+AsyncLogger::AsyncLogger(LogSink& sink, std::size_t capacity, LogOverflowPolicy policy, std::chrono::microseconds idle_poll)
+    : sink_(sink), ring_(capacity), policy_(policy), idle_poll_(idle_poll) {
+  writer_ = std::thread([this] { run(); });
+}
+
+AsyncLogger::~AsyncLogger() {
+  stop_.store(true, std::memory_order_release);
+  writer_.join();
+}
+
+bool AsyncLogger::push(const LogRecord& r) {
+  if (ring_.tryPush(r)) return true;
+  if (policy_ == LogOverflowPolicy::Drop) {
+    // Single producer: load + store is enough, and keeps the push path free of read-modify-writes.
+    dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return false;
+  }
+  while (!ring_.tryPush(r)) std::this_thread::yield();
+  return true;
+}
+
+void AsyncLogger::run() {
+  LogRecord r;
+  for (;;) {
+    // Read the stop flag before draining so records pushed ahead of the destructor are never lost.
+    const bool stopping = stop_.load(std::memory_order_acquire);
+    std::uint64_t n = 0;
+    while (ring_.tryPop(&r)) {
+      sink_.writeRecord(r);
+      ++n;
+    }
+    if (n > 0) written_.store(written_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    if (stopping) break;
+    if (n == 0) {
+      sink_.idle();
+      std::this_thread::sleep_for(idle_poll_);
+    }
+  }
+  sink_.flush();
+}
+
+}  // namespace tlf
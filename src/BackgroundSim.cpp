@@ -0,0 +1,96 @@
+#include "sim/BackgroundSim.hpp"
+
+#include "sim/Simulation.hpp"
+
+namespace tlf::sim {
+
+namespace {
+
+// Frames are published under the lock in small batches to keep contention with the UI thread low.
+constexpr std::size_t kPublishBatch = 16;
+
+}  // namespace
+
+BackgroundSim::BackgroundSim() { worker_ = std::thread([this] { workerLoop(); }); }
+
+BackgroundSim::~BackgroundSim() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    job_.reset();
+  }
+  cancel_.store(true, std::memory_order_relaxed);
+  wake_.notify_one();
+  worker_.join();
+}
+
+std::uint64_t BackgroundSim::start(ControllerKind kind, const ControllerConfig& cfg, const Scenario& sc) {
+  std::uint64_t gen = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    gen = ++generation_;
+    job_ = Job{gen, kind, cfg, sc};
+    frames_.clear();
+    // Set under the lock: the worker clears the flag under it when it picks up the next job, so it
+    // can never cancel the job queued here.
+    cancel_.store(true, std::memory_order_relaxed);
+    running_.store(true, std::memory_order_release);
+  }
+  wake_.notify_one();
+  return gen;
+}
+
+void BackgroundSim::cancel() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++generation_;  // frames still in flight belong to an older generation and are dropped
+  job_.reset();
+  frames_.clear();
+  cancel_.store(true, std::memory_order_relaxed);
+  running_.store(false, std::memory_order_release);
+}
+
+std::uint64_t BackgroundSim::takeFrames(std::vector<LogRecord>* out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  out->insert(out->end(), frames_.begin(), frames_.end());
+  frames_.clear();
+  return generation_;
+}
+
+void BackgroundSim::workerLoop() {
+  std::vector<LogRecord> batch;
+  batch.reserve(kPublishBatch);
+
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [&] { return stop_ || job_.has_value(); });
+      if (stop_) return;
+      job = std::move(*job_);
+      job_.reset();
+      cancel_.store(false, std::memory_order_relaxed);
+    }
+
+    // Publishes the batch only if this job is still the latest one.
+    auto publish = [&] {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (generation_ == job.generation) frames_.insert(frames_.end(), batch.begin(), batch.end());
+      batch.clear();
+    };
+
+    auto controller = makeController(job.kind, job.cfg);
+    runScenario(
+        *controller, job.scenario,
+        [&](const DebugFrame& f) {
+          batch.push_back(toLogRecord(f));
+          if (batch.size() >= kPublishBatch) publish();
+        },
+        &cancel_);
+    publish();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation_ == job.generation) running_.store(false, std::memory_order_release);
+  }
+}
+
+}  // namespace tlf::sim
@@ -0,0 +1,341 @@
+#include "utils/BinaryLog.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(TLF_HAVE_LZ4)
+#include <lz4.h>
+#endif
+#if defined(TLF_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace tlf {
+
+namespace {
+
+constexpr char kFileMagic[4] = {'T', 'L', 'F', 'B'};
+constexpr char kBlockMagic[4] = {'T', 'L', 'B', 'K'};
+constexpr std::size_t kBlockHeaderBytes = 4 + 4 + 4 + 4 + 4;
+constexpr int kZstdLevel = 3;
+
+std::size_t columnBytes(LogColumnType t) { return (t == LogColumnType::F64) ? 8 : 4; }
+
+void putU16(std::vector<unsigned char>& b, std::uint16_t v) {
+  b.push_back(static_cast<unsigned char>(v & 0xFF));
+  b.push_back(static_cast<unsigned char>(v >> 8));
+}
+
+void putU32(unsigned char* p, std::uint32_t v) {
+  for (int i = 0; i < 4; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+void putU64(unsigned char* p, std::uint64_t v) {
+  for (int i = 0; i < 8; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+std::uint16_t getU16(const unsigned char* p) { return static_cast<std::uint16_t>(p[0] | (p[1] << 8)); }
+
+std::uint32_t getU32(const unsigned char* p) {
+  std::uint32_t v = 0;
+  for (int i = 0; i < 4; ++i) v |= static_cast<std::uint32_t>(p[i]) << (8 * i);
+  return v;
+}
+
+std::uint64_t getU64(const unsigned char* p) {
+  std::uint64_t v = 0;
+  for (int i = 0; i < 8; ++i) v |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+  return v;
+}
+
+// Raw block payload: every column's values for all records, column after column.
+void encodeColumns(const std::vector<LogRecord>& records, std::vector<unsigned char>* raw) {
+  std::size_t bytes = 0;
+  for (const auto& col : kLogColumns) bytes += columnBytes(col.type) * records.size();
+  raw->resize(bytes);
+
+  unsigned char* p = raw->data();
+  for (const auto& col : kLogColumns) {
+    for (const auto& r : records) {
+      const auto* field = reinterpret_cast<const unsigned char*>(&r) + col.offset;
+      if (col.type == LogColumnType::F64) {
+        std::uint64_t bits;
+        std::memcpy(&bits, field, sizeof(bits));
+        putU64(p, bits);
+        p += 8;
+      } else {
+        std::int32_t v;
+        std::memcpy(&v, field, sizeof(v));
+        putU32(p, static_cast<std::uint32_t>(v));
+        p += 4;
+      }
+    }
+  }
+}
+
+// Compresses raw into packed; returns false (caller stores raw) if the codec fails or does not help.
+bool compressBlock(LogCodec codec, const std::vector<unsigned char>& raw, std::vector<unsigned char>* packed) {
+  switch (codec) {
+#if defined(TLF_HAVE_LZ4)
+    case LogCodec::LZ4: {
+      packed->resize(static_cast<std::size_t>(LZ4_compressBound(static_cast<int>(raw.size()))));
+      const int n = LZ4_compress_default(reinterpret_cast<const char*>(raw.data()), reinterpret_cast<char*>(packed->data()),
+                                         static_cast<int>(raw.size()), static_cast<int>(packed->size()));
+      if (n <= 0) return false;
+      packed->resize(static_cast<std::size_t>(n));
+      return packed->size() < raw.size();
+    }
+#endif
+#if defined(TLF_HAVE_ZSTD)
+    case LogCodec::Zstd: {
+      packed->resize(ZSTD_compressBound(raw.size()));
+      const std::size_t n = ZSTD_compress(packed->data(), packed->size(), raw.data(), raw.size(), kZstdLevel);
+      if (ZSTD_isError(n)) return false;
+      packed->resize(n);
+      return packed->size() < raw.size();
+    }
+#endif
+    default:
+      (void)raw;
+      (void)packed;
+      return false;
+  }
+}
+
+bool decompressBlock(LogCodec codec, const std::vector<unsigned char>& packed, std::vector<unsigned char>* raw) {
+  switch (codec) {
+    case LogCodec::None:
+      *raw = packed;
+      return true;
+#if defined(TLF_HAVE_LZ4)
+    case LogCodec::LZ4: {
+      const int n = LZ4_decompress_safe(reinterpret_cast<const char*>(packed.data()), reinterpret_cast<char*>(raw->data()),
+                                        static_cast<int>(packed.size()), static_cast<int>(raw->size()));
+      return n >= 0 && static_cast<std::size_t>(n) == raw->size();
+    }
+#endif
+#if defined(TLF_HAVE_ZSTD)
+    case LogCodec::Zstd: {
+      const std::size_t n = ZSTD_decompress(raw->data(), raw->size(), packed.data(), packed.size());
+      return !ZSTD_isError(n) && n == raw->size();
+    }
+#endif
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+bool logCodecAvailable(LogCodec codec) {
+  switch (codec) {
+    case LogCodec::None:
+      return true;
+    case LogCodec::LZ4:
+#if defined(TLF_HAVE_LZ4)
+      return true;
+#else
+      return false;
+#endif
+    case LogCodec::Zstd:
+#if defined(TLF_HAVE_ZSTD)
+      return true;
+#else
+      return false;
+#endif
+    default:
+      return false;
+  }
+}
+
+const char* toString(LogCodec codec) {
+  switch (codec) {
+    case LogCodec::None:
+      return "none";
+    case LogCodec::LZ4:
+      return "lz4";
+    case LogCodec::Zstd:
+      return "zstd";
+    default:
+      return "unknown";
+  }
+}
+
+BinaryLogger::BinaryLogger(std::string path, LogCodec codec, std::size_t records_per_block)
+    : out_(std::move(path), std::ios::binary),
+      codec_(logCodecAvailable(codec) ? codec : LogCodec::None),
+      records_per_block_(std::max<std::size_t>(1, records_per_block)) {
+  pending_.reserve(records_per_block_);
+
+  std::vector<unsigned char> header(kFileMagic, kFileMagic + 4);
+  putU16(header, kVersion);
+  putU16(header, static_cast<std::uint16_t>(kLogColumnCount));
+  for (const auto& col : kLogColumns) {
+    const std::size_t len = std::strlen(col.name);
+    header.push_back(static_cast<unsigned char>(col.type));
+    header.push_back(static_cast<unsigned char>(len));
+    header.insert(header.end(), col.name, col.name + len);
+  }
+  out_.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+}
+
+BinaryLogger::~BinaryLogger() { flush(); }
+
+void BinaryLogger::writeRecord(const LogRecord& r) {
+  pending_.push_back(r);
+  if (pending_.size() >= records_per_block_) writeBlock();
+}
+
+void BinaryLogger::flush() {
+  if (!pending_.empty()) writeBlock();
+  out_.flush();
+}
+
+void BinaryLogger::writeBlock() {
+  encodeColumns(pending_, &raw_);
+  const bool compressed = (codec_ != LogCodec::None) && compressBlock(codec_, raw_, &packed_);
+  const auto& payload = compressed ? packed_ : raw_;
+
+  unsigned char hdr[kBlockHeaderBytes];
+  std::memcpy(hdr, kBlockMagic, 4);
+  putU32(hdr + 4, static_cast<std::uint32_t>(pending_.size()));
+  hdr[8] = static_cast<unsigned char>(compressed ? codec_ : LogCodec::None);
+  hdr[9] = hdr[10] = hdr[11] = 0;
+  putU32(hdr + 12, static_cast<std::uint32_t>(raw_.size()));
+  putU32(hdr + 16, static_cast<std::uint32_t>(payload.size()));
+
+  out_.write(reinterpret_cast<const char*>(hdr), sizeof(hdr));
+  out_.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+  pending_.clear();
+}
+
+BinaryLogReader::BinaryLogReader(const std::string& path) : in_(path, std::ios::binary) {
+  if (!in_.good()) {
+    error_ = "cannot open " + path;
+    return;
+  }
+
+  unsigned char head[8];
+  if (!in_.read(reinterpret_cast<char*>(head), sizeof(head)) || std::memcmp(head, kFileMagic, 4) != 0) {
+    error_ = "not a binary log";
+    return;
+  }
+  version_ = getU16(head + 4);
+  if (version_ == 0 || version_ > BinaryLogger::kVersion) {
+    error_ = "unsupported log version " + std::to_string(version_);
+    return;
+  }
+
+  const std::uint16_t n_cols = getU16(head + 6);
+  for (std::uint16_t i = 0; i < n_cols; ++i) {
+    unsigned char meta[2];
+    if (!in_.read(reinterpret_cast<char*>(meta), sizeof(meta))) {
+      error_ = "truncated column list";
+      return;
+    }
+    std::string name(meta[1], '\0');
+    if (!in_.read(name.data(), static_cast<std::streamsize>(name.size()))) {
+      error_ = "truncated column list";
+      return;
+    }
+    const auto type = static_cast<LogColumnType>(meta[0]);
+    if (type != LogColumnType::F64 && type != LogColumnType::I32) {
+      error_ = "unknown type for column " + name;
+      return;
+    }
+
+    int mapped = -1;
+    for (std::size_t k = 0; k < kLogColumnCount; ++k) {
+      if (name == kLogColumns[k].name) {
+        if (kLogColumns[k].type != type) {
+          error_ = "type mismatch for column " + name;
+          return;
+        }
+        mapped = static_cast<int>(k);
+        break;
+      }
+    }
+    column_names_.push_back(std::move(name));
+    column_types_.push_back(type);
+    column_map_.push_back(mapped);
+  }
+}
+
+bool BinaryLogReader::next(LogRecord* r) {
+  if (!good()) return false;
+  if (block_pos_ >= block_.size() && !readBlock()) return false;
+  *r = block_[block_pos_++];
+  return true;
+}
+
+bool BinaryLogReader::readBlock() {
+  block_.clear();
+  block_pos_ = 0;
+
+  unsigned char hdr[kBlockHeaderBytes];
+  if (!in_.read(reinterpret_cast<char*>(hdr), sizeof(hdr))) {
+    if (in_.gcount() != 0) error_ = "truncated block header";
+    return false;  // clean end of file
+  }
+  if (std::memcmp(hdr, kBlockMagic, 4) != 0) {
+    error_ = "bad block magic";
+    return false;
+  }
+  const std::uint32_t count = getU32(hdr + 4);
+  const auto codec = static_cast<LogCodec>(hdr[8]);
+  const std::uint32_t raw_bytes = getU32(hdr + 12);
+  const std::uint32_t stored_bytes = getU32(hdr + 16);
+
+  std::size_t expected = 0;
+  for (auto t : column_types_) expected += columnBytes(t) * count;
+  if (expected != raw_bytes) {
+    error_ = "block size does not match column list";
+    return false;
+  }
+  if (!logCodecAvailable(codec)) {
+    error_ = std::string("block codec not available: ") + toString(codec);
+    return false;
+  }
+
+  packed_.resize(stored_bytes);
+  if (!in_.read(reinterpret_cast<char*>(packed_.data()), static_cast<std::streamsize>(stored_bytes))) {
+    error_ = "truncated block";
+    return false;
+  }
+  raw_.resize(raw_bytes);
+  if (!decompressBlock(codec, packed_, &raw_) || raw_.size() != raw_bytes) {
+    error_ = "block decompression failed";
+    return false;
+  }
+
+  block_.assign(count, LogRecord{});
+  const unsigned char* p = raw_.data();
+  for (std::size_t c = 0; c < column_types_.size(); ++c) {
+    const std::size_t width = columnBytes(column_types_[c]);
+    const int mapped = column_map_[c];
+    if (mapped < 0) {
+      p += width * count;
+      continue;
+    }
+    const std::size_t offset = kLogColumns[static_cast<std::size_t>(mapped)].offset;
+    for (std::uint32_t i = 0; i < count; ++i, p += width) {
+      auto* field = reinterpret_cast<unsigned char*>(&block_[i]) + offset;
+      if (width == 8) {
+        const std::uint64_t bits = getU64(p);
+        std::memcpy(field, &bits, sizeof(bits));
+      } else {
+        const auto v = static_cast<std::int32_t>(getU32(p));
+        std::memcpy(field, &v, sizeof(v));
+      }
+    }
+  }
+  return count > 0 || readBlock();
+}
+
+bool isBinaryLog(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  char magic[4];
+  return in.read(magic, sizeof(magic)) && std::memcmp(magic, kFileMagic, 4) == 0;
+}
+
+}  // namespace tlf
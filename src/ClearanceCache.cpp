@@ -0,0 +1,157 @@
+#include "model/ClearanceCache.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace tlf {
+
+namespace {
+
+constexpr std::size_t kMaxProbe = 8;
+
+std::int64_t exactKey(double v) {
+  std::int64_t k;
+  std::memcpy(&k, &v, sizeof(k));
+  return k;
+}
+
+std::int64_t quantizedKey(double v, double inv_quantum) {
+  if (inv_quantum <= 0.0) return exactKey(v);
+  const double q = std::round(v * inv_quantum);
+  // Non-finite or out-of-range poses still get a deterministic (bit-pattern) key.
+  if (!(std::abs(q) < 9.0e18)) return exactKey(v);
+  return static_cast<std::int64_t>(q);
+}
+
+std::uint64_t mix(std::uint64_t h, std::int64_t v) {
+  h ^= static_cast<std::uint64_t>(v) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  return h;
+}
+
+bool samePlane(const std::optional<Plane>& a, const std::optional<Plane>& b) {
+  if (a.has_value() != b.has_value()) return false;
+  if (!a) return true;
+  return a->a == b->a && a->b == b->b && a->c == b->c && a->d == b->d;
+}
+
+}  // namespace
+
+void ClearanceCache::configure(std::size_t capacity, double quantum_m, double quantum_rad) {
+  if (capacity == requested_capacity_ && quantum_m == quantum_m_ && quantum_rad == quantum_rad_) return;
+  requested_capacity_ = capacity;
+  quantum_m_ = quantum_m;
+  quantum_rad_ = quantum_rad;
+
+  std::size_t n = 0;
+  if (capacity > 0) {
+    n = 1;
+    while (n < capacity) n <<= 1;
+  }
+  slots_.assign(n, Slot{});
+  mask_ = (n > 0) ? n - 1 : 0;
+  inv_quantum_m_ = (quantum_m > 0.0) ? 1.0 / quantum_m : 0.0;
+  inv_quantum_rad_ = (quantum_rad > 0.0) ? 1.0 / quantum_rad : 0.0;
+  epoch_ = 1;
+  has_last_ = false;
+}
+
+void ClearanceCache::clear() {
+  if (++epoch_ == 0) {
+    for (auto& slot : slots_) slot.epoch = 0;
+    epoch_ = 1;
+  }
+}
+
+void ClearanceCache::beginStep(const EnvironmentGeometry& env,
+                               const RackParams& rack,
+                               const ForkliftParams& forklift,
+                               bool keep_entries) {
+  const bool has_profile = env.profile && env.profile->valid();
+  const TerrainProfile* profile = has_profile ? env.profile.get() : nullptr;
+  const bool has_callbacks = !profile && (env.ceiling_z_at_x_m || env.floor_z_at_x_m);
+
+  const bool same = has_last_ && !has_callbacks && !last_.has_callbacks && profile == last_.profile.get() &&
+                    env.ceiling_z_m == last_.ceiling_z_m && env.floor_z_m == last_.floor_z_m &&
+                    samePlane(env.ceiling_plane, last_.ceiling_plane) && samePlane(env.floor_plane, last_.floor_plane) &&
+                    rack.height_m == last_.rack.height_m && rack.length_m == last_.rack.length_m &&
+                    rack.mount_offset_m.x == last_.rack.mount_offset_m.x &&
+                    rack.mount_offset_m.z == last_.rack.mount_offset_m.z &&
+                    forklift.mast_pivot_height_m == last_.forklift.mast_pivot_height_m;
+  if (!keep_entries || !same) clear();
+  geometry_unchanged_ = same;
+
+  if (last_.profile.get() != profile) {  // no refcount traffic while the profile is unchanged
+    last_.profile = has_profile ? env.profile : nullptr;
+  }
+  last_.has_callbacks = has_callbacks;
+  last_.ceiling_z_m = env.ceiling_z_m;
+  last_.floor_z_m = env.floor_z_m;
+  last_.ceiling_plane = env.ceiling_plane;
+  last_.floor_plane = env.floor_plane;
+  last_.rack = rack;
+  last_.forklift = forklift;
+  has_last_ = true;
+}
+
+ClearanceCache::Key ClearanceCache::makeKey(double s_m, double lift_m, double theta) const {
+  return Key{quantizedKey(s_m, inv_quantum_m_), quantizedKey(lift_m, inv_quantum_m_), quantizedKey(theta, inv_quantum_rad_)};
+}
+
+ClearanceResult ClearanceCache::evaluate(double s_m,
+                                         double lift_m,
+                                         double pitch_rad,
+                                         double tilt_rad,
+                                         const EnvironmentGeometry& env,
+                                         const RackParams& rack,
+                                         const ForkliftParams& forklift,
+                                         double margin_top_m,
+                                         double margin_bottom_m) {
+  if (slots_.empty()) {
+    return computeClearances(computeRackCorners2D(s_m, lift_m, pitch_rad, tilt_rad, env, rack, forklift), env,
+                             margin_top_m, margin_bottom_m);
+  }
+
+  const Key key = makeKey(s_m, lift_m, pitch_rad + tilt_rad);
+  const std::size_t home = static_cast<std::size_t>(mix(mix(mix(0, key.s), key.lift), key.theta)) & mask_;
+
+  Slot* target = nullptr;
+  for (std::size_t p = 0; p < kMaxProbe; ++p) {
+    Slot& slot = slots_[(home + p) & mask_];
+    if (slot.epoch != epoch_) {
+      if (!target) target = &slot;
+      break;  // entries are never erased individually, so a stale slot ends the probe chain
+    }
+    if (slot.key == key) {
+      ++hits_;
+      ClearanceResult r;
+      r.clearance_top_m = slot.top_m - margin_top_m;
+      r.clearance_bottom_m = slot.bottom_m - margin_bottom_m;
+      r.top_worst_point = slot.top_worst;
+      r.bottom_worst_point = slot.bottom_worst;
+      r.worst_point = (r.clearance_top_m < r.clearance_bottom_m) ? r.top_worst_point : r.bottom_worst_point;
+      return r;
+    }
+  }
+  ++misses_;
+  if (!target) target = &slots_[home];  // probe window full: replace the home slot
+
+  // Margin-free evaluation; subtracting the margins afterwards reproduces computeClearances exactly.
+  const auto raw = computeClearances(computeRackCorners2D(s_m, lift_m, pitch_rad, tilt_rad, env, rack, forklift), env, 0.0, 0.0);
+  target->epoch = epoch_;
+  target->key = key;
+  target->top_m = raw.clearance_top_m;
+  target->bottom_m = raw.clearance_bottom_m;
+  target->top_worst = raw.top_worst_point;
+  target->bottom_worst = raw.bottom_worst_point;
+
+  ClearanceResult r = raw;
+  r.clearance_top_m = raw.clearance_top_m - margin_top_m;
+  r.clearance_bottom_m = raw.clearance_bottom_m - margin_bottom_m;
+  r.worst_point = (r.clearance_top_m < r.clearance_bottom_m) ? r.top_worst_point : r.bottom_worst_point;
+  return r;
+}
+
+}  // namespace tlf
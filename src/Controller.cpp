@@ -4,157 +4,144 @@
 #include <cmath>
 #include <limits>
 #include <sstream>
+#include <type_traits>
 
-namespace tlf {
-
-static constexpr double kClearanceEpsilonM = 5e-4;
+#include "controller/SearchCore.hpp"
+#include "utils/Deadline.hpp"
 
-static bool finiteAll(const ControlInput& in) {
-  auto finite = [](double v) { return std::isfinite(v); };
-  return finite(in.dt_s) && finite(in.pitch_rad) && finite(in.pitch_rate_rad_s) && finite(in.s_m) &&
-         finite(in.lift_pos_m) && finite(in.tilt_rad) && finite(in.rack.height_m) && finite(in.rack.length_m) &&
-         finite(in.rack.mount_offset_m.x) && finite(in.rack.mount_offset_m.z);
-}
+namespace tlf {
 
 static double clamp(double v, double lo, double hi) {
   return std::max(lo, std::min(hi, v));
 }
 
-static double lerp(double a, double b, double t) { return a + (b - a) * t; }
-
-static SafetyStatus makeSafety(const ControllerConfig& cfg,
-                              double clearance_top_m,
-                              double clearance_bottom_m,
-                              CornerId worst,
-                              bool degraded,
-                              SafetyCode code_override = SafetyCode::None,
-                              std::string message_override = {}) {
-  SafetyStatus s;
-  s.clearance_top_m = clearance_top_m;
-  s.clearance_bottom_m = clearance_bottom_m;
-  s.worst_point = worst;
-
-  if (degraded) {
-    s.level = SafetyLevel::DEGRADED;
-    s.code = (code_override == SafetyCode::None) ? SafetyCode::InputInvalid : code_override;
-    s.message = message_override.empty() ? "DEGRADED" : message_override;
-    return s;
-  }
-
-  const double min_clear = std::min(clearance_top_m, clearance_bottom_m);
+Controller::Controller(ControllerConfig cfg) : cfg_(cfg) { applyConfig(); }
 
-  // Allow a tiny tolerance to prevent numerical noise from causing STOP.
-  if (min_clear < (cfg.hard_threshold_m - kClearanceEpsilonM)) {
-    s.level = SafetyLevel::STOP;
-    s.code = (code_override == SafetyCode::None) ? SafetyCode::ClearanceHardViolated : code_override;
-    s.message = message_override.empty() ? "STOP: hard clearance violated" : message_override;
-    return s;
-  }
-
-  if (min_clear < cfg.warn_threshold_m) {
-    s.level = SafetyLevel::WARN;
-    s.code = (code_override == SafetyCode::None) ? SafetyCode::ClearanceSoftNear : code_override;
-    s.message = message_override.empty() ? "WARN: clearance near boundary" : message_override;
-    return s;
-  }
-
-  s.level = SafetyLevel::OK;
-  s.code = SafetyCode::None;
-  s.message = "OK";
+bool Controller::configure(const ControllerConfig& cfg, std::string* error) {
+  if (!validateConfig(cfg, error)) return false;
+  cfg_ = cfg;
+  applyConfig();
+  return true;
+}
 
-  // Allow non-fatal diagnostic codes even when geometrically OK.
-  if (code_override != SafetyCode::None) {
-    s.code = code_override;
-    if (!message_override.empty()) s.message = message_override;
+void Controller::applyConfig() {
+  makeConfigTables(cfg_, &tables_);
+  cache_.configure(static_cast<size_t>(std::max(0, cfg_.clearance_cache_capacity)), cfg_.clearance_cache_quantum_m,
+                   cfg_.clearance_cache_quantum_rad);
+
+  // Largest grid either search mode evaluates in one pass.
+  const size_t nL = static_cast<size_t>(std::max(tables_.grid_lift_steps, tables_.coarse_grid_steps));
+  const size_t nT = static_cast<size_t>(std::max(tables_.grid_tilt_steps, tables_.coarse_grid_steps));
+  lift_grid_.reserve(nL);
+  tilt_grid_.reserve(nT);
+  // The double batch is always needed: float32 scoring falls back to it for callback / profile surfaces.
+  batch_.resize(nL, nT);
+  if (tables_.use_lookahead) batch_ahead_.resize(nL, nT);
+  if (cfg_.float32_candidates) {
+    batchf_.resize(nL, nT);
+    if (tables_.use_lookahead) batchf_ahead_.resize(nL, nT);
+    pending_.reserve(nL * nT);
+    cost_lift_terms_.reserve(nL);
+    cost_tilt_terms_.reserve(nT);
   }
-  return s;
+  anchor_.valid = false;  // solved under the previous config
+  config_dirty_ = false;
 }
 
-Controller::Controller(ControllerConfig cfg) : cfg_(cfg) {}
+void Controller::warmup(const ControlInput& in) {
+  warming_up_ = true;
+  ControlOutput out;
+  for (int i = 0; i < kWarmupSteps; ++i) solve(in, out, nullptr);
+  (void)step(in);  // DebugFrame path
+  ControlInput degraded = in;
+  degraded.inputs_valid = false;
+  solve(degraded, out, nullptr);
+  warming_up_ = false;
+  reset();
+}
 
 void Controller::reset() {
   time_s_ = 0.0;
   prev_lift_rate_m_s_ = 0.0;
   prev_tilt_rate_rad_s_ = 0.0;
+  cache_.clear();
+  anchor_.valid = false;
 }
 
 DebugFrame Controller::step(const ControlInput& in) {
   DebugFrame f;
   f.in = in;
 
-  const double dt = (in.dt_s > 1e-6 && std::isfinite(in.dt_s)) ? in.dt_s : 0.02;
-  time_s_ += dt;
-  f.time_s = time_s_;
-
-  bool degraded = false;
-  SafetyCode degraded_code = SafetyCode::None;
-  std::string degraded_msg;
-
-  if (!in.inputs_valid || !finiteAll(in) || !(dt > 0.0)) {
-    degraded = true;
-    degraded_code = SafetyCode::InputInvalid;
-    degraded_msg = "Invalid inputs";
-  } else if (std::abs(in.pitch_rate_rad_s) > cfg_.pitch_rate_jitter_threshold_rad_s) {
-    degraded = true;
-    degraded_code = SafetyCode::PitchJitter;
-    degraded_msg = "Pitch rate jitter";
-  }
-
-  // Apply degraded multipliers
-  const double margin_mult = degraded ? cfg_.degraded_margin_multiplier : 1.0;
-  const double rate_mult = degraded ? cfg_.degraded_rate_multiplier : 1.0;
-  const double speed_mult = degraded ? cfg_.degraded_speed_multiplier : 1.0;
-
-  const double margin_top = cfg_.margin_top_m * margin_mult;
-  const double margin_bottom = cfg_.margin_bottom_m * margin_mult;
+  ControlOutput out;
+  solve(in, out, &f);
 
-  const double lift_rate_limit = cfg_.base_lift_rate_limit_m_s * rate_mult;
-  const double tilt_rate_limit = cfg_.base_tilt_rate_limit_rad_s * rate_mult;
+  f.time_s = out.time_s;
+  f.cmd = out.cmd;
+  f.safety = out.safety;
+  f.selected_cost = out.selected_cost;
+  f.had_feasible_solution = out.had_feasible_solution;
+  f.candidates_evaluated = out.candidates_evaluated;
+  f.budget_exhausted = out.budget_exhausted;
+  return f;
+}
 
-  // Current geometry
-  f.corners = computeRackCorners2D(in.s_m, in.lift_pos_m, in.pitch_rad, in.tilt_rad, in.env, in.rack, in.forklift);
-  const auto current_clear = computeClearances(f.corners, in.env, margin_top, margin_bottom);
+void Controller::step(const ControlInput& in, ControlOutput& out) { solve(in, out, nullptr); }
 
-  const double s_look = in.s_m + std::max(0.0, cfg_.lookahead_s_m);
-  const auto current_clear_ahead = (cfg_.lookahead_s_m > 1e-9)
-                                      ? computeClearances(computeRackCorners2D(s_look, in.lift_pos_m, in.pitch_rad, in.tilt_rad, in.env, in.rack, in.forklift),
-                                                         in.env, margin_top, margin_bottom)
-                                      : current_clear;
+void Controller::solve(const ControlInput& in, ControlOutput& f, DebugFrame* dbg) {
+  const StepTimer timer;
+  Deadline deadline(cfg_.step_time_budget_us);
 
-  auto worstCaseClearance = [](const ClearanceResult& now, const ClearanceResult& ahead) {
-    ClearanceResult out = now;
+  if (config_dirty_) applyConfig();
+  const StepLimits limits = makeStepLimits(tables_, in);
+  const double dt = limits.dt_s;
+  time_s_ += dt;
+  f.time_s = time_s_;
 
-    if (ahead.clearance_top_m < now.clearance_top_m) {
-      out.clearance_top_m = ahead.clearance_top_m;
-      out.top_worst_point = ahead.top_worst_point;
-    }
-    if (ahead.clearance_bottom_m < now.clearance_bottom_m) {
-      out.clearance_bottom_m = ahead.clearance_bottom_m;
-      out.bottom_worst_point = ahead.bottom_worst_point;
-    }
+  const bool degraded = limits.degraded;
+  const double margin_top = limits.margin_top_m;
+  const double margin_bottom = limits.margin_bottom_m;
 
-    out.worst_point = (out.clearance_top_m < out.clearance_bottom_m) ? out.top_worst_point : out.bottom_worst_point;
-    return out;
-  };
+  cache_.beginStep(in.env, in.rack, in.forklift, cfg_.clearance_cache_across_steps);
+  const auto cache_hits0 = cache_.hits();
+  const auto cache_misses0 = cache_.misses();
 
-  const auto current_clear_worst = (cfg_.lookahead_s_m > 1e-9)
-                                     ? worstCaseClearance(current_clear, current_clear_ahead)
-                                     : current_clear;
-  const double current_clear_top_worst = current_clear_worst.clearance_top_m;
-  const double current_clear_bottom_worst = current_clear_worst.clearance_bottom_m;
+  // Current geometry
+  const CurrentPose pose = evaluateCurrentPose(cache_, in, limits);
+  const auto& current_clear = pose.now;
+  if (dbg) fillPoseDebug(in, *dbg);
+  const double s_look = limits.s_look_m;
 
   // Search candidates
-  const int nL = std::max(3, cfg_.grid_lift_steps);
-  const int nT = std::max(3, cfg_.grid_tilt_steps);
+  const int nL = tables_.grid_lift_steps;
+  const int nT = tables_.grid_tilt_steps;
 
   const double lift0 = in.lift_pos_m;
   const double tilt0 = in.tilt_rad;
 
-  const double Lmin = lift0 - cfg_.search_lift_half_range_m;
-  const double Lmax = lift0 + cfg_.search_lift_half_range_m;
-
-  const double Tmin = tilt0 - cfg_.search_tilt_half_range_rad;
-  const double Tmax = tilt0 + cfg_.search_tilt_half_range_rad;
+  double Lmin = lift0 - cfg_.search_lift_half_range_m;
+  double Lmax = lift0 + cfg_.search_lift_half_range_m;
+
+  double Tmin = tilt0 - cfg_.search_tilt_half_range_rad;
+  double Tmax = tilt0 + cfg_.search_tilt_half_range_rad;
+
+  // Clamp the window to the precomputed feasible bands when they apply; full window otherwise.
+  bool envelope_used = false;
+  if (envelope_ && envelope_->accepts(in.rack, in.forklift, margin_top, margin_bottom)) {
+    const EnvelopeCell* cell = envelope_->lookup(in.s_m, in.pitch_rad);
+    if (cell && cell->anyFeasible()) {
+      const double lo_l = std::max(Lmin, static_cast<double>(cell->lift_lo_m));
+      const double hi_l = std::min(Lmax, static_cast<double>(cell->lift_hi_m));
+      const double lo_t = std::max(Tmin, static_cast<double>(cell->tilt_lo_rad));
+      const double hi_t = std::min(Tmax, static_cast<double>(cell->tilt_hi_rad));
+      if (lo_l <= hi_l && lo_t <= hi_t) {
+        Lmin = lo_l;
+        Lmax = hi_l;
+        Tmin = lo_t;
+        Tmax = hi_t;
+        envelope_used = true;
+      }
+    }
+  }
 
   struct Best {
     bool feasible;
@@ -176,57 +163,358 @@ DebugFrame Controller::step(const ControlInput& in) {
   double best_min_tilt = tilt0;
   ClearanceResult best_min_clr = current_clear;
 
-  for (int i = 0; i < nL; ++i) {
-    const double tL = (nL == 1) ? 0.0 : static_cast<double>(i) / static_cast<double>(nL - 1);
-    const double lift_c = lerp(Lmin, Lmax, tL);
+  const bool use_lookahead = limits.use_lookahead;
+  int candidates_evaluated = 0;
+  int candidates_feasible = 0;
 
-    for (int j = 0; j < nT; ++j) {
-      const double tT = (nT == 1) ? 0.0 : static_cast<double>(j) / static_cast<double>(nT - 1);
-      const double tilt_c = lerp(Tmin, Tmax, tT);
+  auto costAt = [&](double lift_c, double tilt_c, double clearance_mid) {
+    const double lift_rate = (lift_c - lift0) / dt;
+    const double tilt_rate = (tilt_c - tilt0) / dt;
+    const double d_lift_rate = lift_rate - prev_lift_rate_m_s_;
+    const double d_tilt_rate = tilt_rate - prev_tilt_rate_rad_s_;
 
-      const auto corners = computeRackCorners2D(in.s_m, lift_c, in.pitch_rad, tilt_c, in.env, in.rack, in.forklift);
-      const auto clr = computeClearances(corners, in.env, margin_top, margin_bottom);
+    return cfg_.w_center * (clearance_mid * clearance_mid) +
+           cfg_.w_dl * ((lift_c - lift0) * (lift_c - lift0)) +
+           cfg_.w_dt * ((tilt_c - tilt0) * (tilt_c - tilt0)) +
+           cfg_.w_smooth * (d_lift_rate * d_lift_rate + d_tilt_rate * d_tilt_rate);
+  };
+
+  auto candidateCost = [&](double lift_c, double tilt_c, const ClearanceResult& clr_worst) {
+    // Centering: clearance_mid = top - bottom, target is 0
+    return costAt(lift_c, tilt_c, clr_worst.clearance_top_m - clr_worst.clearance_bottom_m);
+  };
+
+  // Folds one candidate (worst case over now/ahead) into best / best_min_*.
+  auto foldCandidate = [&](double lift_c, double tilt_c, const ClearanceResult& clr_worst) {
+    const double min_clear = std::min(clr_worst.clearance_top_m, clr_worst.clearance_bottom_m);
+    if (min_clear > best_min_clear) {
+      best_min_clear = min_clear;
+      best_min_lift = lift_c;
+      best_min_tilt = tilt_c;
+      best_min_clr = clr_worst;
+    }
 
-      ClearanceResult clr_worst = clr;
-      if (cfg_.lookahead_s_m > 1e-9) {
-        const auto corners_a = computeRackCorners2D(s_look, lift_c, in.pitch_rad, tilt_c, in.env, in.rack, in.forklift);
-        const auto clr_a = computeClearances(corners_a, in.env, margin_top, margin_bottom);
+    const bool feasible = (clr_worst.clearance_top_m >= 0.0) && (clr_worst.clearance_bottom_m >= 0.0);
+    if (!feasible) return;
+    ++candidates_feasible;
 
-        clr_worst = worstCaseClearance(clr, clr_a);
+    const double cost = candidateCost(lift_c, tilt_c, clr_worst);
+
+    if (cost < best.cost) {
+      best.feasible = true;
+      best.cost = cost;
+      best.lift = lift_c;
+      best.tilt = tilt_c;
+      best.clr = clr_worst;
+    }
+  };
+
+  // Folds the batched lift_grid_ x tilt_grid_ clearances into best / best_min_*. Instantiated per
+  // lookahead setting so the candidate loop carries no lookahead branch.
+  auto foldGrid = [&](auto lookahead) {
+    constexpr bool kLookahead = decltype(lookahead)::value;
+    for (size_t i = 0; i < lift_grid_.size(); ++i) {
+      for (size_t j = 0; j < tilt_grid_.size(); ++j) {
+        ClearanceResult clr_worst = batch_.at(i, j);
+        if constexpr (kLookahead) {
+          clr_worst = worstCaseClearance(clr_worst, batch_ahead_.at(i, j));
+        }
+        foldCandidate(lift_grid_[i], tilt_grid_[j], clr_worst);
       }
+    }
+  };
+
+  // float32_candidates: bounds from the float pass select every candidate that could change best /
+  // best_min_* or whose feasibility is undecided; those are re-evaluated in double and folded in the
+  // same (lift-major) order as foldGrid, which therefore reaches the same result.
+  int float32_rechecks = 0;
+  auto foldGridFloat = [&](const auto& ceiling, const auto& floor, auto lookahead) {
+    constexpr bool kLookahead = decltype(lookahead)::value;
+    constexpr double tol = kFloatClearanceTolM;
+    const size_t nl = lift_grid_.size();
+    const size_t nt = tilt_grid_.size();
+    auto topAt = [&](size_t k) {
+      float t = batchf_.clearance_top_m[k];
+      if constexpr (kLookahead) t = std::min(t, batchf_ahead_.clearance_top_m[k]);
+      return static_cast<double>(t);
+    };
+    auto bottomAt = [&](size_t k) {
+      float b = batchf_.clearance_bottom_m[k];
+      if constexpr (kLookahead) b = std::min(b, batchf_ahead_.clearance_bottom_m[k]);
+      return static_cast<double>(b);
+    };
+    // Cost bounds: the centering term over |top - bottom| within 2 tol of the float value (it is monotone
+    // in |mid|) plus the clearance-independent terms, which separate into per-lift and per-tilt parts.
+    // The slack covers the rounding difference between this grouping and costAt's.
+    cost_lift_terms_.resize(nl);
+    cost_tilt_terms_.resize(nt);
+    for (size_t i = 0; i < nl; ++i) {
+      const double dl = lift_grid_[i] - lift0;
+      const double d_rate = dl / dt - prev_lift_rate_m_s_;
+      cost_lift_terms_[i] = cfg_.w_dl * (dl * dl) + cfg_.w_smooth * (d_rate * d_rate);
+    }
+    for (size_t j = 0; j < nt; ++j) {
+      const double dtl = tilt_grid_[j] - tilt0;
+      const double d_rate = dtl / dt - prev_tilt_rate_rad_s_;
+      cost_tilt_terms_[j] = cfg_.w_dt * (dtl * dtl) + cfg_.w_smooth * (d_rate * d_rate);
+    }
+    // w_center split by sign (the zero part contributes an exact 0).
+    const double w_grow = std::max(0.0, cfg_.w_center);
+    const double w_shrink = std::min(0.0, cfg_.w_center);
+
+    // One pass in foldGrid's order with running bounds: no candidate costlier than cost_bound can become
+    // best, none with a min clearance below min_clear_bound can become best_min. The bounds only tighten,
+    // so the pending list is a superset of what the final bounds keep.
+    double cost_bound = best.cost;
+    double min_clear_bound = best_min_clear;
+    int surely_feasible = 0;  // counted here unless foldCandidate counts them
+    pending_.clear();
+    pending_.reserve(nl * nt);  // no growth mid-step
+    for (size_t i = 0; i < nl; ++i) {
+      for (size_t j = 0; j < nt; ++j) {
+        const size_t k = batchf_.index(i, j);
+        const double t = topAt(k);
+        const double b = bottomAt(k);
+        const double mn = std::min(t, b);
+        const bool maybe = t > -tol && b > -tol;
+        if (!maybe && mn + tol < min_clear_bound) continue;  // surely infeasible, surely not best_min
+        min_clear_bound = std::max(min_clear_bound, mn - tol);
+
+        PendingCandidate p{static_cast<std::uint32_t>(i * nt + j), -std::numeric_limits<double>::infinity(), mn, false};
+        if (maybe && t >= tol && b >= tol) {
+          const double mid = std::abs(t - b);
+          const double near = std::max(0.0, mid - 2.0 * tol);
+          const double far = mid + 2.0 * tol;
+          const double rest = cost_lift_terms_[i] + cost_tilt_terms_[j];
+          const double slack = 1e-12 * (1.0 + std::abs(rest));
+          const double hi = w_grow * (far * far) + w_shrink * (near * near) + rest + slack;
+          p.cost_lo = w_grow * (near * near) + w_shrink * (far * far) + rest - slack;
+          p.surely_feasible = true;
+          cost_bound = std::min(cost_bound, hi);
+        } else if (!maybe) {
+          p.cost_lo = std::numeric_limits<double>::infinity();
+        }
+        if (p.cost_lo <= cost_bound || mn + tol >= min_clear_bound) {
+          pending_.push_back(p);
+        } else if (p.surely_feasible) {
+          ++surely_feasible;
+        }
+      }
+    }
+
+    // Final bounds.
+    size_t kept = 0;
+    for (const PendingCandidate& p : pending_) {
+      if ((p.cost_lo < std::numeric_limits<double>::infinity() && p.cost_lo <= cost_bound) || p.min_clear + tol >= min_clear_bound) {
+        pending_[kept++] = p;
+      } else if (p.surely_feasible) {
+        ++surely_feasible;
+      }
+    }
+    pending_.resize(kept);
+
+    const double floor_now = floor(in.s_m);
+    const double floor_ahead = kLookahead ? floor(s_look) : 0.0;
+    for (const PendingCandidate& p : pending_) {
+      const double lift_c = lift_grid_[p.key / nt];
+      const double tilt_c = tilt_grid_[p.key % nt];
+      ClearanceResult clr_worst = clearancesWith(
+          rackCornersAtBase(in.s_m, floor_now, lift_c, in.pitch_rad, tilt_c, in.rack, in.forklift), ceiling, floor,
+          margin_top, margin_bottom);
+      if constexpr (kLookahead) {
+        clr_worst = worstCaseClearance(
+            clr_worst, clearancesWith(rackCornersAtBase(s_look, floor_ahead, lift_c, in.pitch_rad, tilt_c, in.rack,
+                                                        in.forklift),
+                                      ceiling, floor, margin_top, margin_bottom));
+      }
+      foldCandidate(lift_c, tilt_c, clr_worst);
+    }
+    candidates_feasible += surely_feasible;
+    float32_rechecks += static_cast<int>(pending_.size());
+  };
+
+  // Evaluates the lift_grid_ x tilt_grid_ candidates (one batched clearance pass per s, with the
+  // environment's surface kinds resolved once) and folds them into best / best_min_*.
+  auto evaluateGrid = [&]() {
+    candidates_evaluated += static_cast<int>(lift_grid_.size() * tilt_grid_.size());
+    visitEnvironment(in.env, [&](const auto& ceiling, const auto& floor) {
+      constexpr bool kFloatBounded = kFloatBoundedSurface<std::decay_t<decltype(ceiling)>> &&
+                                     kFloatBoundedSurface<std::decay_t<decltype(floor)>>;
+      if (kFloatBounded && cfg_.float32_candidates) {
+        clearancesBatchWithF(in.s_m, lift_grid_.data(), lift_grid_.size(), tilt_grid_.data(), tilt_grid_.size(),
+                             in.pitch_rad, ceiling, floor, in.rack, in.forklift, margin_top, margin_bottom, &batchf_);
+        if (use_lookahead) {
+          clearancesBatchWithF(s_look, lift_grid_.data(), lift_grid_.size(), tilt_grid_.data(), tilt_grid_.size(),
+                               in.pitch_rad, ceiling, floor, in.rack, in.forklift, margin_top, margin_bottom,
+                               &batchf_ahead_);
+          foldGridFloat(ceiling, floor, std::true_type{});
+        } else {
+          foldGridFloat(ceiling, floor, std::false_type{});
+        }
+        return;
+      }
+      clearancesBatchWith(in.s_m, lift_grid_.data(), lift_grid_.size(), tilt_grid_.data(), tilt_grid_.size(),
+                          in.pitch_rad, ceiling, floor, in.rack, in.forklift, margin_top, margin_bottom, &batch_);
+      if (use_lookahead) {
+        clearancesBatchWith(s_look, lift_grid_.data(), lift_grid_.size(), tilt_grid_.data(), tilt_grid_.size(),
+                            in.pitch_rad, ceiling, floor, in.rack, in.forklift, margin_top, margin_bottom,
+                            &batch_ahead_);
+        foldGrid(std::true_type{});
+      } else {
+        foldGrid(std::false_type{});
+      }
+    });
+  };
+
+  // reuse_unchanged_input: keep the previous target if it is still feasible (worst case over now/ahead)
+  // instead of searching. Never at STOP, and a change of the current pose's safety level triggers a search.
+  bool reused = false;
+  const SafetyLevel current_level = currentSafetyLevel(cfg_, limits, pose);
+  if (cfg_.reuse_unchanged_input && !degraded && current_level != SafetyLevel::STOP && cache_.geometryUnchanged() &&
+      anchor_.matches(in, current_level, cfg_)) {
+    ++candidates_evaluated;
+    ClearanceResult clr = cache_.evaluate(in.s_m, anchor_lift_target_m_, in.pitch_rad, anchor_tilt_target_rad_, in.env,
+                                          in.rack, in.forklift, margin_top, margin_bottom);
+    if (use_lookahead) {
+      clr = worstCaseClearance(clr, cache_.evaluate(s_look, anchor_lift_target_m_, in.pitch_rad, anchor_tilt_target_rad_,
+                                                    in.env, in.rack, in.forklift, margin_top, margin_bottom));
+    }
+    if (clr.clearance_top_m >= 0.0 && clr.clearance_bottom_m >= 0.0) {
+      ++candidates_feasible;
+      best.feasible = true;
+      best.cost = candidateCost(anchor_lift_target_m_, anchor_tilt_target_rad_, clr);
+      best.lift = anchor_lift_target_m_;
+      best.tilt = anchor_tilt_target_rad_;
+      best.clr = clr;
+      reused = true;
+    }
+  }
 
-      const double min_clear = std::min(clr_worst.clearance_top_m, clr_worst.clearance_bottom_m);
+  // Final grid spacing, used to bracket the local refinement.
+  double cell_lift = (Lmax - Lmin) / static_cast<double>(nL - 1);
+  double cell_tilt = (Tmax - Tmin) / static_cast<double>(nT - 1);
+
+  if (reused) {
+    // Nothing to search.
+  } else if (cfg_.search_mode == SearchMode::CoarseToFine) {
+    // Coarse pass over the whole neighborhood, then per level a window of +/- one cell around the best
+    // feasible cell and around the max-min-clearance cell, each sampled with the same coarse density.
+    const int nC = tables_.coarse_grid_steps;
+    fillAxis(lift_grid_, tables_.coarse_t, Lmin, Lmax);
+    fillAxis(tilt_grid_, tables_.coarse_t, Tmin, Tmax);
+    evaluateGrid();
+
+    double hL = (Lmax - Lmin) / static_cast<double>(nC - 1);
+    double hT = (Tmax - Tmin) / static_cast<double>(nC - 1);
+
+    for (int level = 0; level < cfg_.refine_levels && !deadline.expired(); ++level) {
+      double centers[2][2];
+      int n_centers = 0;
+      if (best.feasible) {
+        centers[n_centers][0] = best.lift;
+        centers[n_centers][1] = best.tilt;
+        ++n_centers;
+      }
+      if (!best.feasible || best_min_lift != best.lift || best_min_tilt != best.tilt) {
+        centers[n_centers][0] = best_min_lift;
+        centers[n_centers][1] = best_min_tilt;
+        ++n_centers;
+      }
+
+      for (int c = 0; c < n_centers && !deadline.expired(); ++c) {
+        fillAxis(lift_grid_, tables_.coarse_t, std::max(Lmin, centers[c][0] - hL), std::min(Lmax, centers[c][0] + hL));
+        fillAxis(tilt_grid_, tables_.coarse_t, std::max(Tmin, centers[c][1] - hT), std::min(Tmax, centers[c][1] + hT));
+        evaluateGrid();
+      }
+
+      hL = 2.0 * hL / static_cast<double>(nC - 1);
+      hT = 2.0 * hT / static_cast<double>(nC - 1);
+    }
+    cell_lift = hL;
+    cell_tilt = hT;
+  } else {
+    fillAxis(lift_grid_, tables_.grid_lift_t, Lmin, Lmax);
+    fillAxis(tilt_grid_, tables_.grid_tilt_t, Tmin, Tmax);
+    evaluateGrid();
+  }
+
+  if (!reused && cfg_.local_refine_iterations > 0) {
+    // One pose (worst case over now/ahead), folded into best / best_min_* like a grid candidate.
+    // Returns the line-search objective: cost (+inf if infeasible), or -min clearance while no
+    // feasible pose is known.
+    auto probe = [&](double lift_c, double tilt_c, bool seek_feasible) {
+      ++candidates_evaluated;
+      ClearanceResult clr = cache_.evaluate(in.s_m, lift_c, in.pitch_rad, tilt_c, in.env, in.rack, in.forklift,
+                                            margin_top, margin_bottom);
+      if (use_lookahead) {
+        clr = worstCaseClearance(clr, cache_.evaluate(s_look, lift_c, in.pitch_rad, tilt_c, in.env, in.rack,
+                                                      in.forklift, margin_top, margin_bottom));
+      }
+      const double min_clear = std::min(clr.clearance_top_m, clr.clearance_bottom_m);
       if (min_clear > best_min_clear) {
         best_min_clear = min_clear;
         best_min_lift = lift_c;
         best_min_tilt = tilt_c;
-        best_min_clr = clr_worst;
+        best_min_clr = clr;
       }
-
-      const bool feasible = (clr_worst.clearance_top_m >= 0.0) && (clr_worst.clearance_bottom_m >= 0.0);
-      if (!feasible) continue;
-
-      // Centering: clearance_mid = top - bottom, target is 0
-      const double clearance_mid = clr_worst.clearance_top_m - clr_worst.clearance_bottom_m;
-
-      const double lift_rate = (lift_c - lift0) / dt;
-      const double tilt_rate = (tilt_c - tilt0) / dt;
-      const double d_lift_rate = lift_rate - prev_lift_rate_m_s_;
-      const double d_tilt_rate = tilt_rate - prev_tilt_rate_rad_s_;
-
-      const double cost =
-          cfg_.w_center * (clearance_mid * clearance_mid) +
-          cfg_.w_dl * ((lift_c - lift0) * (lift_c - lift0)) +
-          cfg_.w_dt * ((tilt_c - tilt0) * (tilt_c - tilt0)) +
-          cfg_.w_smooth * (d_lift_rate * d_lift_rate + d_tilt_rate * d_tilt_rate);
-
-      if (cost < best.cost) {
-        best.feasible = true;
-        best.cost = cost;
-        best.lift = lift_c;
-        best.tilt = tilt_c;
-        best.clr = clr_worst;
+      double cost = std::numeric_limits<double>::infinity();
+      if (clr.clearance_top_m >= 0.0 && clr.clearance_bottom_m >= 0.0) {
+        ++candidates_feasible;
+        cost = candidateCost(lift_c, tilt_c, clr);
+        if (cost < best.cost) {
+          best.feasible = true;
+          best.cost = cost;
+          best.lift = lift_c;
+          best.tilt = tilt_c;
+          best.clr = clr;
+        }
+      }
+      return seek_feasible ? -min_clear : cost;
+    };
+
+    // Golden-section search over pose = (lift_c, tilt_c) + t * (d_lift, d_tilt), t in [-1, 1], with the
+    // pose clamped to the search box.
+    auto lineSearch = [&](double lift_c, double tilt_c, double d_lift, double d_tilt, bool seek_feasible) {
+      constexpr double kInvPhi = 0.6180339887498949;
+      auto at = [&](double t) {
+        return probe(clamp(lift_c + t * d_lift, Lmin, Lmax), clamp(tilt_c + t * d_tilt, Tmin, Tmax), seek_feasible);
+      };
+      double a = -1.0, b = 1.0;
+      double x1 = b - kInvPhi * (b - a);
+      double x2 = a + kInvPhi * (b - a);
+      double f1 = at(x1);
+      double f2 = at(x2);
+      for (int k = 2; k < cfg_.local_refine_evals; ++k) {
+        if (f1 < f2) {
+          b = x2;
+          x2 = x1;
+          f2 = f1;
+          x1 = b - kInvPhi * (b - a);
+          f1 = at(x1);
+        } else {
+          a = x1;
+          x1 = x2;
+          f1 = f2;
+          x2 = a + kInvPhi * (b - a);
+          f2 = at(x2);
+        }
+      }
+    };
+
+    // Rounds of line searches along lift, tilt and both diagonals (clearances couple lift and tilt, so
+    // the feasible set is often a thin diagonal band) around the incumbent, each over +/- one cell.
+    // Until a feasible pose is known the searches climb the min clearance from the best-min cell;
+    // afterwards they minimize the cost from the best feasible pose.
+    static constexpr double kDirections[4][2] = {{1.0, 0.0}, {0.0, 1.0}, {1.0, 1.0}, {1.0, -1.0}};
+    for (int it = 0; it < cfg_.local_refine_iterations && !deadline.expired(); ++it) {
+      for (const auto& d : kDirections) {
+        if (deadline.expired()) break;
+        const bool seek = !best.feasible;
+        lineSearch(seek ? best_min_lift : best.lift, seek ? best_min_tilt : best.tilt, d[0] * cell_lift, d[1] * cell_tilt,
+                   seek);
       }
+      cell_lift *= 0.5;
+      cell_tilt *= 0.5;
     }
   }
 
@@ -236,7 +524,6 @@ DebugFrame Controller::step(const ControlInput& in) {
   bool had_feasible = false;
 
   SafetyCode search_code = SafetyCode::None;
-  std::string search_msg;
 
   if (best.feasible) {
     lift_star = best.lift;
@@ -249,47 +536,41 @@ DebugFrame Controller::step(const ControlInput& in) {
     star_clr = best_min_clr;
     had_feasible = false;
     search_code = SafetyCode::NoFeasibleSolution;
-    search_msg = "No feasible (lift,tilt) in neighborhood";
   }
 
-  // Compose command: targets are positions, rate limits are provided.
-  f.cmd.lift_target_m = lift_star;
-  f.cmd.tilt_target_rad = tilt_star;
-  f.cmd.lift_rate_limit_m_s = lift_rate_limit;
-  f.cmd.tilt_rate_limit_rad_s = tilt_rate_limit;
-
-  // Simple speed policy: reduce as min clearance approaches 0, and when pitch_rate is high.
-  const double min_clear = std::min(current_clear_top_worst, current_clear_bottom_worst);
-  const double clearance_factor = clamp(min_clear / cfg_.warn_threshold_m, 0.0, 1.0);
-  const double pitch_rate_factor = clamp(1.0 - (std::abs(in.pitch_rate_rad_s) / (2.0 * cfg_.pitch_rate_jitter_threshold_rad_s)), 0.2, 1.0);
-  const double base_speed = cfg_.base_speed_limit_m_s * speed_mult;
-  double speed = base_speed * std::min(clearance_factor, pitch_rate_factor);
-  if (min_clear >= (cfg_.hard_threshold_m - kClearanceEpsilonM)) {
-    speed = std::max(speed, cfg_.min_speed_limit_m_s * speed_mult * pitch_rate_factor);
-  } else {
-    speed = 0.0;
+  if (!reused) {
+    anchor_.valid = false;
+    if (!degraded && had_feasible) {
+      anchor_.set(in, current_level);
+      anchor_lift_target_m_ = lift_star;
+      anchor_tilt_target_rad_ = tilt_star;
+    }
   }
-  f.cmd.speed_limit_m_s = speed;
+
+  composeCommand(cfg_, limits, in, pose, lift_star, tilt_star, search_code, f);
 
   f.had_feasible_solution = had_feasible;
   f.selected_cost = best.feasible ? best.cost : 0.0;
-
-  // Safety status
-  if (degraded) {
-    f.safety = makeSafety(cfg_, current_clear_top_worst, current_clear_bottom_worst, current_clear_worst.worst_point,
-                          true, degraded_code, degraded_msg);
-  } else {
-    SafetyCode code = (search_code != SafetyCode::None) ? search_code : SafetyCode::None;
-    std::string msg = (!search_msg.empty()) ? search_msg : std::string{};
-    f.safety = makeSafety(cfg_, current_clear_top_worst, current_clear_bottom_worst, current_clear_worst.worst_point,
-                          false, code, msg);
+  f.candidates_evaluated = candidates_evaluated;
+  f.budget_exhausted = deadline.hit();
+  if (dbg) {
+    dbg->clearance_cache_hits = static_cast<int>(cache_.hits() - cache_hits0);
+    dbg->clearance_cache_misses = static_cast<int>(cache_.misses() - cache_misses0);
+    dbg->envelope_used = envelope_used && !reused;
+    dbg->float32_rechecks = float32_rechecks;
+    dbg->search_reused = reused;
   }
 
   // Update smoothing memory based on selected target (even if infeasible: still stabilize).
-  prev_lift_rate_m_s_ = clamp((lift_star - lift0) / dt, -lift_rate_limit, lift_rate_limit);
-  prev_tilt_rate_rad_s_ = clamp((tilt_star - tilt0) / dt, -tilt_rate_limit, tilt_rate_limit);
-
-  return f;
+  prev_lift_rate_m_s_ = smoothedRate(lift_star, lift0, dt, limits.lift_rate_limit_m_s);
+  prev_tilt_rate_rad_s_ = smoothedRate(tilt_star, tilt0, dt, limits.tilt_rate_limit_rad_s);
+
+  StepMetrics m;
+  m.candidates_evaluated = candidates_evaluated;
+  m.candidates_feasible = candidates_feasible;
+  m.budget_exhausted = deadline.hit();
+  m.latency_ns = timer.elapsedNs();
+  if (!warming_up_) instr_.record(m);
 }
 
 }  // namespace tlf
@@ -0,0 +1,57 @@
+#include "controller/ControllerFleet.hpp"
+
+#include <algorithm>
+
+namespace tlf {
+
+ControllerFleet::ControllerFleet(ControllerKind kind, const ControllerConfig& cfg, std::size_t trucks, int threads)
+    : inputs_(trucks), outputs_(trucks), commands_(trucks) {
+  controllers_.reserve(trucks);
+  for (std::size_t i = 0; i < trucks; ++i) controllers_.push_back(makeController(kind, cfg));
+  const int n = std::min(std::max(1, threads), static_cast<int>(std::max<std::size_t>(1, trucks)));
+  if (n > 1) pool_ = std::make_unique<ThreadPool>(n);
+}
+
+std::size_t ControllerFleet::addSite(EnvironmentGeometry env) {
+  sites_.push_back(std::move(env));
+  return sites_.size() - 1;
+}
+
+void ControllerFleet::assignSite(std::size_t truck, std::size_t site) { inputs_[truck].env = sites_[site]; }
+
+void ControllerFleet::step() { stepFrom(inputs_.data()); }
+
+void ControllerFleet::step(const ControlInput* inputs) { stepFrom(inputs); }
+
+void ControllerFleet::stepFrom(const ControlInput* inputs) {
+  auto stepTruck = [&](int i) {
+    const auto k = static_cast<std::size_t>(i);
+    controllers_[k]->step(inputs[k], outputs_[k]);
+    commands_[k] = outputs_[k].cmd;
+  };
+  const int n = static_cast<int>(controllers_.size());
+  if (pool_) {
+    pool_->parallelFor(n, stepTruck);
+  } else {
+    for (int i = 0; i < n; ++i) stepTruck(i);
+  }
+}
+
+void ControllerFleet::reset() {
+  for (auto& c : controllers_) c->reset();
+}
+
+void ControllerFleet::warmup() {
+  auto warmTruck = [&](int i) {
+    const auto k = static_cast<std::size_t>(i);
+    controllers_[k]->warmup(inputs_[k]);
+  };
+  const int n = static_cast<int>(controllers_.size());
+  if (pool_) {
+    pool_->parallelFor(n, warmTruck);
+  } else {
+    for (int i = 0; i < n; ++i) warmTruck(i);
+  }
+}
+
+}  // namespace tlf
@@ -4,176 +4,188 @@
 #include <cmath>
 #include <cstddef>
 #include <limits>
+#include <numeric>
 #include <string>
 #include <vector>
 
+#include "controller/SearchCore.hpp"
 #include "model/Geometry.hpp"
+#include "utils/Deadline.hpp"
 
 namespace tlf {
 
-static constexpr double kClearanceEpsilonM = 5e-4;
-
-static bool finiteAll(const ControlInput& in) {
-  auto finite = [](double v) { return std::isfinite(v); };
-  return finite(in.dt_s) && finite(in.pitch_rad) && finite(in.pitch_rate_rad_s) && finite(in.s_m) &&
-         finite(in.lift_pos_m) && finite(in.tilt_rad) && finite(in.rack.height_m) && finite(in.rack.length_m) &&
-         finite(in.rack.mount_offset_m.x) && finite(in.rack.mount_offset_m.z);
-}
-
 static double clamp(double v, double lo, double hi) {
   return std::max(lo, std::min(hi, v));
 }
 
-static SafetyStatus makeSafety(const ControllerConfig& cfg,
-                              double clearance_top_m,
-                              double clearance_bottom_m,
-                              CornerId worst,
-                              bool degraded,
-                              SafetyCode code_override = SafetyCode::None,
-                              std::string message_override = {}) {
-  SafetyStatus s;
-  s.clearance_top_m = clearance_top_m;
-  s.clearance_bottom_m = clearance_bottom_m;
-  s.worst_point = worst;
-
-  if (degraded) {
-    s.level = SafetyLevel::DEGRADED;
-    s.code = (code_override == SafetyCode::None) ? SafetyCode::InputInvalid : code_override;
-    s.message = message_override.empty() ? "DEGRADED" : message_override;
-    return s;
-  }
+ControllerMPC::ControllerMPC(ControllerConfig cfg) : cfg_(cfg) { applyConfig(); }
 
-  const double min_clear = std::min(clearance_top_m, clearance_bottom_m);
-  if (min_clear < (cfg.hard_threshold_m - kClearanceEpsilonM)) {
-    s.level = SafetyLevel::STOP;
-    s.code = (code_override == SafetyCode::None) ? SafetyCode::ClearanceHardViolated : code_override;
-    s.message = message_override.empty() ? "STOP: hard clearance violated" : message_override;
-    return s;
-  }
-
-  if (min_clear < cfg.warn_threshold_m) {
-    s.level = SafetyLevel::WARN;
-    s.code = (code_override == SafetyCode::None) ? SafetyCode::ClearanceSoftNear : code_override;
-    s.message = message_override.empty() ? "WARN: clearance near boundary" : message_override;
-    return s;
-  }
-
-  s.level = SafetyLevel::OK;
-  s.code = SafetyCode::None;
-  s.message = "OK";
-
-  if (code_override != SafetyCode::None) {
-    s.code = code_override;
-    if (!message_override.empty()) s.message = message_override;
-  }
-  return s;
+bool ControllerMPC::configure(const ControllerConfig& cfg, std::string* error) {
+  if (!validateConfig(cfg, error)) return false;
+  cfg_ = cfg;
+  applyConfig();
+  return true;
 }
 
-ControllerMPC::ControllerMPC(ControllerConfig cfg) : cfg_(cfg) {}
+void ControllerMPC::warmup(const ControlInput& in) {
+  warming_up_ = true;
+  ControlOutput out;
+  for (int i = 0; i < kWarmupSteps; ++i) solve(in, out, nullptr);
+  (void)step(in);  // DebugFrame path
+  ControlInput degraded = in;
+  degraded.inputs_valid = false;
+  solve(degraded, out, nullptr);
+  warming_up_ = false;
+  reset();
+}
 
 void ControllerMPC::reset() {
   time_s_ = 0.0;
   prev_lift_rate_m_s_ = 0.0;
   prev_tilt_rate_rad_s_ = 0.0;
+  prev_plan_len_ = 0;
+  cache_.clear();
+  anchor_.valid = false;
 }
 
-struct SeqNode {
-  double cost{0.0};
-  // predicted state
-  double s_m{0.0};
-  double lift_m{0.0};
-  double tilt_rad{0.0};
-  double last_lift_rate{0.0};
-  double last_tilt_rate{0.0};
-  // first action (to output)
-  double u0_lift_rate{0.0};
-  double u0_tilt_rate{0.0};
-  bool has_u0{false};
-};
-
-DebugFrame ControllerMPC::step(const ControlInput& in) {
-  DebugFrame f;
-  f.in = in;
+void ControllerMPC::applyConfig() {
+  makeConfigTables(cfg_, &tables_);
+  static constexpr double kRateFractions[kActionsPerAxis] = {-1.0, -0.5, 0.0, 0.5, 1.0};
+  const ConfigTables::Limits* limits[2] = {&tables_.nominal, &tables_.degraded};
+  for (int d = 0; d < 2; ++d) {
+    for (int i = 0; i < kActionsPerAxis; ++i) {
+      lift_rates_[d][i] = kRateFractions[i] * limits[d]->lift_rate_limit_m_s;
+      tilt_rates_[d][i] = kRateFractions[i] * limits[d]->tilt_rate_limit_rad_s;
+    }
+  }
+  cache_.configure(static_cast<size_t>(std::max(0, cfg_.clearance_cache_capacity)), cfg_.clearance_cache_quantum_m,
+                   cfg_.clearance_cache_quantum_rad);
+  ensureWorkspace();
+  anchor_.valid = false;  // solved under the previous config
+  config_dirty_ = false;
+}
 
-  const double dt = (in.dt_s > 1e-6 && std::isfinite(in.dt_s)) ? in.dt_s : 0.02;
-  time_s_ += dt;
-  f.time_s = time_s_;
+void ControllerMPC::ensureWorkspace() {
+  const int beam = std::max(5, cfg_.mpc_beam_width);
+  const int nL = tables_.grid_lift_steps;
+  const int nT = tables_.grid_tilt_steps;
+  const int threads = std::max(1, cfg_.mpc_num_threads);
+  const int H = std::max(1, cfg_.mpc_horizon_steps);
+  const bool dedup = cfg_.mpc_dedup_states;
+  if (beam == ws_beam_ && threads == ws_threads_ && nL == ws_grid_lift_steps_ && nT == ws_grid_tilt_steps_ &&
+      (!dedup || (ws_dedup_ && H == ws_horizon_))) {
+    ws_dedup_ = dedup;
+    return;
+  }
 
-  bool degraded = false;
-  SafetyCode degraded_code = SafetyCode::None;
-  std::string degraded_msg;
-
-  if (!in.inputs_valid || !finiteAll(in) || !(dt > 0.0)) {
-    degraded = true;
-    degraded_code = SafetyCode::InputInvalid;
-    degraded_msg = "Invalid inputs";
-  } else if (std::abs(in.pitch_rate_rad_s) > cfg_.pitch_rate_jitter_threshold_rad_s) {
-    degraded = true;
-    degraded_code = SafetyCode::PitchJitter;
-    degraded_msg = "Pitch rate jitter";
+  const size_t children = static_cast<size_t>(beam) * static_cast<size_t>(kActionCount);
+  frontier_.clear();
+  next_.clear();
+  frontier_.reserve(children);
+  next_.reserve(children);
+
+  if (threads > 1) {
+    if (!pool_ || pool_->size() != threads) pool_ = std::make_unique<ThreadPool>(threads);
+    const size_t per_chunk = static_cast<size_t>((beam + threads - 1) / threads) * static_cast<size_t>(kActionCount);
+    chunk_children_.resize(static_cast<size_t>(threads));
+    for (auto& buf : chunk_children_) {
+      buf.clear();
+      buf.reserve(per_chunk);
+    }
+    chunk_evaluated_.assign(static_cast<size_t>(threads), 0);
+  } else {
+    pool_.reset();
+    chunk_children_.clear();
+    chunk_evaluated_.clear();
   }
 
-  const double margin_mult = degraded ? cfg_.degraded_margin_multiplier : 1.0;
-  const double rate_mult = degraded ? cfg_.degraded_rate_multiplier : 1.0;
-  const double speed_mult = degraded ? cfg_.degraded_speed_multiplier : 1.0;
+  if (dedup) {
+    // Lattice coordinates move by at most 2 per level.
+    lattice_half_ = 2 * H;
+    const size_t dim = static_cast<size_t>(2 * lattice_half_ + 1);
+    lattice_.assign(dim * dim, LatticeCell{});
+    lattice_points_.clear();
+    lattice_points_.reserve(dim * dim);
+    lattice_epoch_ = 0;
+  }
 
-  const double margin_top = cfg_.margin_top_m * margin_mult;
-  const double margin_bottom = cfg_.margin_bottom_m * margin_mult;
+  expand_order_.reserve(static_cast<size_t>(beam));
+  child_begin_.reserve(static_cast<size_t>(beam));
+  child_counts_.reserve(static_cast<size_t>(beam));
+  regrouped_.clear();
+  regrouped_.reserve(children);
+
+  lift_grid_.reserve(static_cast<size_t>(nL));
+  tilt_grid_.reserve(static_cast<size_t>(nT));
+  batch_.resize(static_cast<size_t>(nL), static_cast<size_t>(nT));
+  batch_ahead_.resize(static_cast<size_t>(nL), static_cast<size_t>(nT));
+
+  ws_beam_ = beam;
+  ws_threads_ = threads;
+  ws_horizon_ = H;
+  ws_dedup_ = dedup;
+  ws_grid_lift_steps_ = nL;
+  ws_grid_tilt_steps_ = nT;
+}
 
-  const double lift_rate_limit = cfg_.base_lift_rate_limit_m_s * rate_mult;
-  const double tilt_rate_limit = cfg_.base_tilt_rate_limit_rad_s * rate_mult;
+DebugFrame ControllerMPC::step(const ControlInput& in) {
+  DebugFrame f;
+  f.in = in;
 
-  // Current geometry
-  f.corners = computeRackCorners2D(in.s_m, in.lift_pos_m, in.pitch_rad, in.tilt_rad, in.env, in.rack, in.forklift);
-  const auto current_clear = computeClearances(f.corners, in.env, margin_top, margin_bottom);
+  ControlOutput out;
+  solve(in, out, &f);
+
+  f.time_s = out.time_s;
+  f.cmd = out.cmd;
+  f.safety = out.safety;
+  f.selected_cost = out.selected_cost;
+  f.had_feasible_solution = out.had_feasible_solution;
+  f.candidates_evaluated = out.candidates_evaluated;
+  f.warm_start_used = out.warm_start_used;
+  f.budget_exhausted = out.budget_exhausted;
+  return f;
+}
 
-  // Optional: preserve existing single-step lookahead semantics for safety/speed reporting.
-  const double s_look = in.s_m + std::max(0.0, cfg_.lookahead_s_m);
-  const auto current_clear_ahead = (cfg_.lookahead_s_m > 1e-9)
-                                      ? computeClearances(
-                                            computeRackCorners2D(s_look, in.lift_pos_m, in.pitch_rad, in.tilt_rad, in.env, in.rack, in.forklift),
-                                            in.env, margin_top, margin_bottom)
-                                      : current_clear;
+void ControllerMPC::step(const ControlInput& in, ControlOutput& out) { solve(in, out, nullptr); }
 
-  auto worstCaseClearance = [](const ClearanceResult& now, const ClearanceResult& ahead) {
-    ClearanceResult out = now;
+void ControllerMPC::solve(const ControlInput& in, ControlOutput& f, DebugFrame* dbg) {
+  const StepTimer timer;
+  Deadline deadline(cfg_.step_time_budget_us);
 
-    if (ahead.clearance_top_m < now.clearance_top_m) {
-      out.clearance_top_m = ahead.clearance_top_m;
-      out.top_worst_point = ahead.top_worst_point;
-    }
-    if (ahead.clearance_bottom_m < now.clearance_bottom_m) {
-      out.clearance_bottom_m = ahead.clearance_bottom_m;
-      out.bottom_worst_point = ahead.bottom_worst_point;
-    }
+  if (config_dirty_) applyConfig();
+  const StepLimits limits = makeStepLimits(tables_, in);
+  const double dt = limits.dt_s;
+  time_s_ += dt;
+  f.time_s = time_s_;
 
-    out.worst_point = (out.clearance_top_m < out.clearance_bottom_m) ? out.top_worst_point : out.bottom_worst_point;
-    return out;
-  };
+  const bool degraded = limits.degraded;
+  const double margin_top = limits.margin_top_m;
+  const double margin_bottom = limits.margin_bottom_m;
+  const double lift_rate_limit = limits.lift_rate_limit_m_s;
+  const double tilt_rate_limit = limits.tilt_rate_limit_rad_s;
 
-  const auto current_clear_worst = (cfg_.lookahead_s_m > 1e-9)
-                                     ? worstCaseClearance(current_clear, current_clear_ahead)
-                                     : current_clear;
+  cache_.beginStep(in.env, in.rack, in.forklift, cfg_.clearance_cache_across_steps);
+  const auto cache_hits0 = cache_.hits();
+  const auto cache_misses0 = cache_.misses();
 
-  const double current_clear_top_worst = current_clear_worst.clearance_top_m;
-  const double current_clear_bottom_worst = current_clear_worst.clearance_bottom_m;
+  // Current geometry; the lookahead worst case is used for safety/speed reporting.
+  const CurrentPose pose = evaluateCurrentPose(cache_, in, limits);
+  if (dbg) fillPoseDebug(in, *dbg);
 
   // MPC/beam-search parameters
   const int H = std::max(1, cfg_.mpc_horizon_steps);
   const int beam = std::max(5, cfg_.mpc_beam_width);
 
-  // Action set: a small discrete set of rate commands.
+  // Action set: a small discrete set of rate commands (precomputed in applyConfig()).
   // Keep it compact to stay real-time friendly.
-  const double a1 = 1.0;
-  const double a2 = 0.5;
-  const double lift_rates[] = {-a1 * lift_rate_limit, -a2 * lift_rate_limit, 0.0, a2 * lift_rate_limit, a1 * lift_rate_limit};
-  const double tilt_rates[] = {-a1 * tilt_rate_limit, -a2 * tilt_rate_limit, 0.0, a2 * tilt_rate_limit, a1 * tilt_rate_limit};
+  const double* lift_rates = lift_rates_[limits.degraded ? 1 : 0];
+  const double* tilt_rates = tilt_rates_[limits.degraded ? 1 : 0];
 
   const double lift0 = in.lift_pos_m;
   const double tilt0 = in.tilt_rad;
 
   // Predict forward progress (s). If 0, keep s constant.
-  const double assumed_v = std::max(0.0, cfg_.mpc_assumed_forward_speed_m_s) * speed_mult;
+  const double assumed_v = std::max(0.0, cfg_.mpc_assumed_forward_speed_m_s) * limits.speed_mult;
 
   auto pitchAtStep = [&](int k) {
     if (cfg_.mpc_use_pitch_rate_prediction <= 0.0) return in.pitch_rad;
@@ -193,92 +205,329 @@ DebugFrame ControllerMPC::step(const ControlInput& in) {
     return cost_center + cost_mag + cost_smooth;
   };
 
+  // Warm start (receding horizon): seed with the previous best plan shifted by one step (last action
+  // repeated), plus the variants whose first action is a lift/tilt neighbor of the seed's first action.
+  const int plan_len = std::min(H, kMaxWarmStartSteps);
+  n_seeds_ = 0;
+  if (cfg_.mpc_warm_start && prev_plan_len_ > 0) {
+    auto& base = seeds_[0];
+    for (int k = 0; k < plan_len; ++k) {
+      base[static_cast<size_t>(k)] = prev_plan_[static_cast<size_t>(std::min(k + 1, prev_plan_len_ - 1))];
+    }
+    n_seeds_ = 1;
+
+    const int li0 = base[0] / kActionsPerAxis;
+    const int ti0 = base[0] % kActionsPerAxis;
+    const int neighbors[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    for (const auto& d : neighbors) {
+      const int li = li0 + d[0];
+      const int ti = ti0 + d[1];
+      if (li < 0 || li >= kActionsPerAxis || ti < 0 || ti >= kActionsPerAxis) continue;
+      seeds_[static_cast<size_t>(n_seeds_)] = base;
+      seeds_[static_cast<size_t>(n_seeds_)][0] = static_cast<std::uint8_t>(li * kActionsPerAxis + ti);
+      ++n_seeds_;
+    }
+  }
+  const bool warm_start_used = n_seeds_ > 0;
+
+  // A child keeps following seed q while its actions match seeds_[q]; the root fans out to all seeds.
+  auto childSeed = [&](const SeqNode& parent, int k, std::uint8_t action) -> std::int8_t {
+    if (k >= plan_len) return -1;
+    if (k == 0) {
+      for (int q = 0; q < n_seeds_; ++q) {
+        if (seeds_[static_cast<size_t>(q)][0] == action) return static_cast<std::int8_t>(q);
+      }
+      return -1;
+    }
+    if (parent.seed < 0) return -1;
+    return (seeds_[static_cast<size_t>(parent.seed)][static_cast<size_t>(k)] == action) ? parent.seed : std::int8_t{-1};
+  };
+
   // Beam search over sequences of rate commands.
-  std::vector<SeqNode> frontier;
-  frontier.reserve(static_cast<size_t>(beam));
-  frontier.push_back(SeqNode{0.0, in.s_m, lift0, tilt0, prev_lift_rate_m_s_, prev_tilt_rate_rad_s_, 0.0, 0.0, false});
+  frontier_.clear();
+  frontier_.push_back(SeqNode{0.0, in.s_m, lift0, tilt0, prev_lift_rate_m_s_, prev_tilt_rate_rad_s_, 0.0, 0.0, false});
+  int levels_completed = 0;
+
+  int candidates_evaluated = 0;
 
   bool any_feasible_sequence = false;
   SeqNode best_node;
   best_node.cost = std::numeric_limits<double>::infinity();
 
-  for (int k = 0; k < H; ++k) {
-    std::vector<SeqNode> next;
-    next.reserve(static_cast<size_t>(beam) * 5);
+  // Clearance of one predicted state (plus the optional spatial lookahead at s + lookahead).
+  // feasible == false means the state is hard-pruned.
+  struct StageEval {
+    double clearance_top_m;
+    double clearance_bottom_m;
+    bool feasible;
+  };
+  // The cache is single-threaded, so parallel expansion evaluates directly.
+  const bool use_cache = cache_.enabled() && !pool_;
+  auto clearanceAt = [&](double s, double lift, double pitch, double tilt) {
+    if (use_cache) return cache_.evaluate(s, lift, pitch, tilt, in.env, in.rack, in.forklift, margin_top, margin_bottom);
+    return computeClearances(computeRackCorners2D(s, lift, pitch, tilt, in.env, in.rack, in.forklift), in.env, margin_top, margin_bottom);
+  };
+  auto evaluateState = [&](int k, double s_next, double lift_next, double tilt_next) -> StageEval {
+    const double pitch_k = pitchAtStep(k + 1);
 
-    for (const auto& node : frontier) {
-      for (double lr : lift_rates) {
-        for (double tr : tilt_rates) {
-          SeqNode child = node;
+    // Check constraints at the next predicted state
+    const auto clr = clearanceAt(s_next, lift_next, pitch_k, tilt_next);
 
-          // Apply dynamics
-          const double lift_next = child.lift_m + lr * dt;
-          const double tilt_next = child.tilt_rad + tr * dt;
-          const double s_next = child.s_m + assumed_v * dt;
+    if (!(clr.clearance_top_m >= 0.0) || !(clr.clearance_bottom_m >= 0.0)) {
+      return {clr.clearance_top_m, clr.clearance_bottom_m, false};  // hard prune
+    }
 
-          const double pitch_k = pitchAtStep(k + 1);
+    // Optional spatial lookahead at s+lookahead (same tilt/lift), making it slightly more conservative.
+    if (cfg_.lookahead_s_m > 1e-9) {
+      const double s_a = s_next + cfg_.lookahead_s_m;
+      const auto clr_a = clearanceAt(s_a, lift_next, pitch_k, tilt_next);
+      const double top_w = std::min(clr.clearance_top_m, clr_a.clearance_top_m);
+      const double bot_w = std::min(clr.clearance_bottom_m, clr_a.clearance_bottom_m);
+      return {top_w, bot_w, (top_w >= 0.0) && (bot_w >= 0.0)};
+    }
+    return {clr.clearance_top_m, clr.clearance_bottom_m, true};
+  };
 
-          // Check constraints at the next predicted state
-          const auto corners = computeRackCorners2D(s_next, lift_next, pitch_k, tilt_next, in.env, in.rack, in.forklift);
-          const auto clr = computeClearances(corners, in.env, margin_top, margin_bottom);
+  // reuse_unchanged_input: keep the previous plan if its first step is still feasible from the current
+  // state instead of searching. Never at STOP, and a change of the current pose's safety level triggers a search.
+  bool reused = false;
+  const SafetyLevel current_level = currentSafetyLevel(cfg_, limits, pose);
+  if (cfg_.reuse_unchanged_input && !degraded && current_level != SafetyLevel::STOP && cache_.geometryUnchanged() &&
+      anchor_.matches(in, current_level, cfg_)) {
+    ++candidates_evaluated;
+    reused = evaluateState(0, in.s_m + assumed_v * dt, lift0 + anchor_node_.u0_lift_rate * dt,
+                           tilt0 + anchor_node_.u0_tilt_rate * dt)
+                 .feasible;
+  }
 
-          if (!(clr.clearance_top_m >= 0.0) || !(clr.clearance_bottom_m >= 0.0)) {
-            continue;  // hard prune
-          }
+  // Duplicate-state pruning: every action moves lift/tilt by an integer number of lattice steps, so
+  // snapping the predicted state onto the lattice makes converging sequences land on the same point.
+  const bool dedup = cfg_.mpc_dedup_states;
+  const double lift_q_step = 0.5 * lift_rate_limit * dt;
+  const double tilt_q_step = 0.5 * tilt_rate_limit * dt;
+  const int lattice_dim = 2 * lattice_half_ + 1;
+  auto cellAt = [&](int lift_q, int tilt_q) -> LatticeCell& {
+    return lattice_[static_cast<size_t>((lift_q + lattice_half_) * lattice_dim + (tilt_q + lattice_half_))];
+  };
+  int nodes_expanded = 0;
+  int nodes_deduplicated = 0;
+  int parents_expanded = 0;
+  int nodes_beam_cut = 0;
+
+  // Expands one frontier node into its feasible children (appended to out in action order).
+  // Reads only shared immutable state, so disjoint frontier ranges can be expanded concurrently.
+  auto expandNode = [&](const SeqNode& node, int k, std::vector<SeqNode>& out, int& evaluated) {
+    for (int li = 0; li < kActionsPerAxis; ++li) {
+      const double lr = lift_rates[li];
+      for (int ti = 0; ti < kActionsPerAxis; ++ti) {
+        const double tr = tilt_rates[ti];
+        const auto action = static_cast<std::uint8_t>(li * kActionsPerAxis + ti);
+        SeqNode child = node;
+
+        // Apply dynamics
+        double lift_next = 0.0;
+        double tilt_next = 0.0;
+        const double s_next = child.s_m + assumed_v * dt;
+
+        StageEval e;
+        if (dedup) {
+          child.lift_q = static_cast<std::int16_t>(node.lift_q + kLatticeMoves[li]);
+          child.tilt_q = static_cast<std::int16_t>(node.tilt_q + kLatticeMoves[ti]);
+          lift_next = lift0 + lift_q_step * static_cast<double>(child.lift_q);
+          tilt_next = tilt0 + tilt_q_step * static_cast<double>(child.tilt_q);
+          const LatticeCell& cell = cellAt(child.lift_q, child.tilt_q);  // evaluated before expansion
+          e = {cell.clearance_top_m, cell.clearance_bottom_m, cell.feasible};
+        } else {
+          lift_next = child.lift_m + lr * dt;
+          tilt_next = child.tilt_rad + tr * dt;
+          e = evaluateState(k, s_next, lift_next, tilt_next);
+          ++evaluated;
+        }
+        if (!e.feasible) continue;
 
-          // Optional spatial lookahead at s+lookahead (same tilt/lift), making it slightly more conservative.
-          if (cfg_.lookahead_s_m > 1e-9) {
-            const double s_a = s_next + cfg_.lookahead_s_m;
-            const auto corners_a = computeRackCorners2D(s_a, lift_next, pitch_k, tilt_next, in.env, in.rack, in.forklift);
-            const auto clr_a = computeClearances(corners_a, in.env, margin_top, margin_bottom);
-            const double top_w = std::min(clr.clearance_top_m, clr_a.clearance_top_m);
-            const double bot_w = std::min(clr.clearance_bottom_m, clr_a.clearance_bottom_m);
-            if (!(top_w >= 0.0) || !(bot_w >= 0.0)) continue;
-
-            const double cost = stageCost(top_w, bot_w, lift_next, tilt_next, lr, tr, child.last_lift_rate, child.last_tilt_rate);
-            child.cost += cost;
-          } else {
-            const double cost = stageCost(clr.clearance_top_m, clr.clearance_bottom_m, lift_next, tilt_next, lr, tr, child.last_lift_rate, child.last_tilt_rate);
-            child.cost += cost;
-          }
+        const double cost = stageCost(e.clearance_top_m, e.clearance_bottom_m, lift_next, tilt_next, lr, tr, child.last_lift_rate, child.last_tilt_rate);
+        child.cost += cost;
+
+        child.s_m = s_next;
+        child.lift_m = lift_next;
+        child.tilt_rad = tilt_next;
+        child.last_lift_rate = lr;
+        child.last_tilt_rate = tr;
+
+        if (!child.has_u0) {
+          child.u0_lift_rate = lr;
+          child.u0_tilt_rate = tr;
+          child.has_u0 = true;
+        }
+        if (k < kMaxWarmStartSteps) child.actions |= static_cast<std::uint64_t>(action) << (5 * k);
+        child.seed = childSeed(node, k, action);
+
+        out.push_back(child);
+      }
+    }
+  };
+
+  const int levels = reused ? 0 : H;
+  for (int k = 0; k < levels; ++k) {
+    // step_time_budget_us: the first level always completes.
+    if (k > 0 && deadline.expired()) break;
+    next_.clear();
 
-          child.s_m = s_next;
-          child.lift_m = lift_next;
-          child.tilt_rad = tilt_next;
-          child.last_lift_rate = lr;
-          child.last_tilt_rate = tr;
+    const int n_front = static_cast<int>(frontier_.size());
 
-          if (!child.has_u0) {
-            child.u0_lift_rate = lr;
-            child.u0_tilt_rate = tr;
-            child.has_u0 = true;
+    if (dedup) {
+      // Collect the lattice points reachable from the frontier, then evaluate each one once.
+      if (++lattice_epoch_ == 0) {
+        for (auto& cell : lattice_) cell.stamp = 0;
+        lattice_epoch_ = 1;
+      }
+      lattice_points_.clear();
+      for (const auto& node : frontier_) {
+        for (int li = 0; li < kActionsPerAxis; ++li) {
+          for (int ti = 0; ti < kActionsPerAxis; ++ti) {
+            const int lq = node.lift_q + kLatticeMoves[li];
+            const int tq = node.tilt_q + kLatticeMoves[ti];
+            LatticeCell& cell = cellAt(lq, tq);
+            if (cell.stamp == lattice_epoch_) continue;
+            cell.stamp = lattice_epoch_;
+            cell.node = -1;
+            lattice_points_.push_back((lq + lattice_half_) * lattice_dim + (tq + lattice_half_));
           }
+        }
+      }
+
+      const int n_points = static_cast<int>(lattice_points_.size());
+      const double s_next = frontier_.front().s_m + assumed_v * dt;  // all nodes of a level share s
+      auto evaluatePoints = [&](int begin, int end) {
+        for (int p = begin; p < end; ++p) {
+          const int idx = lattice_points_[static_cast<size_t>(p)];
+          const int lq = idx / lattice_dim - lattice_half_;
+          const int tq = idx % lattice_dim - lattice_half_;
+          const StageEval e = evaluateState(k, s_next, lift0 + lift_q_step * static_cast<double>(lq),
+                                            tilt0 + tilt_q_step * static_cast<double>(tq));
+          LatticeCell& cell = lattice_[static_cast<size_t>(idx)];
+          cell.clearance_top_m = e.clearance_top_m;
+          cell.clearance_bottom_m = e.clearance_bottom_m;
+          cell.feasible = e.feasible;
+        }
+      };
+      const int n_eval_chunks = pool_ ? std::min(pool_->size(), n_points) : 1;
+      if (n_eval_chunks > 1) {
+        const int chunk = (n_points + n_eval_chunks - 1) / n_eval_chunks;
+        pool_->parallelFor(n_eval_chunks, [&](int c) { evaluatePoints(c * chunk, std::min(n_points, (c + 1) * chunk)); });
+      } else {
+        evaluatePoints(0, n_points);
+      }
+      candidates_evaluated += n_points;
+    }
 
-          next.push_back(child);
+    const int n_chunks = pool_ ? std::min(pool_->size(), n_front) : 1;
+    if (n_chunks > 1) {
+      // Contiguous chunks, merged in chunk order: next_ ends up exactly as in the serial loop.
+      const int chunk = (n_front + n_chunks - 1) / n_chunks;
+      pool_->parallelFor(n_chunks, [&](int c) {
+        auto& out = chunk_children_[static_cast<size_t>(c)];
+        int& evaluated = chunk_evaluated_[static_cast<size_t>(c)];
+        out.clear();
+        evaluated = 0;
+        const int end = std::min(n_front, (c + 1) * chunk);
+        for (int i = c * chunk; i < end; ++i) expandNode(frontier_[static_cast<size_t>(i)], k, out, evaluated);
+      });
+      for (int c = 0; c < n_chunks; ++c) {
+        const auto& out = chunk_children_[static_cast<size_t>(c)];
+        next_.insert(next_.end(), out.begin(), out.end());
+        candidates_evaluated += chunk_evaluated_[static_cast<size_t>(c)];
+      }
+    } else if (deadline.active() && !dedup && k > 0) {
+      // Anytime expansion: cheapest parents first until the deadline. Children are then regrouped in
+      // frontier order, so a completed level is identical to the plain loop below.
+      expand_order_.resize(static_cast<size_t>(n_front));
+      std::iota(expand_order_.begin(), expand_order_.end(), 0);
+      std::sort(expand_order_.begin(), expand_order_.end(), [&](int a, int b) {
+        const double ca = frontier_[static_cast<size_t>(a)].cost;
+        const double cb = frontier_[static_cast<size_t>(b)].cost;
+        return ca < cb || (ca == cb && a < b);
+      });
+      child_begin_.assign(static_cast<size_t>(n_front), 0);
+      child_counts_.assign(static_cast<size_t>(n_front), 0);
+      for (const int p : expand_order_) {
+        if (deadline.expired()) break;
+        const size_t begin = next_.size();
+        expandNode(frontier_[static_cast<size_t>(p)], k, next_, candidates_evaluated);
+        child_begin_[static_cast<size_t>(p)] = static_cast<int>(begin);
+        child_counts_[static_cast<size_t>(p)] = static_cast<int>(next_.size() - begin);
+      }
+      regrouped_.clear();
+      for (int p = 0; p < n_front; ++p) {
+        const auto first = next_.begin() + child_begin_[static_cast<size_t>(p)];
+        regrouped_.insert(regrouped_.end(), first, first + child_counts_[static_cast<size_t>(p)]);
+      }
+      next_.swap(regrouped_);
+    } else {
+      for (const auto& node : frontier_) expandNode(node, k, next_, candidates_evaluated);
+    }
+    nodes_expanded += static_cast<int>(next_.size());
+    parents_expanded += n_front;
+
+    if (dedup) {
+      // Keep the cheapest node per lattice point (the first one on ties), in first-occurrence order.
+      size_t w = 0;
+      for (size_t r = 0; r < next_.size(); ++r) {
+        const SeqNode& n = next_[r];
+        if (n.seed >= 0) {
+          next_[w++] = n;
+          continue;
+        }
+        LatticeCell& cell = cellAt(n.lift_q, n.tilt_q);
+        if (cell.node < 0) {
+          cell.node = static_cast<int>(w);
+          next_[w++] = n;
+        } else {
+          if (n.cost < next_[static_cast<size_t>(cell.node)].cost) next_[static_cast<size_t>(cell.node)] = n;
+          ++nodes_deduplicated;
         }
       }
+      next_.resize(w);
     }
 
-    if (next.empty()) {
+    if (next_.empty()) {
       break;
     }
 
-    // Keep best beam candidates
-    std::nth_element(next.begin(),
-                     next.begin() + std::min(static_cast<int>(next.size()), beam) - 1,
-                     next.end(),
-                     [](const SeqNode& a, const SeqNode& b) { return a.cost < b.cost; });
-    if (static_cast<int>(next.size()) > beam) {
-      next.resize(static_cast<size_t>(beam));
+    // Keep best beam candidates. Warm-start seeds (at most one node each) are moved to the front and
+    // always kept; the remaining slots go to the cheapest other nodes.
+    auto prune_begin = next_.begin();
+    if (n_seeds_ > 0) {
+      prune_begin = std::partition(next_.begin(), next_.end(), [](const SeqNode& n) { return n.seed >= 0; });
+    }
+    const int kept = static_cast<int>(prune_begin - next_.begin());
+    const int rest = static_cast<int>(next_.end() - prune_begin);
+    const int slots = std::min(rest, beam - kept);
+    if (slots > 0) {
+      std::nth_element(prune_begin,
+                       prune_begin + slots - 1,
+                       next_.end(),
+                       [](const SeqNode& a, const SeqNode& b) { return a.cost < b.cost; });
+    }
+    if (static_cast<int>(next_.size()) > beam) {
+      nodes_beam_cut += static_cast<int>(next_.size()) - beam;
+      next_.resize(static_cast<size_t>(beam));
     }
 
-    frontier = std::move(next);
+    frontier_.swap(next_);
+    ++levels_completed;
   }
 
   // Pick best sequence in frontier
-  for (const auto& node : frontier) {
+  if (reused) {
     any_feasible_sequence = true;
-    if (node.cost < best_node.cost) best_node = node;
+    best_node = anchor_node_;
+    levels_completed = anchor_levels_;
+  } else {
+    for (const auto& node : frontier_) {
+      any_feasible_sequence = true;
+      if (node.cost < best_node.cost) best_node = node;
+    }
   }
 
   double lift_star = lift0;
@@ -286,7 +535,23 @@ DebugFrame ControllerMPC::step(const ControlInput& in) {
   bool had_feasible = false;
 
   SafetyCode search_code = SafetyCode::None;
-  std::string search_msg;
+
+  // Remember the chosen plan for the next step's warm start.
+  prev_plan_len_ = 0;
+  if (any_feasible_sequence && best_node.has_u0) {
+    prev_plan_len_ = std::min(levels_completed, kMaxWarmStartSteps);
+    for (int k = 0; k < prev_plan_len_; ++k) {
+      prev_plan_[static_cast<size_t>(k)] = static_cast<std::uint8_t>((best_node.actions >> (5 * k)) & 0x1F);
+    }
+  }
+  if (!reused) {
+    anchor_.valid = false;
+    if (!degraded && any_feasible_sequence && best_node.has_u0) {
+      anchor_.set(in, current_level);
+      anchor_node_ = best_node;
+      anchor_levels_ = levels_completed;
+    }
+  }
 
   if (any_feasible_sequence && best_node.has_u0) {
     // Convert first rate action to a near-term target position.
@@ -297,89 +562,51 @@ DebugFrame ControllerMPC::step(const ControlInput& in) {
     // Fallback: do a single-step best-effort search in the same neighborhood as the original controller.
     // (Keeps behavior safe even if MPC horizon becomes infeasible.)
     search_code = SafetyCode::NoFeasibleSolution;
-    search_msg = "No feasible MPC sequence";
-
-    const int nL = std::max(3, cfg_.grid_lift_steps);
-    const int nT = std::max(3, cfg_.grid_tilt_steps);
 
     const double Lmin = lift0 - cfg_.search_lift_half_range_m;
     const double Lmax = lift0 + cfg_.search_lift_half_range_m;
     const double Tmin = tilt0 - cfg_.search_tilt_half_range_rad;
     const double Tmax = tilt0 + cfg_.search_tilt_half_range_rad;
 
-    double best_min_clear = -std::numeric_limits<double>::infinity();
-    double best_min_lift = lift0;
-    double best_min_tilt = tilt0;
-
-    for (int i = 0; i < nL; ++i) {
-      const double tL = (nL == 1) ? 0.0 : static_cast<double>(i) / static_cast<double>(nL - 1);
-      const double lift_c = Lmin + (Lmax - Lmin) * tL;
-      for (int j = 0; j < nT; ++j) {
-        const double tT = (nT == 1) ? 0.0 : static_cast<double>(j) / static_cast<double>(nT - 1);
-        const double tilt_c = Tmin + (Tmax - Tmin) * tT;
-
-        const auto corners = computeRackCorners2D(in.s_m, lift_c, in.pitch_rad, tilt_c, in.env, in.rack, in.forklift);
-        const auto clr = computeClearances(corners, in.env, margin_top, margin_bottom);
-        double top_w = clr.clearance_top_m;
-        double bot_w = clr.clearance_bottom_m;
-        if (cfg_.lookahead_s_m > 1e-9) {
-          const auto corners_a = computeRackCorners2D(s_look, lift_c, in.pitch_rad, tilt_c, in.env, in.rack, in.forklift);
-          const auto clr_a = computeClearances(corners_a, in.env, margin_top, margin_bottom);
-          top_w = std::min(top_w, clr_a.clearance_top_m);
-          bot_w = std::min(bot_w, clr_a.clearance_bottom_m);
-        }
-
-        const double min_clear = std::min(top_w, bot_w);
-        if (min_clear > best_min_clear) {
-          best_min_clear = min_clear;
-          best_min_lift = lift_c;
-          best_min_tilt = tilt_c;
-        }
-      }
-    }
+    fillAxis(lift_grid_, tables_.grid_lift_t, Lmin, Lmax);
+    fillAxis(tilt_grid_, tables_.grid_tilt_t, Tmin, Tmax);
+    const MaxMinClearancePick pick =
+        maxMinClearanceGrid(in, limits, lift_grid_, tilt_grid_, lift0, tilt0, deadline, &batch_, &batch_ahead_);
+    candidates_evaluated += pick.evaluated;
 
-    lift_star = best_min_lift;
-    tilt_star = best_min_tilt;
+    lift_star = pick.lift_m;
+    tilt_star = pick.tilt_rad;
     had_feasible = false;
   }
 
-  f.cmd.lift_target_m = lift_star;
-  f.cmd.tilt_target_rad = tilt_star;
-  f.cmd.lift_rate_limit_m_s = lift_rate_limit;
-  f.cmd.tilt_rate_limit_rad_s = tilt_rate_limit;
-
-  // Speed policy: same as original controller
-  const double min_clear = std::min(current_clear_top_worst, current_clear_bottom_worst);
-  const double clearance_factor = clamp(min_clear / cfg_.warn_threshold_m, 0.0, 1.0);
-  const double pitch_rate_factor = clamp(1.0 - (std::abs(in.pitch_rate_rad_s) / (2.0 * cfg_.pitch_rate_jitter_threshold_rad_s)), 0.2, 1.0);
-  const double base_speed = cfg_.base_speed_limit_m_s * speed_mult;
-  double speed = base_speed * std::min(clearance_factor, pitch_rate_factor);
-  if (min_clear >= (cfg_.hard_threshold_m - kClearanceEpsilonM)) {
-    speed = std::max(speed, cfg_.min_speed_limit_m_s * speed_mult * pitch_rate_factor);
-  } else {
-    speed = 0.0;
-  }
-  f.cmd.speed_limit_m_s = speed;
+  composeCommand(cfg_, limits, in, pose, lift_star, tilt_star, search_code, f);
 
   f.had_feasible_solution = had_feasible;
   f.selected_cost = any_feasible_sequence ? best_node.cost : 0.0;
-
-  // Safety
-  if (degraded) {
-    f.safety = makeSafety(cfg_, current_clear_top_worst, current_clear_bottom_worst, current_clear_worst.worst_point,
-                          true, degraded_code, degraded_msg);
-  } else {
-    SafetyCode code = (search_code != SafetyCode::None) ? search_code : SafetyCode::None;
-    std::string msg = search_msg;
-    f.safety = makeSafety(cfg_, current_clear_top_worst, current_clear_bottom_worst, current_clear_worst.worst_point,
-                          false, code, msg);
+  f.candidates_evaluated = candidates_evaluated;
+  f.warm_start_used = warm_start_used && !reused;
+  f.budget_exhausted = deadline.hit();
+  if (dbg) {
+    dbg->search_reused = reused;
+    dbg->mpc_nodes_expanded = nodes_expanded;
+    dbg->mpc_nodes_deduplicated = nodes_deduplicated;
+    dbg->clearance_cache_hits = static_cast<int>(cache_.hits() - cache_hits0);
+    dbg->clearance_cache_misses = static_cast<int>(cache_.misses() - cache_misses0);
   }
 
   // Update smoothing memory based on chosen near-term target.
-  prev_lift_rate_m_s_ = clamp((lift_star - lift0) / dt, -lift_rate_limit, lift_rate_limit);
-  prev_tilt_rate_rad_s_ = clamp((tilt_star - tilt0) / dt, -tilt_rate_limit, tilt_rate_limit);
-
-  return f;
+  prev_lift_rate_m_s_ = smoothedRate(lift_star, lift0, dt, lift_rate_limit);
+  prev_tilt_rate_rad_s_ = smoothedRate(tilt_star, tilt0, dt, tilt_rate_limit);
+
+  StepMetrics m;
+  m.candidates_evaluated = candidates_evaluated;
+  m.candidates_feasible = nodes_expanded;
+  m.beam_nodes_expanded = parents_expanded;
+  m.beam_nodes_pruned = nodes_deduplicated + nodes_beam_cut;
+  m.fallback_grid = (search_code == SafetyCode::NoFeasibleSolution);
+  m.budget_exhausted = deadline.hit();
+  m.latency_ns = timer.elapsedNs();
+  if (!warming_up_) instr_.record(m);
 }
 
 }  // namespace tlf
@@ -0,0 +1,284 @@
+#include "model/FeasibilityEnvelope.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include "model/AxisSampling.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace tlf {
+
+namespace {
+
+constexpr char kMagic[4] = {'T', 'L', 'F', 'E'};
+constexpr std::size_t kHeaderDoubles = 15;
+constexpr std::size_t kHeaderInts = 4;
+// magic + version + reserved, doubles, ints; padded to a whole number of cells so the cell array stays
+// aligned inside the mapping.
+constexpr std::size_t kHeaderBytes = ((8 + 8 * kHeaderDoubles + 4 * kHeaderInts + 31) / 32) * 32;
+
+bool hostIsLittleEndian() {
+  const std::uint16_t probe = 1;
+  unsigned char b;
+  std::memcpy(&b, &probe, 1);
+  return b == 1;
+}
+
+void putU32(unsigned char* p, std::uint32_t v) {
+  for (int i = 0; i < 4; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+void putF64(unsigned char* p, double v) {
+  std::uint64_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  for (int i = 0; i < 8; ++i) p[i] = static_cast<unsigned char>(bits >> (8 * i));
+}
+
+std::uint32_t getU32(const unsigned char* p) {
+  std::uint32_t v = 0;
+  for (int i = 0; i < 4; ++i) v |= static_cast<std::uint32_t>(p[i]) << (8 * i);
+  return v;
+}
+
+double getF64(const unsigned char* p) {
+  std::uint64_t bits = 0;
+  for (int i = 0; i < 8; ++i) bits |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+  double v;
+  std::memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+// Header fields in file order.
+struct HeaderFields {
+  double* d[kHeaderDoubles];
+  int* i[kHeaderInts];
+};
+
+HeaderFields headerFields(EnvelopeSpec& spec, RackParams& rack, ForkliftParams& forklift) {
+  return HeaderFields{{&spec.s_min_m, &spec.s_max_m, &spec.pitch_min_rad, &spec.pitch_max_rad, &spec.lift_min_m,
+                       &spec.lift_max_m, &spec.tilt_min_rad, &spec.tilt_max_rad, &spec.margin_top_m,
+                       &spec.margin_bottom_m, &rack.height_m, &rack.length_m, &rack.mount_offset_m.x,
+                       &rack.mount_offset_m.z, &forklift.mast_pivot_height_m},
+                      {&spec.s_bins, &spec.pitch_bins, &spec.lift_samples, &spec.tilt_samples}};
+}
+
+// Feasible poses of one sampled (s, pitch), as an index-space bounding box.
+struct SampleBox {
+  int lift_lo{std::numeric_limits<int>::max()};
+  int lift_hi{-1};
+  int tilt_lo{std::numeric_limits<int>::max()};
+  int tilt_hi{-1};
+
+  bool empty() const { return lift_hi < 0; }
+  void add(int i, int j) {
+    lift_lo = std::min(lift_lo, i);
+    lift_hi = std::max(lift_hi, i);
+    tilt_lo = std::min(tilt_lo, j);
+    tilt_hi = std::max(tilt_hi, j);
+  }
+  void merge(const SampleBox& o) {
+    if (o.empty()) return;
+    add(o.lift_lo, o.tilt_lo);
+    add(o.lift_hi, o.tilt_hi);
+  }
+};
+
+struct Sampler {
+  const EnvironmentGeometry& env;
+  const RackParams& rack;
+  const ForkliftParams& forklift;
+  const EnvelopeSpec& spec;
+  std::vector<double> lifts;
+  std::vector<double> tilts;
+
+  // Evaluates every sampled pose at (s, pitch); optionally reports the max-min-clearance pose.
+  SampleBox sample(double s_m, double pitch_rad, ClearanceBatch* batch, EnvelopeCell* centre = nullptr) const {
+    computeClearancesBatch(s_m, lifts.data(), lifts.size(), tilts.data(), tilts.size(), pitch_rad, env, rack, forklift,
+                           spec.margin_top_m, spec.margin_bottom_m, batch);
+    SampleBox box;
+    double best = -std::numeric_limits<double>::infinity();
+    std::size_t feasible = 0;
+    for (std::size_t j = 0; j < tilts.size(); ++j) {
+      for (std::size_t i = 0; i < lifts.size(); ++i) {
+        const std::size_t k = batch->index(i, j);
+        const double top = batch->clearance_top_m[k];
+        const double bottom = batch->clearance_bottom_m[k];
+        if (top >= 0.0 && bottom >= 0.0) {
+          box.add(static_cast<int>(i), static_cast<int>(j));
+          ++feasible;
+        }
+        if (centre && std::min(top, bottom) > best) {
+          best = std::min(top, bottom);
+          centre->best_lift_m = static_cast<float>(lifts[i]);
+          centre->best_tilt_rad = static_cast<float>(tilts[j]);
+          centre->best_min_clearance_m = static_cast<float>(best);
+        }
+      }
+    }
+    if (centre) centre->feasible_fraction = static_cast<float>(feasible) / static_cast<float>(lifts.size() * tilts.size());
+    return box;
+  }
+};
+
+}  // namespace
+
+FeasibilityEnvelope FeasibilityEnvelope::build(const EnvironmentGeometry& env,
+                                               const RackParams& rack,
+                                               const ForkliftParams& forklift,
+                                               const EnvelopeSpec& spec_in,
+                                               int threads) {
+  FeasibilityEnvelope e;
+  e.spec_ = spec_in;
+  e.spec_.s_bins = std::max(1, e.spec_.s_bins);
+  e.spec_.pitch_bins = std::max(1, e.spec_.pitch_bins);
+  e.spec_.lift_samples = std::max(2, e.spec_.lift_samples);
+  e.spec_.tilt_samples = std::max(2, e.spec_.tilt_samples);
+  e.rack_ = rack;
+  e.forklift_ = forklift;
+  const EnvelopeSpec& spec = e.spec_;
+
+  Sampler sampler{env, rack, forklift, spec, {}, {}};
+  fillAxis(sampler.lifts, spec.lift_samples, spec.lift_min_m, spec.lift_max_m);
+  fillAxis(sampler.tilts, spec.tilt_samples, spec.tilt_min_rad, spec.tilt_max_rad);
+  const double ds = (spec.s_max_m - spec.s_min_m) / spec.s_bins;
+  const double dp = (spec.pitch_max_rad - spec.pitch_min_rad) / spec.pitch_bins;
+
+  // Bin-corner boxes on the (s_bins + 1) x (pitch_bins + 1) lattice, then each bin from its corners and centre.
+  const int n_s_nodes = spec.s_bins + 1;
+  const int n_p_nodes = spec.pitch_bins + 1;
+  std::vector<SampleBox> nodes(static_cast<std::size_t>(n_s_nodes) * n_p_nodes);
+  e.owned_.resize(e.cellCount());
+
+  ThreadPool pool(std::max(1, threads));
+  pool.parallelFor(n_s_nodes, [&](int is) {
+    ClearanceBatch batch;
+    for (int ip = 0; ip < n_p_nodes; ++ip) {
+      nodes[static_cast<std::size_t>(is) * n_p_nodes + ip] = sampler.sample(spec.s_min_m + is * ds, spec.pitch_min_rad + ip * dp, &batch);
+    }
+  });
+
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  pool.parallelFor(spec.s_bins, [&](int is) {
+    ClearanceBatch batch;
+    for (int ip = 0; ip < spec.pitch_bins; ++ip) {
+      EnvelopeCell& c = e.owned_[static_cast<std::size_t>(is) * spec.pitch_bins + ip];
+      SampleBox box = sampler.sample(spec.s_min_m + (is + 0.5) * ds, spec.pitch_min_rad + (ip + 0.5) * dp, &batch, &c);
+      for (int a = 0; a <= 1; ++a) {
+        for (int b = 0; b <= 1; ++b) box.merge(nodes[static_cast<std::size_t>(is + a) * n_p_nodes + ip + b]);
+      }
+      if (box.empty()) {
+        c.lift_lo_m = c.lift_hi_m = c.tilt_lo_rad = c.tilt_hi_rad = nan;
+        continue;
+      }
+      const auto clampIndex = [](int v, int n) { return std::max(0, std::min(n - 1, v)); };
+      c.lift_lo_m = static_cast<float>(sampler.lifts[static_cast<std::size_t>(clampIndex(box.lift_lo - 1, spec.lift_samples))]);
+      c.lift_hi_m = static_cast<float>(sampler.lifts[static_cast<std::size_t>(clampIndex(box.lift_hi + 1, spec.lift_samples))]);
+      c.tilt_lo_rad = static_cast<float>(sampler.tilts[static_cast<std::size_t>(clampIndex(box.tilt_lo - 1, spec.tilt_samples))]);
+      c.tilt_hi_rad = static_cast<float>(sampler.tilts[static_cast<std::size_t>(clampIndex(box.tilt_hi + 1, spec.tilt_samples))]);
+    }
+  });
+
+  e.cells_ = e.owned_.data();
+  e.finishSetup();
+  return e;
+}
+
+void FeasibilityEnvelope::finishSetup() {
+  const double ds = (spec_.s_max_m - spec_.s_min_m) / spec_.s_bins;
+  const double dp = (spec_.pitch_max_rad - spec_.pitch_min_rad) / spec_.pitch_bins;
+  inv_ds_ = (ds > 0.0) ? 1.0 / ds : 0.0;
+  inv_dp_ = (dp > 0.0) ? 1.0 / dp : 0.0;
+}
+
+bool FeasibilityEnvelope::accepts(const RackParams& rack,
+                                  const ForkliftParams& forklift,
+                                  double margin_top_m,
+                                  double margin_bottom_m) const {
+  return rack.height_m == rack_.height_m && rack.length_m == rack_.length_m &&
+         rack.mount_offset_m.x == rack_.mount_offset_m.x && rack.mount_offset_m.z == rack_.mount_offset_m.z &&
+         forklift.mast_pivot_height_m == forklift_.mast_pivot_height_m && margin_top_m >= spec_.margin_top_m &&
+         margin_bottom_m >= spec_.margin_bottom_m;
+}
+
+bool FeasibilityEnvelope::save(const std::string& path) const {
+  std::ofstream out(path, std::ios::binary);
+  if (!out.good()) return false;
+
+  unsigned char header[kHeaderBytes] = {};
+  std::memcpy(header, kMagic, 4);
+  header[4] = static_cast<unsigned char>(kVersion & 0xFF);
+  header[5] = static_cast<unsigned char>(kVersion >> 8);
+  EnvelopeSpec spec = spec_;
+  RackParams rack = rack_;
+  ForkliftParams forklift = forklift_;
+  const HeaderFields f = headerFields(spec, rack, forklift);
+  unsigned char* p = header + 8;
+  for (double* d : f.d) {
+    putF64(p, *d);
+    p += 8;
+  }
+  for (int* i : f.i) {
+    putU32(p, static_cast<std::uint32_t>(*i));
+    p += 4;
+  }
+  out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+  std::vector<unsigned char> body(cellCount() * sizeof(EnvelopeCell));
+  const float* src = reinterpret_cast<const float*>(cells_);
+  for (std::size_t k = 0; k < cellCount() * 8; ++k) {
+    std::uint32_t bits;
+    std::memcpy(&bits, src + k, sizeof(bits));
+    putU32(body.data() + 4 * k, bits);
+  }
+  out.write(reinterpret_cast<const char*>(body.data()), static_cast<std::streamsize>(body.size()));
+  return out.good();
+}
+
+std::shared_ptr<const FeasibilityEnvelope> FeasibilityEnvelope::load(const std::string& path, std::string* error) {
+  auto fail = [&](const std::string& msg) -> std::shared_ptr<const FeasibilityEnvelope> {
+    if (error) *error = msg;
+    return nullptr;
+  };
+
+  MappedFile file(path);
+  if (!file.good()) return fail("cannot open " + path);
+  const auto* p = reinterpret_cast<const unsigned char*>(file.data());
+  if (file.size() < kHeaderBytes || std::memcmp(p, kMagic, 4) != 0) return fail("not a feasibility envelope");
+  const std::uint16_t version = static_cast<std::uint16_t>(p[4] | (p[5] << 8));
+  if (version != kVersion) return fail("unsupported envelope version " + std::to_string(version));
+
+  auto e = std::make_shared<FeasibilityEnvelope>();
+  const HeaderFields f = headerFields(e->spec_, e->rack_, e->forklift_);
+  const unsigned char* q = p + 8;
+  for (double* d : f.d) {
+    *d = getF64(q);
+    q += 8;
+  }
+  for (int* i : f.i) {
+    *i = static_cast<int>(getU32(q));
+    q += 4;
+  }
+  if (e->spec_.s_bins < 1 || e->spec_.pitch_bins < 1) return fail("empty envelope");
+  if (file.size() != kHeaderBytes + e->cellCount() * sizeof(EnvelopeCell)) return fail("truncated envelope");
+
+  const auto* cells = reinterpret_cast<const EnvelopeCell*>(file.data() + kHeaderBytes);
+  if (hostIsLittleEndian() && reinterpret_cast<std::uintptr_t>(cells) % alignof(EnvelopeCell) == 0) {
+    e->file_ = std::move(file);
+    e->cells_ = reinterpret_cast<const EnvelopeCell*>(e->file_.data() + kHeaderBytes);  // zero-copy
+  } else {
+    e->owned_.resize(e->cellCount());
+    auto* dst = reinterpret_cast<float*>(e->owned_.data());
+    for (std::size_t k = 0; k < e->cellCount() * 8; ++k) {
+      const std::uint32_t bits = getU32(p + kHeaderBytes + 4 * k);
+      std::memcpy(dst + k, &bits, sizeof(bits));
+    }
+    e->cells_ = e->owned_.data();
+  }
+  e->finishSetup();
+  return e;
+}
+
+}  // namespace tlf
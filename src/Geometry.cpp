@@ -1,12 +1,15 @@
 #include "model/Geometry.hpp"
 
-#include <algorithm>
-#include <cmath>
-#include <limits>
+#include "model/GeometryKernels.hpp"
 
 namespace tlf {
 
-static double envCeilingZAtX(const EnvironmentGeometry& env, double x) {
+static bool hasProfile(const EnvironmentGeometry& env) { return env.profile && env.profile->valid(); }
+
+double envCeilingZAtX(const EnvironmentGeometry& env, double x) {
+  if (hasProfile(env)) {
+    return env.profile->ceilingZAtX(x);
+  }
   if (env.ceiling_z_at_x_m) {
     return env.ceiling_z_at_x_m(x);
   }
@@ -16,7 +19,10 @@ static double envCeilingZAtX(const EnvironmentGeometry& env, double x) {
   return env.ceiling_z_m.value_or(10.0);  // very high by default
 }
 
-static double envFloorZAtX(const EnvironmentGeometry& env, double x) {
+double envFloorZAtX(const EnvironmentGeometry& env, double x) {
+  if (hasProfile(env)) {
+    return env.profile->floorZAtX(x);
+  }
   if (env.floor_z_at_x_m) {
     return env.floor_z_at_x_m(x);
   }
@@ -33,63 +39,78 @@ CornerPoints2D computeRackCorners2D(double s_m,
                                    const EnvironmentGeometry& env,
                                    const RackParams& rack,
                                    const ForkliftParams& forklift) {
-  const double theta = pitch_rad + tilt_rad;
-  const Rot2 R = Rot2::fromRad(theta);
-
-  // Mast base at local floor + fixed pivot height.
-  const double base_z = envFloorZAtX(env, s_m) + forklift.mast_pivot_height_m;
-  const Vec2 mast_base{s_m, base_z};
-
-  // Carriage (fork pivot) moves along mast (+z in rack frame).
-  const Vec2 pivot_world = mast_base + R.apply(Vec2{0.0, lift_m});
-
-  // Rear-bottom corner position
-  const Vec2 rb = pivot_world + R.apply(rack.mount_offset_m);
-
-  const Vec2 rt = rb + R.apply(Vec2{0.0, rack.height_m});
-  const Vec2 fb = rb + R.apply(Vec2{rack.length_m, 0.0});
-  const Vec2 ft = rb + R.apply(Vec2{rack.length_m, rack.height_m});
+  return rackCornersAtBase(s_m, envFloorZAtX(env, s_m), lift_m, pitch_rad, tilt_rad, rack, forklift);
+}
 
-  return CornerPoints2D{{rb, rt, fb, ft}};
+CornerPoints2D computeRackCorners2D(double s_m,
+                                   double lift_m,
+                                   double pitch_rad,
+                                   double tilt_rad,
+                                   const TerrainProfile& profile,
+                                   const RackParams& rack,
+                                   const ForkliftParams& forklift) {
+  return rackCornersAtBase(s_m, profile.floorZAtX(s_m), lift_m, pitch_rad, tilt_rad, rack, forklift);
 }
 
 ClearanceResult computeClearances(const CornerPoints2D& corners,
                                  const EnvironmentGeometry& env,
                                  double margin_top_m,
                                  double margin_bottom_m) {
-  struct Candidate {
-    CornerId id;
-    double value;
-  };
-
-  // Top clearance: min over top corners of (ceiling - z)
-  Candidate topWorst{CornerId::RearTop, std::numeric_limits<double>::infinity()};
-  for (CornerId id : {CornerId::RearTop, CornerId::FrontTop}) {
-    const auto& p = corners.p[static_cast<int>(id)];
-    const double c = envCeilingZAtX(env, p.x) - p.z;
-    if (c < topWorst.value) topWorst = {id, c};
-  }
+  return visitEnvironment(env, [&](const auto& ceiling, const auto& floor) {
+    return clearancesWith(corners, ceiling, floor, margin_top_m, margin_bottom_m);
+  });
+}
 
-  // Bottom clearance: min over bottom corners of (z - floor)
-  Candidate botWorst{CornerId::RearBottom, std::numeric_limits<double>::infinity()};
-  for (CornerId id : {CornerId::RearBottom, CornerId::FrontBottom}) {
-    const auto& p = corners.p[static_cast<int>(id)];
-    const double c = p.z - envFloorZAtX(env, p.x);
-    if (c < botWorst.value) botWorst = {id, c};
-  }
+ClearanceResult computeClearances(const CornerPoints2D& corners,
+                                 const TerrainProfile& profile,
+                                 double margin_top_m,
+                                 double margin_bottom_m) {
+  return clearancesWith(corners, ProfileCeiling{&profile}, ProfileFloor{&profile}, margin_top_m, margin_bottom_m);
+}
 
-  const double clearance_top_m = topWorst.value - margin_top_m;
-  const double clearance_bottom_m = botWorst.value - margin_bottom_m;
+void ClearanceBatch::resize(std::size_t lifts, std::size_t tilts) {
+  n_lift = lifts;
+  n_tilt = tilts;
+  const std::size_t n = lifts * tilts;
+  clearance_top_m.resize(n);
+  clearance_bottom_m.resize(n);
+  top_worst_point.resize(n);
+  bottom_worst_point.resize(n);
+  for (auto& v : scratch) v.resize(lifts);
+}
 
-  const CornerId worst = (clearance_top_m < clearance_bottom_m) ? topWorst.id : botWorst.id;
+void computeClearancesBatch(double s_m,
+                            const double* lifts,
+                            std::size_t n_lift,
+                            const double* tilts,
+                            std::size_t n_tilt,
+                            double pitch_rad,
+                            const EnvironmentGeometry& env,
+                            const RackParams& rack,
+                            const ForkliftParams& forklift,
+                            double margin_top_m,
+                            double margin_bottom_m,
+                            ClearanceBatch* out) {
+  visitEnvironment(env, [&](const auto& ceiling, const auto& floor) {
+    clearancesBatchWith(s_m, lifts, n_lift, tilts, n_tilt, pitch_rad, ceiling, floor, rack, forklift, margin_top_m,
+                        margin_bottom_m, out);
+  });
+}
 
-  ClearanceResult out;
-  out.clearance_top_m = clearance_top_m;
-  out.clearance_bottom_m = clearance_bottom_m;
-  out.top_worst_point = topWorst.id;
-  out.bottom_worst_point = botWorst.id;
-  out.worst_point = worst;
-  return out;
+void computeClearancesBatch(double s_m,
+                            const double* lifts,
+                            std::size_t n_lift,
+                            const double* tilts,
+                            std::size_t n_tilt,
+                            double pitch_rad,
+                            const TerrainProfile& profile,
+                            const RackParams& rack,
+                            const ForkliftParams& forklift,
+                            double margin_top_m,
+                            double margin_bottom_m,
+                            ClearanceBatch* out) {
+  clearancesBatchWith(s_m, lifts, n_lift, tilts, n_tilt, pitch_rad, ProfileCeiling{&profile}, ProfileFloor{&profile},
+                      rack, forklift, margin_top_m, margin_bottom_m, out);
 }
 
 std::string toString(CornerId id) {
@@ -0,0 +1,127 @@
+#include "utils/LodIndex.hpp"
+
+#include <algorithm>
+
+#include "controller/Types.hpp"
+
+namespace tlf {
+
+LodIndex::LodIndex(std::size_t channels) : values_(channels) { clear(); }
+
+void LodIndex::clear() {
+  for (auto& v : values_) v.clear();
+  levels_.assign(1, {});  // level kMinLevel; more are added as the log outgrows the top level
+  stop_entries_.clear();
+  frames_ = 0;
+  prev_stop_ = false;
+}
+
+void LodIndex::reserve(std::size_t frames) {
+  for (auto& v : values_) v.reserve(frames);
+  stop_entries_.reserve(64);
+  const std::size_t c = values_.size();
+  for (std::size_t k = 0; k < levels_.size(); ++k) {
+    levels_[k].reserve(((frames >> (k + kMinLevel)) + 1) * c);
+  }
+}
+
+void LodIndex::append(const double* values, std::int32_t safety_level) {
+  const std::size_t c_count = values_.size();
+  const auto f = static_cast<std::uint32_t>(frames_);
+  for (std::size_t c = 0; c < c_count; ++c) values_[c].push_back(values[c]);
+
+  // Open bucket of every level: a new bucket starts with this frame, otherwise strict comparisons
+  // keep the earliest extremum.
+  for (std::size_t k = 0; k < levels_.size(); ++k) {
+    auto& level = levels_[k];
+    const std::size_t bucket = frames_ >> (k + kMinLevel);
+    if (bucket * c_count == level.size()) {
+      for (std::size_t c = 0; c < c_count; ++c) level.push_back({f, f});
+      continue;
+    }
+    Extrema* e = &level[bucket * c_count];
+    for (std::size_t c = 0; c < c_count; ++c) {
+      const auto& v = values_[c];
+      if (v[f] < v[e[c].min_frame]) e[c].min_frame = f;
+      if (v[f] > v[e[c].max_frame]) e[c].max_frame = f;
+    }
+  }
+  ++frames_;
+
+  // Keep a top level with a single bucket over all frames: once the log outgrows it, the next level
+  // starts from the top level's first two buckets.
+  const std::size_t top = levels_.size() - 1;
+  if (frames_ > (std::size_t{1} << (top + kMinLevel))) {
+    std::vector<Extrema> up(c_count);
+    const Extrema* a = levels_[top].data();
+    const Extrema* b = a + c_count;
+    for (std::size_t c = 0; c < c_count; ++c) {
+      const auto& v = values_[c];
+      up[c].min_frame = (v[b[c].min_frame] < v[a[c].min_frame]) ? b[c].min_frame : a[c].min_frame;
+      up[c].max_frame = (v[b[c].max_frame] > v[a[c].max_frame]) ? b[c].max_frame : a[c].max_frame;
+    }
+    levels_.push_back(std::move(up));
+  }
+
+  const bool stop = safety_level == static_cast<std::int32_t>(SafetyLevel::STOP);
+  if (stop && !prev_stop_) stop_entries_.push_back(f);
+  prev_stop_ = stop;
+}
+
+void LodIndex::scan(std::size_t begin, std::size_t end, std::vector<std::uint32_t>* out) const {
+  for (const auto& v : values_) {
+    std::size_t lo = begin;
+    std::size_t hi = begin;
+    for (std::size_t i = begin + 1; i < end; ++i) {
+      if (v[i] < v[lo]) lo = i;
+      if (v[i] > v[hi]) hi = i;
+    }
+    out->push_back(static_cast<std::uint32_t>(lo));
+    out->push_back(static_cast<std::uint32_t>(hi));
+  }
+}
+
+void LodIndex::select(std::size_t begin, std::size_t end, std::size_t max_buckets,
+                      std::vector<std::uint32_t>* out) const {
+  out->clear();
+  end = std::min(end, frames_);
+  if (begin >= end) return;
+  const std::size_t n = end - begin;
+  max_buckets = std::max<std::size_t>(1, max_buckets);
+
+  if (n <= max_buckets) {
+    out->reserve(n);
+    for (std::size_t i = begin; i < end; ++i) out->push_back(static_cast<std::uint32_t>(i));
+    return;
+  }
+
+  // Smallest aligned bucket size 2^k with at most max_buckets buckets over n frames.
+  int k = 0;
+  while (((n + (std::size_t{1} << k) - 1) >> k) > max_buckets) ++k;
+
+  const std::size_t c_count = values_.size();
+  out->reserve(2 * c_count * (max_buckets + 2) + 2 + stop_entries_.size());
+  for (std::size_t b = begin >> k; (b << k) < end; ++b) {
+    const std::size_t lo = b << k;
+    const std::size_t hi = lo + (std::size_t{1} << k);
+    if (k >= kMinLevel && lo >= begin && hi <= end) {
+      const Extrema* e = &levels_[static_cast<std::size_t>(k - kMinLevel)][b * c_count];
+      for (std::size_t c = 0; c < c_count; ++c) {
+        out->push_back(e[c].min_frame);
+        out->push_back(e[c].max_frame);
+      }
+    } else {
+      scan(std::max(lo, begin), std::min(hi, end), out);
+    }
+  }
+
+  out->push_back(static_cast<std::uint32_t>(begin));
+  out->push_back(static_cast<std::uint32_t>(end - 1));
+  auto it = std::lower_bound(stop_entries_.begin(), stop_entries_.end(), static_cast<std::uint32_t>(begin));
+  for (; it != stop_entries_.end() && *it < end; ++it) out->push_back(*it);
+
+  std::sort(out->begin(), out->end());
+  out->erase(std::unique(out->begin(), out->end()), out->end());
+}
+
+}  // namespace tlf
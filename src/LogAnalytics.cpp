@@ -0,0 +1,243 @@
+#include "utils/LogAnalytics.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+#include "utils/LogReader.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace tlf {
+
+static constexpr const char* kLevelNames[kSafetyLevelCount] = {"OK", "WARN", "STOP", "DEGRADED"};
+static constexpr const char* kTerrainNames[kTerrainStateCount] = {"Ground", "FrontOnRamp", "OnRamp",
+                                                                  "FrontInContainerRearOnRamp", "InContainer"};
+static constexpr const char* kCornerNames[kCornerCount] = {"RearBottom", "RearTop", "FrontBottom", "FrontTop"};
+
+static bool inRange(std::int32_t v, std::size_t n) { return v >= 0 && static_cast<std::size_t>(v) < n; }
+
+static LogStatsOptions sanitized(LogStatsOptions o) {
+  o.hist_bins = std::max(1, o.hist_bins);
+  if (!(o.hist_bin_m > 0.0)) o.hist_bin_m = 0.01;
+  return o;
+}
+
+void LogStats::merge(const LogStats& o) {
+  frames += o.frames;
+  skipped_lines += o.skipped_lines;
+  duration_s += o.duration_s;
+  min_clearance_top_m = std::min(min_clearance_top_m, o.min_clearance_top_m);
+  min_clearance_bottom_m = std::min(min_clearance_bottom_m, o.min_clearance_bottom_m);
+  if (clearance_hist.size() < o.clearance_hist.size()) clearance_hist.resize(o.clearance_hist.size(), 0);
+  for (std::size_t i = 0; i < o.clearance_hist.size(); ++i) clearance_hist[i] += o.clearance_hist[i];
+  for (std::size_t i = 0; i < kSafetyLevelCount; ++i) {
+    level_time_s[i] += o.level_time_s[i];
+    level_frames[i] += o.level_frames[i];
+  }
+  for (std::size_t i = 0; i < kTerrainStateCount; ++i) terrain_time_s[i] += o.terrain_time_s[i];
+  for (std::size_t i = 0; i < kCornerCount; ++i) near_miss_events[i] += o.near_miss_events[i];
+  stop_events += o.stop_events;
+}
+
+LogStatsAccumulator::LogStatsAccumulator(const LogStatsOptions& options) : options_(sanitized(options)) {
+  stats_.clearance_hist.assign(static_cast<std::size_t>(options_.hist_bins), 0);
+}
+
+void LogStatsAccumulator::add(const LogRecord& r) {
+  LogStats& s = stats_;
+
+  // Dwell time of the previous frame's state.
+  if (have_prev_) {
+    const double dt = r.time_s - prev_time_s_;
+    if (std::isfinite(dt) && dt > 0.0) {
+      s.duration_s += dt;
+      if (inRange(prev_level_, kSafetyLevelCount)) s.level_time_s[static_cast<std::size_t>(prev_level_)] += dt;
+      if (inRange(prev_terrain_, kTerrainStateCount)) s.terrain_time_s[static_cast<std::size_t>(prev_terrain_)] += dt;
+    }
+  }
+  have_prev_ = true;
+  prev_time_s_ = r.time_s;
+  prev_level_ = r.safety_level;
+  prev_terrain_ = r.terrain_state;
+
+  ++s.frames;
+  if (inRange(r.safety_level, kSafetyLevelCount)) ++s.level_frames[static_cast<std::size_t>(r.safety_level)];
+  s.min_clearance_top_m = std::min(s.min_clearance_top_m, r.clearance_top_m);
+  s.min_clearance_bottom_m = std::min(s.min_clearance_bottom_m, r.clearance_bottom_m);
+
+  const double min_clear = std::min(r.clearance_top_m, r.clearance_bottom_m);
+  if (!std::isnan(min_clear)) {
+    const double x = std::floor((min_clear - options_.hist_min_m) / options_.hist_bin_m);
+    const double last = static_cast<double>(options_.hist_bins - 1);
+    s.clearance_hist[static_cast<std::size_t>(std::max(0.0, std::min(last, x)))] += 1;
+  }
+
+  const bool near_miss = min_clear < options_.near_miss_m;
+  if (near_miss && !in_near_miss_ && inRange(r.worst_point_id, kCornerCount)) {
+    ++s.near_miss_events[static_cast<std::size_t>(r.worst_point_id)];
+  }
+  in_near_miss_ = near_miss;
+
+  const bool stop = r.safety_level == static_cast<std::int32_t>(SafetyLevel::STOP);
+  if (stop && !in_stop_) ++s.stop_events;
+  in_stop_ = stop;
+}
+
+LogStats analyzeLogFile(const std::string& path, const LogStatsOptions& options) {
+  LogStatsAccumulator acc(options);
+  LogReader reader(path);
+  LogRecord r;
+  while (reader.next(&r)) acc.add(r);
+
+  LogStats s = std::move(acc.stats());
+  s.path = path;
+  s.skipped_lines = reader.skippedLines();
+  if (!reader.good()) s.error = reader.error();
+  return s;
+}
+
+LogSummary analyzeLogFiles(const std::vector<std::string>& paths, const LogStatsOptions& options, int threads) {
+  LogSummary out;
+  out.options = sanitized(options);
+  out.runs.resize(paths.size());
+  out.fleet = LogStatsAccumulator(options).stats();
+  if (paths.empty()) return out;
+
+  if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  threads = std::min<int>(threads, static_cast<int>(paths.size()));
+
+  ThreadPool pool(threads);
+  pool.parallelFor(static_cast<int>(paths.size()), [&](int i) {
+    const auto k = static_cast<std::size_t>(i);
+    out.runs[k] = analyzeLogFile(paths[k], options);
+  });
+
+  // Merge in input order so the floating-point sums are independent of scheduling.
+  for (const auto& run : out.runs) out.fleet.merge(run);
+  return out;
+}
+
+namespace {
+
+void appendNumber(std::string* out, double v) {
+  if (!std::isfinite(v)) {
+    out->append("null");  // JSON has no NaN/Inf
+    return;
+  }
+  char buf[32];
+  const auto res = std::to_chars(buf, buf + sizeof(buf), v);
+  out->append(buf, res.ptr);
+}
+
+void appendNumber(std::string* out, std::uint64_t v) {
+  char buf[24];
+  const auto res = std::to_chars(buf, buf + sizeof(buf), v);
+  out->append(buf, res.ptr);
+}
+
+void appendString(std::string* out, const std::string& s) {
+  out->push_back('"');
+  for (const char c : s) {
+    if (c == '"' || c == '\\') {
+      out->push_back('\\');
+      out->push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      static constexpr char kHex[] = "0123456789abcdef";
+      out->append("\\u00");
+      out->push_back(kHex[(c >> 4) & 0xf]);
+      out->push_back(kHex[c & 0xf]);
+    } else {
+      out->push_back(c);
+    }
+  }
+  out->push_back('"');
+}
+
+template <typename T, std::size_t N>
+void appendNamed(std::string* out, const char* key, const std::array<T, N>& values, const char* const (&names)[N]) {
+  out->append(",\"");
+  out->append(key);
+  out->append("\":{");
+  for (std::size_t i = 0; i < N; ++i) {
+    if (i > 0) out->push_back(',');
+    out->push_back('"');
+    out->append(names[i]);
+    out->append("\":");
+    appendNumber(out, values[i]);
+  }
+  out->push_back('}');
+}
+
+void appendStats(std::string* out, const LogStats& s) {
+  out->push_back('{');
+  if (!s.path.empty()) {
+    out->append("\"path\":");
+    appendString(out, s.path);
+    out->push_back(',');
+  }
+  out->append("\"frames\":");
+  appendNumber(out, s.frames);
+  out->append(",\"skipped_lines\":");
+  appendNumber(out, s.skipped_lines);
+  out->append(",\"duration_s\":");
+  appendNumber(out, s.duration_s);
+  out->append(",\"min_clearance_top_m\":");
+  appendNumber(out, s.min_clearance_top_m);
+  out->append(",\"min_clearance_bottom_m\":");
+  appendNumber(out, s.min_clearance_bottom_m);
+  out->append(",\"clearance_hist\":[");
+  for (std::size_t i = 0; i < s.clearance_hist.size(); ++i) {
+    if (i > 0) out->push_back(',');
+    appendNumber(out, s.clearance_hist[i]);
+  }
+  out->push_back(']');
+  appendNamed(out, "level_time_s", s.level_time_s, kLevelNames);
+  appendNamed(out, "level_frames", s.level_frames, kLevelNames);
+  appendNamed(out, "terrain_time_s", s.terrain_time_s, kTerrainNames);
+  appendNamed(out, "near_miss_events", s.near_miss_events, kCornerNames);
+  out->append(",\"stop_events\":");
+  appendNumber(out, s.stop_events);
+  if (!s.error.empty()) {
+    out->append(",\"error\":");
+    appendString(out, s.error);
+  }
+  out->push_back('}');
+}
+
+}  // namespace
+
+std::string logSummaryToJson(const LogSummary& summary) {
+  const LogStatsOptions& o = summary.options;
+  std::string out;
+  out.reserve(1024 + 512 * summary.runs.size());
+  out.append("{\"format\":\"tlf_log_summary\",\"version\":1");
+  out.append(",\"hist_min_m\":");
+  appendNumber(&out, o.hist_min_m);
+  out.append(",\"hist_bin_m\":");
+  appendNumber(&out, o.hist_bin_m);
+  out.append(",\"near_miss_m\":");
+  appendNumber(&out, o.near_miss_m);
+  out.append(",\"fleet\":");
+  appendStats(&out, summary.fleet);
+  out.append(",\"runs\":[");
+  for (std::size_t i = 0; i < summary.runs.size(); ++i) {
+    if (i > 0) out.append(",\n");
+    appendStats(&out, summary.runs[i]);
+  }
+  out.append("]}\n");
+  return out;
+}
+
+bool writeLogSummary(const std::string& path, const LogSummary& summary, std::string* error) {
+  std::ofstream f(path, std::ios::binary);
+  if (f.good()) f << logSummaryToJson(summary);
+  if (!f.good()) {
+    if (error) *error = "failed to write " + path;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace tlf
@@ -0,0 +1,179 @@
+#include "utils/LogReader.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+
+#include "utils/BinaryLog.hpp"
+
+namespace tlf {
+
+const std::vector<double>* LogColumnData::column(const std::string& name) const {
+  for (std::size_t i = 0; i < kLogColumnCount; ++i) {
+    if (name == kLogColumns[i].name) return &columns[i];
+  }
+  return nullptr;
+}
+
+LogReader::LogReader(const std::string& path) {
+  if (isBinaryLog(path)) {
+    format_ = Format::Binary;
+    binary_ = std::make_unique<BinaryLogReader>(path);
+    if (!binary_->good()) error_ = binary_->error();
+    column_names_ = binary_->columnNames();
+    return;
+  }
+
+  file_ = MappedFile(path);
+  if (!file_.good()) {
+    error_ = "cannot open " + path;
+    return;
+  }
+  if (!parseCsvHeader()) error_ = "missing CSV header";
+}
+
+LogReader::~LogReader() = default;
+
+bool LogReader::parseCsvHeader() {
+  const char* data = file_.data();
+  const std::size_t n = file_.size();
+  std::size_t end = 0;
+  while (end < n && data[end] != '\n') ++end;
+  std::size_t line_end = end;
+  if (line_end > 0 && data[line_end - 1] == '\r') --line_end;
+  if (line_end == 0) return false;
+
+  std::size_t b = 0;
+  for (std::size_t i = 0; i <= line_end; ++i) {
+    if (i == line_end || data[i] == ',') {
+      std::string name(data + b, i - b);
+      int mapped = -1;
+      for (std::size_t k = 0; k < kLogColumnCount; ++k) {
+        if (name == kLogColumns[k].name) {
+          mapped = static_cast<int>(k);
+          break;
+        }
+      }
+      column_names_.push_back(std::move(name));
+      column_map_.push_back(mapped);
+      b = i + 1;
+    }
+  }
+  pos_ = (end < n) ? end + 1 : n;
+  return true;
+}
+
+bool LogReader::parseCsvLine(const char* b, const char* e, LogRecord* r) {
+  *r = LogRecord{};
+  auto* base = reinterpret_cast<unsigned char*>(r);
+
+  std::size_t field = 0;
+  const char* p = b;
+  for (;;) {
+    const char* q = p;
+    while (q < e && *q != ',') ++q;
+    if (field >= column_map_.size()) return false;
+
+    const int mapped = column_map_[field];
+    if (mapped >= 0) {
+      const LogColumn& col = kLogColumns[static_cast<std::size_t>(mapped)];
+      if (col.type == LogColumnType::F64) {
+        double v = 0.0;
+        const auto res = std::from_chars(p, q, v);
+        if (res.ec != std::errc() || res.ptr != q) return false;
+        std::memcpy(base + col.offset, &v, sizeof(v));
+      } else {
+        std::int32_t v = 0;
+        const auto res = std::from_chars(p, q, v);
+        if (res.ec != std::errc() || res.ptr != q) return false;
+        std::memcpy(base + col.offset, &v, sizeof(v));
+      }
+    }
+    ++field;
+    if (q == e) break;
+    p = q + 1;
+  }
+  return field == column_map_.size();
+}
+
+// Consumed CSV bytes between two MappedFile::discardBefore calls.
+static constexpr std::size_t kDiscardChunkBytes = std::size_t{32} << 20;
+
+bool LogReader::next(LogRecord* r) {
+  if (!good()) return false;
+  if (binary_) {
+    const bool ok = binary_->next(r);
+    if (!binary_->good()) error_ = binary_->error();
+    return ok;
+  }
+
+  const char* data = file_.data();
+  const std::size_t n = file_.size();
+  while (pos_ < n) {
+    const char* b = data + pos_;
+    const void* nl = std::memchr(b, '\n', n - pos_);
+    const char* e = nl ? static_cast<const char*>(nl) : data + n;
+    pos_ = static_cast<std::size_t>(e - data) + (nl ? 1 : 0);
+    if (pos_ - discarded_ >= kDiscardChunkBytes) {
+      file_.discardBefore(pos_);
+      discarded_ = pos_;
+    }
+
+    if (e > b && e[-1] == '\r') --e;
+    if (e == b) continue;
+    if (parseCsvLine(b, e, r)) return true;
+    ++skipped_lines_;
+  }
+  return false;
+}
+
+LogColumnData LogReader::readColumns() {
+  LogColumnData out;
+  LogRecord r;
+  while (next(&r)) {
+    const auto* base = reinterpret_cast<const unsigned char*>(&r);
+    for (std::size_t i = 0; i < kLogColumnCount; ++i) {
+      const LogColumn& col = kLogColumns[i];
+      double v;
+      if (col.type == LogColumnType::F64) {
+        std::memcpy(&v, base + col.offset, sizeof(v));
+      } else {
+        std::int32_t iv;
+        std::memcpy(&iv, base + col.offset, sizeof(iv));
+        v = iv;
+      }
+      out.columns[i].push_back(v);
+    }
+    ++out.rows;
+  }
+  return out;
+}
+
+bool readLogFile(const std::string& path, std::vector<LogRecord>* out, std::string* error) {
+  out->clear();
+  LogReader reader(path);
+  LogRecord r;
+  while (reader.next(&r)) out->push_back(r);
+  if (error) *error = reader.error();
+  return reader.good();
+}
+
+std::vector<std::string> listLogFiles(const std::string& path) {
+  namespace fs = std::filesystem;
+  std::vector<std::string> out;
+  std::error_code ec;
+  if (!fs::is_directory(path, ec)) {
+    if (fs::exists(path, ec)) out.push_back(path);
+    return out;
+  }
+  for (fs::recursive_directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+    if (!it->is_regular_file(ec)) continue;
+    const auto ext = it->path().extension().string();
+    if (ext == ".csv" || ext == ".tlfb") out.push_back(it->path().string());
+  }
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+}  // namespace tlf
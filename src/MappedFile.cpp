@@ -0,0 +1,89 @@
+#include "utils/MappedFile.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TLF_MAPPED_FILE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tlf {
+
+MappedFile::MappedFile(const std::string& path) {
+#if defined(TLF_MAPPED_FILE_MMAP)
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  struct stat st {};
+  if (::fstat(fd, &st) == 0) {
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ == 0) {
+      ok_ = true;
+    } else {
+      void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        ::madvise(p, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(p);
+        mapped_ = true;
+        ok_ = true;
+      }
+    }
+  }
+  ::close(fd);
+  if (ok_) return;
+  size_ = 0;
+#endif
+  std::ifstream in(path, std::ios::binary);
+  if (!in.good()) return;
+  buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+  ok_ = true;
+}
+
+MappedFile::~MappedFile() { release(); }
+
+MappedFile::MappedFile(MappedFile&& o) noexcept { *this = std::move(o); }
+
+MappedFile& MappedFile::operator=(MappedFile&& o) noexcept {
+  if (this == &o) return *this;
+  release();
+  buffer_ = std::move(o.buffer_);
+  mapped_ = o.mapped_;
+  ok_ = o.ok_;
+  size_ = o.size_;
+  data_ = mapped_ ? o.data_ : buffer_.data();
+  o.data_ = nullptr;
+  o.size_ = 0;
+  o.ok_ = false;
+  o.mapped_ = false;
+  return *this;
+}
+
+void MappedFile::discardBefore(std::size_t offset) {
+#if defined(TLF_MAPPED_FILE_MMAP)
+  if (!mapped_) return;
+  const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  const std::size_t len = std::min(offset, size_) / page * page;
+  if (len > 0) ::madvise(const_cast<char*>(data_), len, MADV_DONTNEED);
+#else
+  (void)offset;
+#endif
+}
+
+void MappedFile::release() {
+#if defined(TLF_MAPPED_FILE_MMAP)
+  if (mapped_) ::munmap(const_cast<char*>(data_), size_);
+#endif
+  mapped_ = false;
+  data_ = nullptr;
+  size_ = 0;
+  ok_ = false;
+  buffer_.clear();
+}
+
+}  // namespace tlf
@@ -0,0 +1,35 @@
+#include "sim/Plant.hpp"
+
+namespace tlf::sim {
+
+void PlantBatch::resize(std::size_t lanes) {
+  for (auto* v : {&dt_s, &base_speed_m_s, &accel_limit_m_s2, &time_s, &s_m, &lift_m, &tilt_rad, &speed_m_s, &pitch_rad,
+                  &cmd_lift_m, &cmd_lift_rate_m_s, &cmd_tilt_rad, &cmd_tilt_rate_rad_s, &cmd_speed_limit_m_s}) {
+    v->assign(lanes, 0.0);
+  }
+}
+
+void PlantBatch::step(const unsigned char* active) {
+  const std::size_t n = size();
+  for (std::size_t i = 0; i < n; ++i) {
+    // Same arithmetic as Plant::step, written with selects so inactive lanes keep their state.
+    const double dt = dt_s[i];
+    const double lift_lim = cmd_lift_rate_m_s[i] * dt;
+    const double tilt_lim = cmd_tilt_rate_rad_s[i] * dt;
+    const double lift_next = lift_m[i] + Plant::clampTo(cmd_lift_m[i] - lift_m[i], lift_lim);
+    const double tilt_next = tilt_rad[i] + Plant::clampTo(cmd_tilt_rad[i] - tilt_rad[i], tilt_lim);
+
+    const double target = std::min(base_speed_m_s[i], cmd_speed_limit_m_s[i]);
+    const double accel = accel_limit_m_s2[i];
+    const double speed_next = (accel > 0.0) ? speed_m_s[i] + Plant::clampTo(target - speed_m_s[i], accel * dt) : target;
+
+    const bool a = active[i] != 0;
+    lift_m[i] = a ? lift_next : lift_m[i];
+    tilt_rad[i] = a ? tilt_next : tilt_rad[i];
+    speed_m_s[i] = a ? speed_next : speed_m_s[i];
+    s_m[i] = a ? s_m[i] + speed_next * dt : s_m[i];
+    time_s[i] = a ? time_s[i] + dt : time_s[i];
+  }
+}
+
+}  // namespace tlf::sim
@@ -0,0 +1,108 @@
+#include "utils/Replay.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include "utils/LogReader.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace tlf {
+
+namespace {
+
+int levelIndex(std::int32_t level) { return std::clamp<int>(level, 0, 3); }
+
+}  // namespace
+
+ControlInput controlInputFromRecord(const LogRecord& r, double dt_s, const ReplayOptions& opt) {
+  ControlInput in;
+  in.dt_s = dt_s;
+  in.s_m = r.s_m;
+  in.pitch_rad = r.pitch_rad;
+  in.pitch_rate_rad_s = r.pitch_rate_rad_s;
+  in.terrain = static_cast<TerrainState>(r.terrain_state);
+  in.lift_pos_m = r.lift_m;
+  in.tilt_rad = r.tilt_rad;
+  in.env.ceiling_z_m = r.ceiling_z_m;
+  in.env.floor_z_m = r.floor_z_m;
+  in.rack = opt.rack;
+  in.forklift = opt.forklift;
+  in.inputs_valid = true;
+  return in;
+}
+
+ReplayResult replayRecords(const std::vector<LogRecord>& records, const ReplayOptions& opt) {
+  ReplayResult res;
+  res.ok = true;
+  res.frames = records.size();
+
+  constexpr double kInf = std::numeric_limits<double>::infinity();
+  res.recorded_min_clearance_top_m = res.recorded_min_clearance_bottom_m = kInf;
+  res.replay_min_clearance_top_m = res.replay_min_clearance_bottom_m = kInf;
+
+  auto controller = makeController(opt.kind, opt.config);
+  controller->reset();
+
+  ControlOutput out;
+  double prev_time = 0.0;
+  for (std::size_t k = 0; k < records.size(); ++k) {
+    const LogRecord& r = records[k];
+    // Controllers stamp time after adding dt, so the first frame's time is its own dt.
+    const double dt = r.time_s - prev_time;
+    prev_time = r.time_s;
+
+    controller->step(controlInputFromRecord(r, (dt > 1e-6 && std::isfinite(dt)) ? dt : opt.fallback_dt_s, opt), out);
+
+    const double d_lift = std::abs(out.cmd.lift_target_m - r.lift_cmd_m);
+    const double d_tilt = std::abs(out.cmd.tilt_target_rad - r.tilt_cmd_rad);
+    const double d_speed = std::abs(out.cmd.speed_limit_m_s - r.speed_limit_m_s);
+    res.max_lift_diff_m = std::max(res.max_lift_diff_m, d_lift);
+    res.max_tilt_diff_rad = std::max(res.max_tilt_diff_rad, d_tilt);
+    res.max_speed_diff_m_s = std::max(res.max_speed_diff_m_s, d_speed);
+
+    // Written as !(d <= tol) so NaN commands count as differences.
+    const bool cmd_diff = !(d_lift <= opt.lift_tol_m) || !(d_tilt <= opt.tilt_tol_rad) || !(d_speed <= opt.speed_tol_m_s);
+    const bool safety_diff = static_cast<std::int32_t>(out.safety.level) != r.safety_level;
+    if (cmd_diff) ++res.command_diff_frames;
+    if (safety_diff) ++res.safety_diff_frames;
+    if ((cmd_diff || safety_diff) && res.first_diff_frame < 0) res.first_diff_frame = static_cast<long>(k);
+
+    ++res.replay_level_counts[levelIndex(static_cast<std::int32_t>(out.safety.level))];
+    ++res.recorded_level_counts[levelIndex(r.safety_level)];
+
+    res.recorded_min_clearance_top_m = std::min(res.recorded_min_clearance_top_m, r.clearance_top_m);
+    res.recorded_min_clearance_bottom_m = std::min(res.recorded_min_clearance_bottom_m, r.clearance_bottom_m);
+    res.replay_min_clearance_top_m = std::min(res.replay_min_clearance_top_m, out.safety.clearance_top_m);
+    res.replay_min_clearance_bottom_m = std::min(res.replay_min_clearance_bottom_m, out.safety.clearance_bottom_m);
+  }
+  return res;
+}
+
+ReplayResult replayFile(const std::string& path, const ReplayOptions& opt) {
+  std::vector<LogRecord> records;
+  std::string error;
+  ReplayResult res;
+  if (!readLogFile(path, &records, &error)) {
+    res.error = error;
+  } else {
+    res = replayRecords(records, opt);
+  }
+  res.path = path;
+  return res;
+}
+
+std::vector<ReplayResult> replayFiles(const std::vector<std::string>& paths, const ReplayOptions& opt, int threads) {
+  if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  threads = std::min<int>(threads, static_cast<int>(std::max<std::size_t>(1, paths.size())));
+
+  std::vector<ReplayResult> results(paths.size());
+  ThreadPool pool(threads);
+  pool.parallelFor(static_cast<int>(paths.size()), [&](int i) {
+    results[static_cast<std::size_t>(i)] = replayFile(paths[static_cast<std::size_t>(i)], opt);
+  });
+  return results;
+}
+
+}  // namespace tlf
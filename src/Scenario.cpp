@@ -0,0 +1,193 @@
+#include "sim/Scenario.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tlf::sim {
+
+namespace {
+
+double clamp(double v, double lo, double hi) { return std::max(lo, std::min(hi, v)); }
+
+// splitmix64: tiny, portable and good enough to spread Monte-Carlo seeds.
+std::uint64_t splitmix64(std::uint64_t* state) {
+  std::uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+// Uniform in [-1, 1).
+double symmetricUniform(std::uint64_t* state) {
+  return static_cast<double>(splitmix64(state) >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+}  // namespace
+
+double floorZAtX(const DockingEnv& e, double x_m) {
+  if (e.ramp_len_m <= 0.0) {
+    // Unbounded ramp outside, flat container floor inside.
+    if (x_m < e.door_x_m) return std::tan(e.ramp_slope_deg * M_PI / 180.0) * (x_m - e.door_x_m);
+    return 0.0;
+  }
+
+  const double h = std::tan(e.ramp_slope_deg * M_PI / 180.0) * e.ramp_len_m;
+  const double groundZ = -h;
+  const double rampStartX = e.door_x_m - e.ramp_len_m;
+
+  // inside container (extends +x from door)
+  if (x_m >= e.door_x_m && x_m <= (e.door_x_m + e.container_len_m)) return 0.0;
+
+  // on ground beyond ramp start (further outside)
+  if (x_m <= rampStartX) return groundZ;
+
+  // on ramp: interpolate between rampStartX (groundZ) and door (0)
+  if (x_m > rampStartX && x_m < e.door_x_m) {
+    const double t = (x_m - rampStartX) / (e.door_x_m - rampStartX);
+    return (1.0 - t) * groundZ + t * 0.0;
+  }
+
+  // outside (beyond container far end): assume container floor
+  return 0.0;
+}
+
+double ceilingZAtX(const DockingEnv& e, double x_m) {
+  // Inside container: use container ceiling height
+  if (x_m >= e.door_x_m && x_m <= (e.door_x_m + e.container_len_m)) return e.container_h_m;
+  // Outside container: use a conservative “virtual ceiling” equal to the door height.
+  // This prevents the controller from drifting upward to center within an unrealistically high outside ceiling,
+  // which can later cause a hard ceiling strike as the front of the load enters the container region.
+  return e.container_h_m;
+}
+
+TerrainProfile buildTerrainProfile(const DockingEnv& e) {
+  TerrainProfile p;
+  if (e.ramp_len_m <= 0.0) {
+    // Unbounded ramp: extend it far enough behind the door for any realistic run.
+    constexpr double kRampExtent = 1000.0;
+    const double slope = std::tan(e.ramp_slope_deg * M_PI / 180.0);
+    p.floor = PiecewiseLinear({e.door_x_m - kRampExtent, e.door_x_m}, {-slope * kRampExtent, 0.0});
+  } else {
+    const double h = std::tan(e.ramp_slope_deg * M_PI / 180.0) * e.ramp_len_m;
+    const double rampStartX = e.door_x_m - e.ramp_len_m;
+    p.floor = PiecewiseLinear({rampStartX, e.door_x_m}, {-h, 0.0});
+  }
+  p.ceiling = PiecewiseLinear(e.container_h_m);
+  return p;
+}
+
+double pitchFromWheelContact(const DockingEnv& e, double mast_x_m, double wheelbase_m, double rear_to_mast_m) {
+  // Vehicle heads +x into container: wheels are behind mast in -x.
+  // "Near" wheel is closer to mast (more forward), "far" wheel is further outside.
+  const double x_near = mast_x_m - rear_to_mast_m;
+  const double x_far = x_near - wheelbase_m;
+  const double z_near = floorZAtX(e, x_near);
+  const double z_far = floorZAtX(e, x_far);
+  return std::atan2(z_near - z_far, x_near - x_far);
+}
+
+TerrainState terrainFromPitch(double pitch_rad) {
+  const double deg = std::abs(pitch_rad) * 180.0 / M_PI;
+  if (deg < 0.5) return TerrainState::Ground;
+  return TerrainState::OnRamp;
+}
+
+TerrainState scriptedTerrainFromS(const DockingEnv& e, double s_m) {
+  const double x = s_m - e.door_x_m;
+  if (x < -1.2) return TerrainState::Ground;
+  if (x < -0.6) return TerrainState::FrontOnRamp;
+  if (x < -0.1) return TerrainState::OnRamp;
+  if (x < 0.5) return TerrainState::FrontInContainerRearOnRamp;
+  return TerrainState::InContainer;
+}
+
+double scriptedPitch(const DockingEnv& e, TerrainState t, double s_m) {
+  const double ramp = e.ramp_slope_deg * M_PI / 180.0;
+  switch (t) {
+    case TerrainState::Ground:
+      return 0.0;
+    case TerrainState::FrontOnRamp:
+    case TerrainState::OnRamp:
+      return ramp;
+    case TerrainState::FrontInContainerRearOnRamp: {
+      const double x = s_m - e.door_x_m;
+      const double t01 = clamp((x - (-0.1)) / (0.6), 0.0, 1.0);
+      return (1.0 - t01) * ramp;
+    }
+    case TerrainState::InContainer:
+    default:
+      return 0.0;
+  }
+}
+
+Scenario vizRampScenario() {
+  Scenario sc;
+  sc.env.container_h_m = 2.5;
+  sc.env.ramp_len_m = 0.0;
+  sc.env.ramp_slope_deg = 4.0;
+  sc.pitch_model = PitchModel::Scripted;
+  sc.use_profile = false;
+
+  sc.rack = RackParams{2.3, 2.3, {0.3, -0.15}};
+  sc.forklift = ForkliftParams{};
+
+  sc.dt_s = 0.02;
+  sc.base_speed_m_s = 0.35;
+  sc.accel_limit_m_s2 = 0.0;
+
+  sc.start_s_m = -1.5;
+  sc.start_lift_m = 1.00;
+  sc.end_s_m = 1.6;
+  sc.max_steps = 900;
+  return sc;
+}
+
+ControllerConfig dockingDemoConfig(ControllerKind kind) {
+  ControllerConfig cfg;
+  // Keep more headroom to the ceiling throughout.
+  // Note: total required (top+bottom) margin must remain physically feasible given rack height.
+  cfg.margin_top_m = 0.12;
+  cfg.margin_bottom_m = 0.04;
+  // Start slowing down earlier when clearance gets tight.
+  cfg.warn_threshold_m = 0.18;
+
+  cfg.search_lift_half_range_m = 0.20;
+  cfg.search_tilt_half_range_rad = 0.25;
+  cfg.grid_lift_steps = 41;
+  cfg.grid_tilt_steps = 41;
+
+  // No lookahead for this simple open-loop sim.
+  // With a tall load near the doorway, enforcing feasibility at both s and (s + lookahead)
+  // using the same (lift, tilt) can be overly conservative and lead to stalling.
+  cfg.lookahead_s_m = 0.0;
+
+  // If using MPC in this sim, give it a reasonable forward-speed guess for s prediction.
+  // (The plant actually advances using min(v, speed_limit).)
+  if (kind == ControllerKind::MPC) {
+    cfg.mpc_assumed_forward_speed_m_s = 0.1;
+  }
+
+  cfg.base_lift_rate_limit_m_s = 0.18;
+  cfg.base_tilt_rate_limit_rad_s = 0.28;
+  return cfg;
+}
+
+Scenario randomizedScenario(const Scenario& base, const ScenarioSpread& spread, std::uint64_t seed) {
+  std::uint64_t state = seed;
+  auto jitter = [&](double half_width) { return half_width * symmetricUniform(&state); };
+
+  Scenario sc = base;
+  // Every draw happens in a fixed order so a seed always maps to the same scenario.
+  sc.env.ramp_slope_deg = std::max(0.0, base.env.ramp_slope_deg + jitter(spread.ramp_slope_deg));
+  const double ramp_len_draw = jitter(spread.ramp_len_m);
+  if (base.env.ramp_len_m > 0.0) sc.env.ramp_len_m = std::max(0.1, base.env.ramp_len_m + ramp_len_draw);
+  sc.env.container_h_m = base.env.container_h_m + jitter(spread.container_h_m);
+  sc.rack.height_m = base.rack.height_m + jitter(spread.rack_height_m);
+  sc.rack.length_m = std::max(0.1, base.rack.length_m + jitter(spread.rack_length_m));
+  sc.rack.mount_offset_m.x = base.rack.mount_offset_m.x + jitter(spread.mount_x_m);
+  sc.start_lift_m = std::max(0.0, base.start_lift_m + jitter(spread.start_lift_m));
+  sc.base_speed_m_s = base.base_speed_m_s * std::max(0.05, 1.0 + jitter(spread.base_speed_frac));
+  return sc;
+}
+
+}  // namespace tlf::sim
@@ -0,0 +1,370 @@
+#include "controller/SearchCore.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
+namespace tlf {
+
+static constexpr double kClearanceEpsilonM = 5e-4;
+
+static double clamp(double v, double lo, double hi) {
+  return std::max(lo, std::min(hi, v));
+}
+
+bool inputsFinite(const ControlInput& in) {
+  auto finite = [](double v) { return std::isfinite(v); };
+  return finite(in.dt_s) && finite(in.pitch_rad) && finite(in.pitch_rate_rad_s) && finite(in.s_m) &&
+         finite(in.lift_pos_m) && finite(in.tilt_rad) && finite(in.rack.height_m) && finite(in.rack.length_m) &&
+         finite(in.rack.mount_offset_m.x) && finite(in.rack.mount_offset_m.z);
+}
+
+bool validateConfig(const ControllerConfig& cfg, std::string* error) {
+  auto fail = [&](const char* field) {
+    if (error) *error = std::string("invalid ControllerConfig::") + field;
+    return false;
+  };
+  const struct {
+    const char* name;
+    double value;
+  } finite_fields[] = {
+      {"margin_top_m", cfg.margin_top_m},
+      {"margin_bottom_m", cfg.margin_bottom_m},
+      {"warn_threshold_m", cfg.warn_threshold_m},
+      {"hard_threshold_m", cfg.hard_threshold_m},
+      {"lookahead_s_m", cfg.lookahead_s_m},
+      {"w_center", cfg.w_center},
+      {"w_dl", cfg.w_dl},
+      {"w_dt", cfg.w_dt},
+      {"w_smooth", cfg.w_smooth},
+      {"base_speed_limit_m_s", cfg.base_speed_limit_m_s},
+      {"min_speed_limit_m_s", cfg.min_speed_limit_m_s},
+      {"pitch_rate_jitter_threshold_rad_s", cfg.pitch_rate_jitter_threshold_rad_s},
+      {"mpc_assumed_forward_speed_m_s", cfg.mpc_assumed_forward_speed_m_s},
+      {"mpc_use_pitch_rate_prediction", cfg.mpc_use_pitch_rate_prediction},
+  };
+  for (const auto& f : finite_fields) {
+    if (!std::isfinite(f.value)) return fail(f.name);
+  }
+  // Must be finite and >= 0 (> 0 where positive is set).
+  const struct {
+    const char* name;
+    double value;
+    bool positive;
+  } range_fields[] = {
+      {"search_lift_half_range_m", cfg.search_lift_half_range_m, false},
+      {"search_tilt_half_range_rad", cfg.search_tilt_half_range_rad, false},
+      {"clearance_cache_quantum_m", cfg.clearance_cache_quantum_m, false},
+      {"clearance_cache_quantum_rad", cfg.clearance_cache_quantum_rad, false},
+      {"reuse_threshold_s_m", cfg.reuse_threshold_s_m, false},
+      {"reuse_threshold_pitch_rad", cfg.reuse_threshold_pitch_rad, false},
+      {"reuse_threshold_lift_m", cfg.reuse_threshold_lift_m, false},
+      {"reuse_threshold_tilt_rad", cfg.reuse_threshold_tilt_rad, false},
+      {"base_lift_rate_limit_m_s", cfg.base_lift_rate_limit_m_s, true},
+      {"base_tilt_rate_limit_rad_s", cfg.base_tilt_rate_limit_rad_s, true},
+      {"degraded_margin_multiplier", cfg.degraded_margin_multiplier, true},
+      {"degraded_rate_multiplier", cfg.degraded_rate_multiplier, true},
+      {"degraded_speed_multiplier", cfg.degraded_speed_multiplier, true},
+  };
+  for (const auto& f : range_fields) {
+    if (!std::isfinite(f.value) || f.value < 0.0 || (f.positive && f.value == 0.0)) return fail(f.name);
+  }
+  if (cfg.warn_threshold_m < cfg.hard_threshold_m) return fail("warn_threshold_m");
+
+  const struct {
+    const char* name;
+    int value;
+    int min;
+  } int_fields[] = {
+      {"grid_lift_steps", cfg.grid_lift_steps, 1},
+      {"grid_tilt_steps", cfg.grid_tilt_steps, 1},
+      {"coarse_grid_steps", cfg.coarse_grid_steps, 4},  // 3 never narrows the window
+      {"refine_levels", cfg.refine_levels, 0},
+      {"local_refine_iterations", cfg.local_refine_iterations, 0},
+      {"local_refine_evals", cfg.local_refine_evals, 2},  // a golden-section step needs two points
+      {"clearance_cache_capacity", cfg.clearance_cache_capacity, 0},
+      {"step_time_budget_us", cfg.step_time_budget_us, 0},
+      {"mpc_horizon_steps", cfg.mpc_horizon_steps, 1},
+      {"mpc_beam_width", cfg.mpc_beam_width, 1},
+      {"mpc_num_threads", cfg.mpc_num_threads, 1},
+  };
+  for (const auto& f : int_fields) {
+    if (f.value < f.min) return fail(f.name);
+  }
+  return true;
+}
+
+static ConfigTables::Limits scaledLimits(const ControllerConfig& cfg, bool degraded) {
+  const double margin_mult = degraded ? cfg.degraded_margin_multiplier : 1.0;
+  const double rate_mult = degraded ? cfg.degraded_rate_multiplier : 1.0;
+  ConfigTables::Limits l;
+  l.margin_top_m = cfg.margin_top_m * margin_mult;
+  l.margin_bottom_m = cfg.margin_bottom_m * margin_mult;
+  l.lift_rate_limit_m_s = cfg.base_lift_rate_limit_m_s * rate_mult;
+  l.tilt_rate_limit_rad_s = cfg.base_tilt_rate_limit_rad_s * rate_mult;
+  l.speed_mult = degraded ? cfg.degraded_speed_multiplier : 1.0;
+  return l;
+}
+
+static void axisFractions(std::vector<double>& t, int n) {
+  t.resize(static_cast<size_t>(n));
+  for (int i = 0; i < n; ++i) {
+    t[static_cast<size_t>(i)] = (n == 1) ? 0.0 : static_cast<double>(i) / static_cast<double>(n - 1);
+  }
+}
+
+void makeConfigTables(const ControllerConfig& cfg, ConfigTables* tables) {
+  tables->nominal = scaledLimits(cfg, false);
+  tables->degraded = scaledLimits(cfg, true);
+  tables->pitch_rate_jitter_threshold_rad_s = cfg.pitch_rate_jitter_threshold_rad_s;
+  tables->use_lookahead = cfg.lookahead_s_m > 1e-9;
+  tables->lookahead_s_m = std::max(0.0, cfg.lookahead_s_m);
+
+  tables->grid_lift_steps = std::max(3, cfg.grid_lift_steps);
+  tables->grid_tilt_steps = std::max(3, cfg.grid_tilt_steps);
+  tables->coarse_grid_steps = std::max(4, cfg.coarse_grid_steps);
+  axisFractions(tables->grid_lift_t, tables->grid_lift_steps);
+  axisFractions(tables->grid_tilt_t, tables->grid_tilt_steps);
+  axisFractions(tables->coarse_t, tables->coarse_grid_steps);
+}
+
+// Input-dependent part of makeStepLimits, shared by both overloads.
+static StepLimits stepLimitsFrom(const ConfigTables::Limits& nominal,
+                                 const ConfigTables::Limits& degraded,
+                                 double pitch_rate_jitter_threshold_rad_s,
+                                 bool use_lookahead,
+                                 double lookahead_s_m,
+                                 const ControlInput& in) {
+  StepLimits l;
+  l.dt_s = (in.dt_s > 1e-6 && std::isfinite(in.dt_s)) ? in.dt_s : 0.02;
+
+  if (!in.inputs_valid || !inputsFinite(in) || !(l.dt_s > 0.0)) {
+    l.degraded = true;
+    l.degraded_code = SafetyCode::InputInvalid;
+  } else if (std::abs(in.pitch_rate_rad_s) > pitch_rate_jitter_threshold_rad_s) {
+    l.degraded = true;
+    l.degraded_code = SafetyCode::PitchJitter;
+  }
+
+  const ConfigTables::Limits& s = l.degraded ? degraded : nominal;
+  l.margin_top_m = s.margin_top_m;
+  l.margin_bottom_m = s.margin_bottom_m;
+  l.lift_rate_limit_m_s = s.lift_rate_limit_m_s;
+  l.tilt_rate_limit_rad_s = s.tilt_rate_limit_rad_s;
+  l.speed_mult = s.speed_mult;
+
+  l.use_lookahead = use_lookahead;
+  l.s_look_m = in.s_m + lookahead_s_m;
+  return l;
+}
+
+StepLimits makeStepLimits(const ConfigTables& tables, const ControlInput& in) {
+  return stepLimitsFrom(tables.nominal, tables.degraded, tables.pitch_rate_jitter_threshold_rad_s,
+                        tables.use_lookahead, tables.lookahead_s_m, in);
+}
+
+StepLimits makeStepLimits(const ControllerConfig& cfg, const ControlInput& in) {
+  return stepLimitsFrom(scaledLimits(cfg, false), scaledLimits(cfg, true), cfg.pitch_rate_jitter_threshold_rad_s,
+                        cfg.lookahead_s_m > 1e-9, std::max(0.0, cfg.lookahead_s_m), in);
+}
+
+ClearanceResult worstCaseClearance(const ClearanceResult& now, const ClearanceResult& ahead) {
+  ClearanceResult out = now;
+
+  if (ahead.clearance_top_m < now.clearance_top_m) {
+    out.clearance_top_m = ahead.clearance_top_m;
+    out.top_worst_point = ahead.top_worst_point;
+  }
+  if (ahead.clearance_bottom_m < now.clearance_bottom_m) {
+    out.clearance_bottom_m = ahead.clearance_bottom_m;
+    out.bottom_worst_point = ahead.bottom_worst_point;
+  }
+
+  out.worst_point = (out.clearance_top_m < out.clearance_bottom_m) ? out.top_worst_point : out.bottom_worst_point;
+  return out;
+}
+
+CurrentPose evaluateCurrentPose(ClearanceCache& cache, const ControlInput& in, const StepLimits& limits) {
+  // The safety level rests on these two poses, so a quantizing cache (which may answer with a nearby
+  // pose from an earlier step) is bypassed; only an exact-key cache is allowed to serve them.
+  auto eval = [&](double s_m) {
+    if (cache.exact()) {
+      return cache.evaluate(s_m, in.lift_pos_m, in.pitch_rad, in.tilt_rad, in.env, in.rack, in.forklift,
+                            limits.margin_top_m, limits.margin_bottom_m);
+    }
+    return computeClearances(computeRackCorners2D(s_m, in.lift_pos_m, in.pitch_rad, in.tilt_rad, in.env, in.rack, in.forklift),
+                             in.env, limits.margin_top_m, limits.margin_bottom_m);
+  };
+  CurrentPose p;
+  p.now = eval(in.s_m);
+  p.worst = p.now;
+  if (limits.use_lookahead) p.worst = worstCaseClearance(p.now, eval(limits.s_look_m));
+  return p;
+}
+
+void fillPoseDebug(const ControlInput& in, DebugFrame& dbg) {
+  dbg.corners = computeRackCorners2D(in.s_m, in.lift_pos_m, in.pitch_rad, in.tilt_rad, in.env, in.rack, in.forklift);
+  dbg.ceiling_z_m = envCeilingZAtX(in.env, in.s_m);
+  dbg.floor_z_m = envFloorZAtX(in.env, in.s_m);
+}
+
+SafetyStatus makeSafety(const ControllerConfig& cfg,
+                        double clearance_top_m,
+                        double clearance_bottom_m,
+                        CornerId worst,
+                        bool degraded,
+                        SafetyCode code_override) {
+  SafetyStatus s;
+  s.clearance_top_m = clearance_top_m;
+  s.clearance_bottom_m = clearance_bottom_m;
+  s.worst_point = worst;
+
+  if (degraded) {
+    s.level = SafetyLevel::DEGRADED;
+    s.code = (code_override == SafetyCode::None) ? SafetyCode::InputInvalid : code_override;
+    s.message = toString(s.code);
+    return s;
+  }
+
+  const double min_clear = std::min(clearance_top_m, clearance_bottom_m);
+
+  // Allow a tiny tolerance to prevent numerical noise from causing STOP.
+  if (min_clear < (cfg.hard_threshold_m - kClearanceEpsilonM)) {
+    s.level = SafetyLevel::STOP;
+    s.code = (code_override == SafetyCode::None) ? SafetyCode::ClearanceHardViolated : code_override;
+    s.message = toString(s.code);
+    return s;
+  }
+
+  if (min_clear < cfg.warn_threshold_m) {
+    s.level = SafetyLevel::WARN;
+    s.code = (code_override == SafetyCode::None) ? SafetyCode::ClearanceSoftNear : code_override;
+    s.message = toString(s.code);
+    return s;
+  }
+
+  s.level = SafetyLevel::OK;
+  s.code = SafetyCode::None;
+
+  // Allow non-fatal diagnostic codes even when geometrically OK.
+  if (code_override != SafetyCode::None) {
+    s.code = code_override;
+  }
+  s.message = toString(s.code);
+  return s;
+}
+
+void composeCommand(const ControllerConfig& cfg,
+                    const StepLimits& limits,
+                    const ControlInput& in,
+                    const CurrentPose& pose,
+                    double lift_target_m,
+                    double tilt_target_rad,
+                    SafetyCode search_code,
+                    ControlOutput& out) {
+  // Targets are positions, rate limits are provided.
+  out.cmd.lift_target_m = lift_target_m;
+  out.cmd.tilt_target_rad = tilt_target_rad;
+  out.cmd.lift_rate_limit_m_s = limits.lift_rate_limit_m_s;
+  out.cmd.tilt_rate_limit_rad_s = limits.tilt_rate_limit_rad_s;
+
+  // Simple speed policy: reduce as min clearance approaches 0, and when pitch_rate is high.
+  const double top = pose.worst.clearance_top_m;
+  const double bottom = pose.worst.clearance_bottom_m;
+  const double min_clear = std::min(top, bottom);
+  const double clearance_factor = clamp(min_clear / cfg.warn_threshold_m, 0.0, 1.0);
+  const double pitch_rate_factor =
+      clamp(1.0 - (std::abs(in.pitch_rate_rad_s) / (2.0 * cfg.pitch_rate_jitter_threshold_rad_s)), 0.2, 1.0);
+  const double base_speed = cfg.base_speed_limit_m_s * limits.speed_mult;
+  double speed = base_speed * std::min(clearance_factor, pitch_rate_factor);
+  if (min_clear >= (cfg.hard_threshold_m - kClearanceEpsilonM)) {
+    speed = std::max(speed, cfg.min_speed_limit_m_s * limits.speed_mult * pitch_rate_factor);
+  } else {
+    speed = 0.0;
+  }
+  out.cmd.speed_limit_m_s = speed;
+
+  if (limits.degraded) {
+    out.safety = makeSafety(cfg, top, bottom, pose.worst.worst_point, true, limits.degraded_code);
+  } else {
+    out.safety = makeSafety(cfg, top, bottom, pose.worst.worst_point, false, search_code);
+  }
+}
+
+double smoothedRate(double target, double current, double dt, double limit) {
+  return clamp((target - current) / dt, -limit, limit);
+}
+
+MaxMinClearancePick maxMinClearanceGrid(const ControlInput& in,
+                                        const StepLimits& limits,
+                                        const std::vector<double>& lifts,
+                                        const std::vector<double>& tilts,
+                                        double default_lift_m,
+                                        double default_tilt_rad,
+                                        Deadline& deadline,
+                                        ClearanceBatch* batch,
+                                        ClearanceBatch* batch_ahead) {
+  MaxMinClearancePick best{-std::numeric_limits<double>::infinity(), default_lift_m, default_tilt_rad, 0};
+  const size_t nL = lifts.size();
+  const size_t nT = tilts.size();
+
+  // Worst case of entry k over now / lookahead (batches as filled below).
+  auto minClearanceAt = [&](size_t k) {
+    double top_w = batch->clearance_top_m[k];
+    double bot_w = batch->clearance_bottom_m[k];
+    if (limits.use_lookahead) {
+      top_w = std::min(top_w, batch_ahead->clearance_top_m[k]);
+      bot_w = std::min(bot_w, batch_ahead->clearance_bottom_m[k]);
+    }
+    return std::min(top_w, bot_w);
+  };
+  auto evaluate = [&](const double* tilt, size_t n_tilt) {
+    computeClearancesBatch(in.s_m, lifts.data(), nL, tilt, n_tilt, in.pitch_rad, in.env, in.rack, in.forklift,
+                           limits.margin_top_m, limits.margin_bottom_m, batch);
+    if (limits.use_lookahead) {
+      computeClearancesBatch(limits.s_look_m, lifts.data(), nL, tilt, n_tilt, in.pitch_rad, in.env, in.rack,
+                             in.forklift, limits.margin_top_m, limits.margin_bottom_m, batch_ahead);
+    }
+    best.evaluated += static_cast<int>(nL * n_tilt);
+  };
+
+  if (!deadline.active()) {
+    evaluate(tilts.data(), nT);
+    for (size_t i = 0; i < nL; ++i) {
+      for (size_t j = 0; j < nT; ++j) {
+        const double min_clear = minClearanceAt(batch->index(i, j));
+        if (min_clear > best.min_clearance_m) {
+          best.min_clearance_m = min_clear;
+          best.lift_m = lifts[i];
+          best.tilt_rad = tilts[j];
+        }
+      }
+    }
+    return best;
+  }
+
+  // Rows from the middle outwards; ties go to the lower lift-major index like in the full pass.
+  size_t best_key = 0;  // no tie can win before a first pick
+  const long j0 = (static_cast<long>(nT) - 1) / 2;
+  for (long r = 0; r < 2 * static_cast<long>(nT); ++r) {
+    const long jr = j0 + ((r % 2 == 0) ? r / 2 : -(r + 1) / 2);
+    if (jr < 0 || jr >= static_cast<long>(nT)) continue;
+    if (deadline.expired()) break;
+    const size_t j = static_cast<size_t>(jr);
+    evaluate(&tilts[j], 1);
+    for (size_t i = 0; i < nL; ++i) {
+      const double min_clear = minClearanceAt(batch->index(i, 0));
+      const size_t key = i * nT + j;
+      if (min_clear > best.min_clearance_m || (min_clear == best.min_clearance_m && key < best_key)) {
+        best.min_clearance_m = min_clear;
+        best.lift_m = lifts[i];
+        best.tilt_rad = tilts[j];
+        best_key = key;
+      }
+    }
+  }
+  return best;
+}
+
+}  // namespace tlf
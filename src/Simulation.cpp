@@ -0,0 +1,216 @@
+#include "sim/Simulation.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+#include "utils/ThreadPool.hpp"
+
+namespace tlf::sim {
+
+namespace {
+
+void beginSummary(RunSummary* sum) {
+  *sum = RunSummary{};
+  sum->min_clearance_top_m = std::numeric_limits<double>::infinity();
+  sum->min_clearance_bottom_m = std::numeric_limits<double>::infinity();
+}
+
+// Books one finished step (plant already advanced); true when the run reached its end.
+bool recordStep(const Scenario& sc, const SafetyStatus& safety, const PlantState& st, RunSummary* sum) {
+  ++sum->steps;
+  sum->min_clearance_top_m = std::min(sum->min_clearance_top_m, safety.clearance_top_m);
+  sum->min_clearance_bottom_m = std::min(sum->min_clearance_bottom_m, safety.clearance_bottom_m);
+  switch (safety.level) {
+    case SafetyLevel::WARN:
+      ++sum->warn_steps;
+      break;
+    case SafetyLevel::STOP:
+      ++sum->stop_steps;
+      break;
+    case SafetyLevel::DEGRADED:
+      ++sum->degraded_steps;
+      break;
+    default:
+      break;
+  }
+  if (sum->time_to_door_s < 0.0 && st.s_m >= sc.env.door_x_m) sum->time_to_door_s = st.time_s;
+
+  if (st.s_m > sc.end_s_m) {
+    sum->completed = true;
+    sum->time_to_end_s = st.time_s;
+    return true;
+  }
+  return false;
+}
+
+PlantState initialState(const Scenario& sc) {
+  PlantState st;
+  st.s_m = sc.start_s_m;
+  st.lift_m = sc.start_lift_m;
+  st.tilt_rad = sc.start_tilt_rad;
+  return st;
+}
+
+PlantParams plantParams(const Scenario& sc) { return PlantParams{sc.dt_s, sc.base_speed_m_s, sc.accel_limit_m_s2}; }
+
+std::shared_ptr<const TerrainProfile> scenarioProfile(const Scenario& sc) {
+  if (!sc.use_profile) return nullptr;
+  return std::make_shared<const TerrainProfile>(buildTerrainProfile(sc.env));
+}
+
+}  // namespace
+
+ControlInput scenarioInput(const Scenario& sc,
+                           const PlantState& st,
+                           const std::shared_ptr<const TerrainProfile>& profile,
+                           double* pitch_rad) {
+  const double dt = sc.dt_s;
+
+  double pitch = 0.0;
+  TerrainState terr = TerrainState::Ground;
+  if (sc.pitch_model == PitchModel::Scripted) {
+    terr = scriptedTerrainFromS(sc.env, st.s_m);
+    pitch = scriptedPitch(sc.env, terr, st.s_m);
+  } else {
+    pitch = pitchFromWheelContact(sc.env, st.s_m, sc.wheelbase_m, sc.rear_to_mast_m);
+    terr = terrainFromPitch(pitch);
+  }
+  *pitch_rad = pitch;
+
+  ControlInput in;
+  in.dt_s = dt;
+  in.s_m = st.s_m;
+  in.pitch_rad = pitch;
+  in.pitch_rate_rad_s = (pitch - st.pitch_rad) / dt;
+  in.terrain = terr;
+
+  // Kinematics contract: lift_pos_m is carriage travel along mast (meters).
+  in.lift_pos_m = st.lift_m;
+  in.tilt_rad = st.tilt_rad;
+
+  in.env.profile = profile;
+  in.env.ceiling_z_m = ceilingZAtX(sc.env, st.s_m);
+  in.env.floor_z_m = floorZAtX(sc.env, st.s_m);
+  in.rack = sc.rack;
+  in.forklift = sc.forklift;
+  in.inputs_valid = true;
+  return in;
+}
+
+RunSummary runScenario(IController& controller,
+                       const Scenario& sc,
+                       const std::function<void(const DebugFrame&)>& on_frame,
+                       const std::atomic<bool>* cancel) {
+  RunSummary sum;
+  beginSummary(&sum);
+  controller.reset();
+
+  const auto profile = scenarioProfile(sc);
+  const PlantParams params = plantParams(sc);
+  PlantState st = initialState(sc);
+
+  for (int k = 0; k < sc.max_steps; ++k) {
+    if (cancel && cancel->load(std::memory_order_relaxed)) break;
+
+    double pitch = 0.0;
+    const DebugFrame fr = controller.step(scenarioInput(sc, st, profile, &pitch));
+
+    Plant::step(params, fr.cmd, &st);
+    st.pitch_rad = pitch;
+
+    const bool done = recordStep(sc, fr.safety, st, &sum);
+    if (on_frame) on_frame(fr);
+    if (done) break;
+  }
+  return sum;
+}
+
+BatchSim::BatchSim(ControllerKind kind, const ControllerConfig& cfg, const std::vector<Scenario>& scenarios) {
+  lanes_.resize(scenarios.size());
+  plant_.resize(scenarios.size());
+  active_.assign(scenarios.size(), 1);
+  active_count_ = scenarios.size();
+
+  for (std::size_t i = 0; i < scenarios.size(); ++i) {
+    Lane& lane = lanes_[i];
+    lane.scenario = scenarios[i];
+    lane.controller = makeController(kind, cfg);
+    lane.controller->reset();
+    lane.profile = scenarioProfile(lane.scenario);
+    beginSummary(&lane.summary);
+
+    const PlantState st = initialState(lane.scenario);
+    plant_.dt_s[i] = lane.scenario.dt_s;
+    plant_.base_speed_m_s[i] = lane.scenario.base_speed_m_s;
+    plant_.accel_limit_m_s2[i] = lane.scenario.accel_limit_m_s2;
+    plant_.s_m[i] = st.s_m;
+    plant_.lift_m[i] = st.lift_m;
+    plant_.tilt_rad[i] = st.tilt_rad;
+
+    if (lane.scenario.max_steps <= 0) {
+      active_[i] = 0;
+      --active_count_;
+    }
+  }
+}
+
+bool BatchSim::step() {
+  if (active_count_ == 0) return false;
+
+  // Controllers: one step per active lane, commands gathered into the plant's SoA arrays.
+  for (std::size_t i = 0; i < lanes_.size(); ++i) {
+    if (!active_[i]) continue;
+    Lane& lane = lanes_[i];
+    lane.controller->step(scenarioInput(lane.scenario, plant_.state(i), lane.profile, &lane.pitch_rad), out_);
+
+    plant_.cmd_lift_m[i] = out_.cmd.lift_target_m;
+    plant_.cmd_lift_rate_m_s[i] = out_.cmd.lift_rate_limit_m_s;
+    plant_.cmd_tilt_rad[i] = out_.cmd.tilt_target_rad;
+    plant_.cmd_tilt_rate_rad_s[i] = out_.cmd.tilt_rate_limit_rad_s;
+    plant_.cmd_speed_limit_m_s[i] = out_.cmd.speed_limit_m_s;
+
+    // The summary is booked after the plant has moved; only the safety status is needed for it.
+    lane.safety = out_.safety;
+  }
+
+  plant_.step(active_.data());
+
+  for (std::size_t i = 0; i < lanes_.size(); ++i) {
+    if (!active_[i]) continue;
+    Lane& lane = lanes_[i];
+    plant_.pitch_rad[i] = lane.pitch_rad;
+    const bool done = recordStep(lane.scenario, lane.safety, plant_.state(i), &lane.summary);
+    if (done || lane.summary.steps >= lane.scenario.max_steps) {
+      active_[i] = 0;
+      --active_count_;
+    }
+  }
+  return active_count_ > 0;
+}
+
+std::vector<RunSummary> runScenarios(ControllerKind kind,
+                                     const ControllerConfig& cfg,
+                                     const std::vector<Scenario>& scenarios,
+                                     int threads,
+                                     std::size_t lanes_per_batch) {
+  lanes_per_batch = std::max<std::size_t>(1, lanes_per_batch);
+  const std::size_t batches = (scenarios.size() + lanes_per_batch - 1) / lanes_per_batch;
+
+  if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  threads = std::min<int>(threads, static_cast<int>(std::max<std::size_t>(1, batches)));
+
+  std::vector<RunSummary> results(scenarios.size());
+  ThreadPool pool(threads);
+  pool.parallelFor(static_cast<int>(batches), [&](int b) {
+    const std::size_t begin = static_cast<std::size_t>(b) * lanes_per_batch;
+    const std::size_t end = std::min(scenarios.size(), begin + lanes_per_batch);
+    BatchSim batch(kind, cfg, std::vector<Scenario>(scenarios.begin() + static_cast<std::ptrdiff_t>(begin),
+                                                   scenarios.begin() + static_cast<std::ptrdiff_t>(end)));
+    batch.run();
+    for (std::size_t i = begin; i < end; ++i) results[i] = batch.summary(i - begin);
+  });
+  return results;
+}
+
+}  // namespace tlf::sim
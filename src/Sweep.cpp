@@ -0,0 +1,154 @@
+#include "sim/Sweep.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "controller/SearchCore.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace tlf::sim {
+
+namespace {
+
+struct FieldRef {
+  const char* name;
+  double ControllerConfig::*d;
+  int ControllerConfig::*i;
+};
+
+const FieldRef kFields[] = {
+    {"margin_top_m", &ControllerConfig::margin_top_m, nullptr},
+    {"margin_bottom_m", &ControllerConfig::margin_bottom_m, nullptr},
+    {"warn_threshold_m", &ControllerConfig::warn_threshold_m, nullptr},
+    {"hard_threshold_m", &ControllerConfig::hard_threshold_m, nullptr},
+    {"search_lift_half_range_m", &ControllerConfig::search_lift_half_range_m, nullptr},
+    {"search_tilt_half_range_rad", &ControllerConfig::search_tilt_half_range_rad, nullptr},
+    {"grid_lift_steps", nullptr, &ControllerConfig::grid_lift_steps},
+    {"grid_tilt_steps", nullptr, &ControllerConfig::grid_tilt_steps},
+    {"coarse_grid_steps", nullptr, &ControllerConfig::coarse_grid_steps},
+    {"refine_levels", nullptr, &ControllerConfig::refine_levels},
+    {"local_refine_iterations", nullptr, &ControllerConfig::local_refine_iterations},
+    {"local_refine_evals", nullptr, &ControllerConfig::local_refine_evals},
+    {"lookahead_s_m", &ControllerConfig::lookahead_s_m, nullptr},
+    {"w_center", &ControllerConfig::w_center, nullptr},
+    {"w_dl", &ControllerConfig::w_dl, nullptr},
+    {"w_dt", &ControllerConfig::w_dt, nullptr},
+    {"w_smooth", &ControllerConfig::w_smooth, nullptr},
+    {"base_lift_rate_limit_m_s", &ControllerConfig::base_lift_rate_limit_m_s, nullptr},
+    {"base_tilt_rate_limit_rad_s", &ControllerConfig::base_tilt_rate_limit_rad_s, nullptr},
+    {"base_speed_limit_m_s", &ControllerConfig::base_speed_limit_m_s, nullptr},
+    {"min_speed_limit_m_s", &ControllerConfig::min_speed_limit_m_s, nullptr},
+    {"mpc_horizon_steps", nullptr, &ControllerConfig::mpc_horizon_steps},
+    {"mpc_beam_width", nullptr, &ControllerConfig::mpc_beam_width},
+    {"mpc_assumed_forward_speed_m_s", &ControllerConfig::mpc_assumed_forward_speed_m_s, nullptr},
+};
+
+// Minimization key of a point; a dominates b if no component is worse and one is better.
+struct Objectives {
+  double incomplete;
+  double time_s;
+  double neg_clearance;
+  double stops;
+  double latency;
+};
+
+Objectives objectives(const SweepPoint& p) {
+  const auto& s = p.summary;
+  return Objectives{s.completed ? 0.0 : 1.0, s.completed ? s.time_to_end_s : 0.0,
+                    -std::min(s.min_clearance_top_m, s.min_clearance_bottom_m), static_cast<double>(s.stop_steps),
+                    p.mean_step_latency_us};
+}
+
+bool dominates(const Objectives& a, const Objectives& b) {
+  const double av[] = {a.incomplete, a.time_s, a.neg_clearance, a.stops, a.latency};
+  const double bv[] = {b.incomplete, b.time_s, b.neg_clearance, b.stops, b.latency};
+  bool better = false;
+  for (int i = 0; i < 5; ++i) {
+    if (av[i] > bv[i]) return false;
+    if (av[i] < bv[i]) better = true;
+  }
+  return better;
+}
+
+}  // namespace
+
+const std::vector<std::string>& sweepableConfigFields() {
+  static const std::vector<std::string> names = [] {
+    std::vector<std::string> n;
+    for (const auto& f : kFields) n.emplace_back(f.name);
+    n.emplace_back("grid_steps");
+    return n;
+  }();
+  return names;
+}
+
+bool setConfigField(ControllerConfig* cfg, const std::string& name, double value) {
+  if (name == "grid_steps") {
+    cfg->grid_lift_steps = cfg->grid_tilt_steps = static_cast<int>(std::lround(value));
+    return true;
+  }
+  for (const auto& f : kFields) {
+    if (name != f.name) continue;
+    if (f.d) {
+      cfg->*f.d = value;
+    } else {
+      cfg->*f.i = static_cast<int>(std::lround(value));
+    }
+    return true;
+  }
+  return false;
+}
+
+std::vector<SweepPoint> runSweep(ControllerKind kind,
+                                 const ControllerConfig& base,
+                                 const Scenario& scenario,
+                                 const std::vector<SweepAxis>& axes,
+                                 int threads) {
+  std::size_t combos = 1;
+  for (const auto& a : axes) combos *= a.values.size();
+
+  std::vector<SweepPoint> points(combos);
+  for (std::size_t c = 0; c < combos; ++c) {
+    auto& values = points[c].values;
+    values.resize(axes.size());
+    std::size_t rem = c;
+    for (std::size_t a = axes.size(); a-- > 0;) {
+      values[a] = axes[a].values[rem % axes[a].values.size()];
+      rem /= axes[a].values.size();
+    }
+  }
+
+  if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  threads = std::min<int>(threads, static_cast<int>(std::max<std::size_t>(1, combos)));
+
+  ThreadPool pool(threads);
+  pool.parallelFor(static_cast<int>(combos), [&](int c) {
+    SweepPoint& p = points[static_cast<std::size_t>(c)];
+    ControllerConfig cfg = base;
+    for (std::size_t a = 0; a < axes.size(); ++a) setConfigField(&cfg, axes[a].field, p.values[a]);
+    if (!validateConfig(cfg, &p.invalid)) return;
+
+    auto controller = makeController(kind, cfg);
+    p.summary = runScenario(*controller, scenario);
+    p.mean_step_latency_us = controller->instrumentation().snapshot().step_latency_ns.mean() * 1e-3;
+  });
+  return points;
+}
+
+std::vector<std::size_t> paretoFront(const std::vector<SweepPoint>& points) {
+  std::vector<Objectives> obj;
+  obj.reserve(points.size());
+  for (const auto& p : points) obj.push_back(objectives(p));
+
+  std::vector<std::size_t> front;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    if (!points[i].valid()) continue;
+    bool dominated = false;
+    for (std::size_t j = 0; j < points.size() && !dominated; ++j) dominated = (j != i) && points[j].valid() && dominates(obj[j], obj[i]);
+    if (!dominated) front.push_back(i);
+  }
+  return front;
+}
+
+}  // namespace tlf::sim
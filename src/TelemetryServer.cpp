@@ -0,0 +1,383 @@
+#include "utils/TelemetryServer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TLF_TELEMETRY_SOCKETS 1
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace tlf {
+
+namespace {
+
+constexpr char kWebSocketGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+constexpr std::size_t kMaxRequestBytes = 8192;
+// The viewer only ever sends control frames (close, ping/pong: payload <= 125 bytes); anything much
+// larger, buffered or declared, is a misbehaving client and is disconnected rather than buffered.
+constexpr std::size_t kMaxClientFrameBytes = 1024;
+
+std::uint32_t rotl(std::uint32_t v, int n) { return (v << n) | (v >> (32 - n)); }
+
+// SHA-1 of a short string; only used for the Sec-WebSocket-Accept handshake value.
+std::array<unsigned char, 20> sha1(const std::string& msg) {
+  std::uint32_t h[5] = {0x67452301u, 0xEFCDAB89u, 0x98BADCFEu, 0x10325476u, 0xC3D2E1F0u};
+
+  std::string data = msg;
+  const std::uint64_t bit_len = static_cast<std::uint64_t>(msg.size()) * 8;
+  data.push_back(static_cast<char>(0x80));
+  while (data.size() % 64 != 56) data.push_back('\0');
+  for (int i = 7; i >= 0; --i) data.push_back(static_cast<char>((bit_len >> (8 * i)) & 0xFF));
+
+  for (std::size_t chunk = 0; chunk < data.size(); chunk += 64) {
+    std::uint32_t w[80];
+    for (int i = 0; i < 16; ++i) {
+      const auto* p = reinterpret_cast<const unsigned char*>(data.data() + chunk + 4 * i);
+      w[i] = (std::uint32_t(p[0]) << 24) | (std::uint32_t(p[1]) << 16) | (std::uint32_t(p[2]) << 8) | p[3];
+    }
+    for (int i = 16; i < 80; ++i) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+    std::uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; ++i) {
+      std::uint32_t f, k;
+      if (i < 20) {
+        f = (b & c) | (~b & d);
+        k = 0x5A827999u;
+      } else if (i < 40) {
+        f = b ^ c ^ d;
+        k = 0x6ED9EBA1u;
+      } else if (i < 60) {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8F1BBCDCu;
+      } else {
+        f = b ^ c ^ d;
+        k = 0xCA62C1D6u;
+      }
+      const std::uint32_t t = rotl(a, 5) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = rotl(b, 30);
+      b = a;
+      a = t;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+  }
+
+  std::array<unsigned char, 20> out{};
+  for (int i = 0; i < 5; ++i) {
+    for (int j = 0; j < 4; ++j) out[static_cast<std::size_t>(4 * i + j)] = static_cast<unsigned char>(h[i] >> (24 - 8 * j));
+  }
+  return out;
+}
+
+std::string base64(const unsigned char* p, std::size_t n) {
+  static constexpr char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  for (std::size_t i = 0; i < n; i += 3) {
+    const std::uint32_t v = (std::uint32_t(p[i]) << 16) | (i + 1 < n ? std::uint32_t(p[i + 1]) << 8 : 0) |
+                            (i + 2 < n ? std::uint32_t(p[i + 2]) : 0);
+    out.push_back(kAlphabet[(v >> 18) & 63]);
+    out.push_back(kAlphabet[(v >> 12) & 63]);
+    out.push_back(i + 1 < n ? kAlphabet[(v >> 6) & 63] : '=');
+    out.push_back(i + 2 < n ? kAlphabet[v & 63] : '=');
+  }
+  return out;
+}
+
+// Value of a request header (case-insensitive name), empty if absent.
+std::string headerValue(const std::string& request, const char* name) {
+  const std::size_t name_len = std::strlen(name);
+  std::size_t pos = request.find("\r\n");
+  while (pos != std::string::npos && pos + 2 < request.size()) {
+    const std::size_t start = pos + 2;
+    const std::size_t end = request.find("\r\n", start);
+    if (end == std::string::npos || end == start) break;
+    const std::size_t colon = request.find(':', start);
+    if (colon != std::string::npos && colon < end && colon - start == name_len) {
+      bool match = true;
+      for (std::size_t i = 0; i < name_len && match; ++i) {
+        match = std::tolower(static_cast<unsigned char>(request[start + i])) == std::tolower(static_cast<unsigned char>(name[i]));
+      }
+      if (match) {
+        std::size_t b = colon + 1, e = end;
+        while (b < e && (request[b] == ' ' || request[b] == '\t')) ++b;
+        while (e > b && (request[e - 1] == ' ' || request[e - 1] == '\t')) --e;
+        return request.substr(b, e - b);
+      }
+    }
+    pos = end;
+  }
+  return {};
+}
+
+// Unmasked single-frame text message (server-to-client frames are never masked).
+void appendTextFrame(const std::string& payload, std::string* out) {
+  const std::size_t n = payload.size();
+  out->push_back(static_cast<char>(0x81));
+  if (n < 126) {
+    out->push_back(static_cast<char>(n));
+  } else if (n <= 0xFFFF) {
+    out->push_back(static_cast<char>(126));
+    out->push_back(static_cast<char>((n >> 8) & 0xFF));
+    out->push_back(static_cast<char>(n & 0xFF));
+  } else {
+    out->push_back(static_cast<char>(127));
+    for (int i = 7; i >= 0; --i) out->push_back(static_cast<char>((static_cast<std::uint64_t>(n) >> (8 * i)) & 0xFF));
+  }
+  out->append(payload);
+}
+
+// True if the client must be closed: the buffered bytes contain a close frame (opcode 0x8) or declare
+// a frame longer than kMaxClientFrameBytes. Other complete frames are discarded.
+bool consumeClientFrames(std::string* in) {
+  std::size_t pos = 0;
+  for (;;) {
+    if (in->size() - pos < 2) break;
+    const auto* p = reinterpret_cast<const unsigned char*>(in->data() + pos);
+    const int opcode = p[0] & 0x0F;
+    const bool masked = (p[1] & 0x80) != 0;
+    std::uint64_t len = p[1] & 0x7F;
+    std::size_t hdr = 2;
+    if (len == 126) {
+      if (in->size() - pos < 4) break;
+      len = (std::uint64_t(p[2]) << 8) | p[3];
+      hdr = 4;
+    } else if (len == 127) {
+      if (in->size() - pos < 10) break;
+      len = 0;
+      for (int i = 0; i < 8; ++i) len = (len << 8) | p[2 + i];
+      hdr = 10;
+    }
+    if (len > kMaxClientFrameBytes) return true;
+    if (masked) hdr += 4;
+    if (in->size() - pos < hdr + len) break;
+    if (opcode == 0x8) return true;
+    pos += hdr + static_cast<std::size_t>(len);
+  }
+  in->erase(0, pos);
+  return false;
+}
+
+}  // namespace
+
+std::string logRecordToJson(const LogRecord& r) {
+  std::string out;
+  out.reserve(512);
+  out.push_back('{');
+  const auto* base = reinterpret_cast<const unsigned char*>(&r);
+  char buf[32];
+  for (std::size_t i = 0; i < kLogColumnCount; ++i) {
+    const LogColumn& col = kLogColumns[i];
+    if (i > 0) out.push_back(',');
+    out.push_back('"');
+    out.append(col.name);
+    out.append("\":");
+    std::to_chars_result res{};
+    if (col.type == LogColumnType::F64) {
+      double v;
+      std::memcpy(&v, base + col.offset, sizeof(v));
+      if (!std::isfinite(v)) {
+        out.append("null");  // JSON has no NaN/Inf
+        continue;
+      }
+      res = std::to_chars(buf, buf + sizeof(buf), v);
+    } else {
+      std::int32_t v;
+      std::memcpy(&v, base + col.offset, sizeof(v));
+      res = std::to_chars(buf, buf + sizeof(buf), v);
+    }
+    out.append(buf, res.ptr);
+  }
+  out.push_back('}');
+  return out;
+}
+
+WebSocketTelemetrySink::WebSocketTelemetrySink(TelemetryOptions options) : options_(std::move(options)) {
+  if (options_.decimation < 1) options_.decimation = 1;
+#if defined(TLF_TELEMETRY_SOCKETS)
+  const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    error_ = std::string("socket: ") + std::strerror(errno);
+    return;
+  }
+  const int yes = 1;
+  ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(options_.port);
+  if (::inet_pton(AF_INET, options_.bind_address.c_str(), &addr.sin_addr) != 1) {
+    error_ = "invalid bind address " + options_.bind_address;
+    ::close(fd);
+    return;
+  }
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 8) != 0) {
+    error_ = std::string("bind/listen: ") + std::strerror(errno);
+    ::close(fd);
+    return;
+  }
+  socklen_t len = sizeof(addr);
+  ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+  port_ = ntohs(addr.sin_port);
+  ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  listen_fd_ = fd;
+#else
+  error_ = "telemetry server not supported on this platform";
+#endif
+}
+
+WebSocketTelemetrySink::~WebSocketTelemetrySink() {
+  for (auto& c : clients_) closeClient(c);
+#if defined(TLF_TELEMETRY_SOCKETS)
+  if (listen_fd_ >= 0) ::close(listen_fd_);
+#endif
+}
+
+int WebSocketTelemetrySink::clients() const {
+  int n = 0;
+  for (const auto& c : clients_) n += c.open ? 1 : 0;
+  return n;
+}
+
+void WebSocketTelemetrySink::writeRecord(const LogRecord& r) {
+  if (!good() || seen_++ % static_cast<std::uint64_t>(options_.decimation) != 0) return;
+  if (clients() > 0) {
+    message_.clear();
+    appendTextFrame(logRecordToJson(r), &message_);
+    for (auto& c : clients_) {
+      if (!c.open) continue;
+      if (c.out.size() - c.out_pos > options_.max_backlog_bytes) {
+        ++frames_skipped_;
+        continue;
+      }
+      c.out.append(message_);
+      ++frames_sent_;
+    }
+  }
+  // Sockets are serviced per published record (and from idle()), not per record.
+  flush();
+}
+
+void WebSocketTelemetrySink::flush() {
+  if (!good()) return;
+  acceptClients();
+  for (auto& c : clients_) serviceClient(c);
+  clients_.erase(std::remove_if(clients_.begin(), clients_.end(), [](const Client& c) { return c.fd < 0; }), clients_.end());
+}
+
+void WebSocketTelemetrySink::acceptClients() {
+#if defined(TLF_TELEMETRY_SOCKETS)
+  for (;;) {
+    const int fd = ::accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) return;  // EAGAIN: nobody waiting
+    if (static_cast<int>(clients_.size()) >= options_.max_clients) {
+      ::close(fd);
+      continue;
+    }
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#if defined(SO_NOSIGPIPE)
+    const int yes = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof(yes));
+#endif
+    Client c;
+    c.fd = fd;
+    clients_.push_back(std::move(c));
+  }
+#endif
+}
+
+void WebSocketTelemetrySink::serviceClient(Client& c) {
+#if defined(TLF_TELEMETRY_SOCKETS)
+  char buf[2048];
+  for (;;) {
+    const ssize_t n = ::recv(c.fd, buf, sizeof(buf), 0);
+    if (n > 0) {
+      c.in.append(buf, static_cast<std::size_t>(n));
+      if (c.in.size() > kMaxRequestBytes) {
+        closeClient(c);  // oversized handshake, or frames arriving faster than they can be discarded
+        return;
+      }
+      continue;
+    }
+    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+      closeClient(c);  // peer closed or socket error
+      return;
+    }
+    break;
+  }
+
+  if (!c.open) {
+    const std::size_t end = c.in.find("\r\n\r\n");
+    if (end == std::string::npos) return;
+    const std::string request = c.in.substr(0, end + 4);
+    c.in.erase(0, end + 4);
+    const std::string key = headerValue(request, "Sec-WebSocket-Key");
+    if (request.compare(0, 4, "GET ") != 0 || key.empty()) {
+      closeClient(c);
+      return;
+    }
+    const auto digest = sha1(key + kWebSocketGuid);
+    c.out =
+        "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: " +
+        base64(digest.data(), digest.size()) + "\r\n\r\n";
+    c.out_pos = 0;
+    c.open = true;
+  }
+  if (consumeClientFrames(&c.in)) {
+    closeClient(c);
+    return;
+  }
+
+#if defined(MSG_NOSIGNAL)
+  constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+  constexpr int kSendFlags = 0;
+#endif
+  while (c.out_pos < c.out.size()) {
+    const ssize_t n = ::send(c.fd, c.out.data() + c.out_pos, c.out.size() - c.out_pos, kSendFlags);
+    if (n > 0) {
+      c.out_pos += static_cast<std::size_t>(n);
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) break;
+    closeClient(c);
+    return;
+  }
+  if (c.out_pos == c.out.size()) {
+    c.out.clear();
+    c.out_pos = 0;
+  } else if (c.out_pos > c.out.size() / 2) {
+    c.out.erase(0, c.out_pos);
+    c.out_pos = 0;
+  }
+#else
+  (void)c;
+#endif
+}
+
+void WebSocketTelemetrySink::closeClient(Client& c) {
+#if defined(TLF_TELEMETRY_SOCKETS)
+  if (c.fd >= 0) ::close(c.fd);
+#endif
+  c.fd = -1;
+  c.open = false;
+}
+
+}  // namespace tlf
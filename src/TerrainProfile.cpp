@@ -0,0 +1,45 @@
+#include "model/TerrainProfile.hpp"
+
+#include <cmath>
+#include <utility>
+
+namespace tlf {
+
+PiecewiseLinear::PiecewiseLinear(std::vector<double> xs, std::vector<double> zs)
+    : x_(std::move(xs)), z_(std::move(zs)) {
+  finalize();
+}
+
+PiecewiseLinear PiecewiseLinear::sampled(const std::function<double(double)>& fn, double x_min, double x_max, int samples) {
+  const int n = std::max(2, samples);
+  std::vector<double> xs(static_cast<size_t>(n));
+  std::vector<double> zs(static_cast<size_t>(n));
+  for (int i = 0; i < n; ++i) {
+    const double t = static_cast<double>(i) / static_cast<double>(n - 1);
+    xs[static_cast<size_t>(i)] = x_min + (x_max - x_min) * t;
+    zs[static_cast<size_t>(i)] = fn ? fn(xs[static_cast<size_t>(i)]) : 0.0;
+  }
+  return PiecewiseLinear(std::move(xs), std::move(zs));
+}
+
+void PiecewiseLinear::finalize() {
+  valid_ = !x_.empty() && x_.size() == z_.size();
+  for (size_t i = 0; valid_ && i < x_.size(); ++i) {
+    if (!std::isfinite(x_[i]) || !std::isfinite(z_[i])) valid_ = false;
+    if (i > 0 && x_[i] < x_[i - 1]) valid_ = false;
+  }
+
+  if (!valid_) {
+    // Keep lookups well-defined; EnvironmentGeometry ignores invalid profiles.
+    x_.assign(1, 0.0);
+    z_.assign(1, 0.0);
+  }
+
+  slope_.assign(x_.size(), 0.0);
+  for (size_t i = 0; i + 1 < x_.size(); ++i) {
+    const double dx = x_[i + 1] - x_[i];
+    slope_[i] = (dx > 0.0) ? (z_[i + 1] - z_[i]) / dx : 0.0;
+  }
+}
+
+}  // namespace tlf
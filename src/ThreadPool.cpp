@@ -0,0 +1,79 @@
+#include "utils/ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace tlf {
+
+ThreadPool::ThreadPool(int threads) {
+  const int workers = std::max(0, threads - 1);
+  workers_.reserve(static_cast<size_t>(workers));
+  for (int i = 0; i < workers; ++i) {
+    workers_.emplace_back([this] { workerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& t : workers_) t.join();
+}
+
+void ThreadPool::drain() {
+  for (int i = next_.fetch_add(1, std::memory_order_relaxed); i < n_; i = next_.fetch_add(1, std::memory_order_relaxed)) {
+    invoke_(ctx_, i);
+  }
+}
+
+void ThreadPool::run(int n, void* ctx, InvokeFn invoke) {
+  if (n <= 0) return;
+  if (workers_.empty() || n == 1) {
+    for (int i = 0; i < n; ++i) invoke(ctx, i);
+    return;
+  }
+
+  std::lock_guard<std::mutex> run_lk(run_mutex_);
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    ctx_ = ctx;
+    invoke_ = invoke;
+    n_ = n;
+    next_.store(0, std::memory_order_relaxed);
+    active_workers_ = static_cast<int>(workers_.size());
+    ++generation_;
+  }
+  wake_.notify_all();
+
+  drain();
+
+  std::unique_lock<std::mutex> lk(mutex_);
+  done_.wait(lk, [this] { return active_workers_ == 0; });
+  ctx_ = nullptr;
+  invoke_ = nullptr;
+  n_ = 0;
+}
+
+void ThreadPool::workerLoop() {
+  std::size_t seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lk(mutex_);
+      wake_.wait(lk, [&] { return stop_ || generation_ != seen; });
+      if (stop_) return;
+      seen = generation_;
+    }
+
+    drain();
+
+    bool last = false;
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      last = (--active_workers_ == 0);
+    }
+    if (last) done_.notify_one();
+  }
+}
+
+}  // namespace tlf
@@ -0,0 +1,195 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#include "controller/Controller.hpp"
+#include "controller/ControllerMPC.hpp"
+#include "utils/AsyncLogger.hpp"
+
+// Counting global allocator: only allocations made while g_counting is set are recorded.
+static std::atomic<bool> g_counting{false};
+static std::atomic<long> g_allocations{0};
+
+void* operator new(std::size_t n) {
+  if (g_counting.load(std::memory_order_relaxed)) g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return ::operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+using namespace tlf;
+
+static ControlInput roomyInput() {
+  ControlInput in;
+  in.dt_s = 0.02;
+  in.s_m = 0.0;
+  in.lift_pos_m = 0.40;
+  in.env.floor_z_m = 0.0;
+  in.env.ceiling_z_m = 3.2;
+  in.rack.height_m = 2.3;
+  in.rack.length_m = 2.3;
+  in.rack.mount_offset_m = {0.0, 0.0};
+  return in;
+}
+
+template <typename StepFn>
+static long allocationsDuringSteps(StepFn&& stepOnce) {
+  // Warm-up: workspaces are sized on the first steps.
+  for (int i = 0; i < 3; ++i) stepOnce();
+
+  g_allocations.store(0);
+  g_counting.store(true);
+  for (int i = 0; i < 20; ++i) stepOnce();
+  g_counting.store(false);
+  return g_allocations.load();
+}
+
+TEST_CASE("ControllerMPC steady-state step performs no heap allocations") {
+  ControllerConfig cfg;
+  cfg.mpc_horizon_steps = 6;
+  cfg.mpc_beam_width = 60;
+  cfg.mpc_assumed_forward_speed_m_s = 0.1;
+  cfg.mpc_warm_start = true;
+  ControllerMPC c(cfg);
+
+  ControlInput in = roomyInput();
+  SafetyLevel level = SafetyLevel::DEGRADED;
+  const long n = allocationsDuringSteps([&] {
+    const DebugFrame f = c.step(in);
+    level = f.safety.level;
+    in.s_m += 0.002;
+  });
+
+  REQUIRE(level == SafetyLevel::OK);
+  REQUIRE(n == 0);
+
+  // Parallel expansion: the pool and per-thread buffers are created during warm-up.
+  c.config().mpc_num_threads = 3;
+  const long n_par = allocationsDuringSteps([&] {
+    const DebugFrame f = c.step(in);
+    level = f.safety.level;
+    in.s_m += 0.002;
+  });
+
+  REQUIRE(level == SafetyLevel::OK);
+  REQUIRE(n_par == 0);
+
+  c.config().mpc_dedup_states = true;
+  const long n_dedup = allocationsDuringSteps([&] {
+    const DebugFrame f = c.step(in);
+    level = f.safety.level;
+    in.s_m += 0.002;
+  });
+
+  REQUIRE(level == SafetyLevel::OK);
+  REQUIRE(n_dedup == 0);
+
+  c.config().mpc_num_threads = 1;
+  c.config().clearance_cache_capacity = 4096;
+  const long n_cache = allocationsDuringSteps([&] {
+    const DebugFrame f = c.step(in);
+    level = f.safety.level;
+    in.s_m += 0.002;
+  });
+
+  REQUIRE(level == SafetyLevel::OK);
+  REQUIRE(n_cache == 0);
+}
+
+TEST_CASE("Controller steady-state step performs no heap allocations") {
+  ControllerConfig cfg;
+  cfg.grid_lift_steps = 41;
+  cfg.grid_tilt_steps = 41;
+  cfg.lookahead_s_m = 0.25;
+
+  for (bool float32 : {false, true}) {
+    cfg.float32_candidates = float32;
+    Controller c(cfg);
+
+    ControlInput in = roomyInput();
+    SafetyLevel level = SafetyLevel::DEGRADED;
+    const long n = allocationsDuringSteps([&] {
+      const DebugFrame f = c.step(in);
+      level = f.safety.level;
+      in.s_m += 0.002;
+    });
+
+    REQUIRE(level == SafetyLevel::OK);
+    REQUIRE(n == 0);
+  }
+}
+
+TEST_CASE("The first step after warmup() performs no heap allocations") {
+  ControllerConfig cfg;
+  cfg.grid_lift_steps = 41;
+  cfg.grid_tilt_steps = 41;
+  cfg.lookahead_s_m = 0.25;
+  cfg.float32_candidates = true;
+  cfg.mpc_num_threads = 3;
+  cfg.mpc_dedup_states = true;
+  cfg.clearance_cache_capacity = 4096;
+
+  Controller grid(cfg);
+  ControllerMPC mpc(cfg);
+  ControlInput in = roomyInput();
+  grid.warmup(in);
+  mpc.warmup(in);
+
+  ControlOutput out;
+  g_allocations.store(0);
+  g_counting.store(true);
+  grid.step(in, out);
+  mpc.step(in, out);
+  g_counting.store(false);
+  REQUIRE(g_allocations.load() == 0);
+}
+
+TEST_CASE("configure() sizes the double batch even with float32 scoring") {
+  ControllerConfig cfg;
+  cfg.grid_lift_steps = 41;
+  cfg.grid_tilt_steps = 41;
+  cfg.lookahead_s_m = 0.25;
+  cfg.float32_candidates = true;  // profiles still take the double kernel
+
+  ControlInput in = roomyInput();
+  auto profile = std::make_shared<TerrainProfile>();
+  profile->floor = PiecewiseLinear({-5.0, 0.0, 20.0}, {-0.35, 0.0, 0.0});
+  profile->ceiling = PiecewiseLinear(3.2);
+  in.env.profile = profile;
+
+  Controller grid(cfg);
+  ControlOutput out;
+  g_allocations.store(0);
+  g_counting.store(true);
+  grid.step(in, out);
+  g_counting.store(false);
+  REQUIRE(out.safety.level == SafetyLevel::OK);
+  REQUIRE(g_allocations.load() == 0);
+}
+
+namespace {
+struct NullSink final : LogSink {
+  void writeRecord(const LogRecord&) override {}
+  void flush() override {}
+};
+}  // namespace
+
+TEST_CASE("AsyncLogger push performs no heap allocations") {
+  NullSink sink;
+  AsyncLogger log(sink, 64, LogOverflowPolicy::Block);
+  LogRecord r;
+  const long n = allocationsDuringSteps([&] {
+    for (int i = 0; i < 200; ++i) {
+      r.time_s += 1.0;
+      log.push(r);
+    }
+  });
+  REQUIRE(n == 0);
+}
@@ -0,0 +1,80 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "utils/AsyncLogger.hpp"
+
+using namespace tlf;
+
+namespace {
+
+// Records what the writer thread delivers; optionally stalls until released.
+struct RecordingSink final : LogSink {
+  std::vector<double> times;
+  std::atomic<bool> stalled{false};
+  int flushes{0};
+
+  void writeRecord(const LogRecord& r) override {
+    while (stalled.load()) std::this_thread::sleep_for(std::chrono::microseconds(50));
+    times.push_back(r.time_s);
+  }
+  void flush() override { ++flushes; }
+};
+
+}  // namespace
+
+TEST_CASE("SpscRing is FIFO and bounded") {
+  SpscRing<int> ring(3);
+  REQUIRE(ring.capacity() == 4);
+  for (int i = 0; i < 4; ++i) REQUIRE(ring.tryPush(i));
+  REQUIRE_FALSE(ring.tryPush(99));
+  int v = -1;
+  REQUIRE(ring.tryPop(&v));
+  REQUIRE(v == 0);
+  REQUIRE(ring.tryPush(4));
+  for (int i = 1; i <= 4; ++i) {
+    REQUIRE(ring.tryPop(&v));
+    REQUIRE(v == i);
+  }
+  REQUIRE_FALSE(ring.tryPop(&v));
+}
+
+TEST_CASE("AsyncLogger with Block policy delivers every record in order") {
+  RecordingSink sink;
+  {
+    AsyncLogger log(sink, 8, LogOverflowPolicy::Block);
+    LogRecord r;
+    for (int i = 0; i < 1000; ++i) {
+      r.time_s = i;
+      REQUIRE(log.push(r));
+    }
+    REQUIRE(log.dropped() == 0);
+  }
+  REQUIRE(sink.times.size() == 1000);
+  for (int i = 0; i < 1000; ++i) REQUIRE(sink.times[static_cast<size_t>(i)] == i);
+  REQUIRE(sink.flushes == 1);
+}
+
+TEST_CASE("AsyncLogger with Drop policy counts frames it could not queue") {
+  RecordingSink sink;
+  sink.stalled = true;  // the writer takes the first record and then hangs in the sink
+  std::uint64_t dropped = 0;
+  {
+    AsyncLogger log(sink, 16, LogOverflowPolicy::Drop);
+    LogRecord r;
+    int accepted = 0;
+    for (int i = 0; i < 100; ++i) {
+      r.time_s = i;
+      if (log.push(r)) ++accepted;
+    }
+    dropped = log.dropped();
+    REQUIRE(dropped > 0);
+    REQUIRE(static_cast<std::uint64_t>(accepted) + dropped == 100);
+    sink.stalled = false;
+  }
+  REQUIRE(sink.times.size() + dropped == 100);
+  for (size_t i = 1; i < sink.times.size(); ++i) REQUIRE(sink.times[i] > sink.times[i - 1]);
+}
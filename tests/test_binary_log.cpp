@@ -0,0 +1,88 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+#include "controller/Controller.hpp"
+#include "utils/BinaryLog.hpp"
+
+using namespace tlf;
+
+static std::string tempLogPath(const char* name) { return (std::filesystem::temp_directory_path() / name).string(); }
+
+TEST_CASE("BinaryLogger round-trips records across blocks") {
+  const std::string path = tempLogPath("tlf_test_roundtrip.tlfb");
+
+  Controller c;
+  ControlInput in;
+  in.env.floor_z_m = 0.0;
+  in.env.ceiling_z_m = 2.6;
+  in.rack.mount_offset_m = {0.0, 0.0};
+
+  std::vector<LogRecord> written;
+  {
+    BinaryLogger log(path, LogCodec::None, 7);  // several full blocks plus a partial one
+    REQUIRE(log.good());
+    for (int k = 0; k < 30; ++k) {
+      in.s_m = -1.0 + 0.05 * k;
+      const DebugFrame f = c.step(in);
+      written.push_back(toLogRecord(f));
+      log.writeFrame(f);
+    }
+  }
+
+  BinaryLogReader reader(path);
+  REQUIRE(reader.good());
+  REQUIRE(reader.version() == BinaryLogger::kVersion);
+  REQUIRE(reader.columnNames().size() == kLogColumnCount);
+  REQUIRE(reader.columnNames().front() == "time");
+
+  LogRecord r;
+  size_t n = 0;
+  while (reader.next(&r)) {
+    REQUIRE(n < written.size());
+    const LogRecord& w = written[n];
+    REQUIRE(r.time_s == w.time_s);
+    REQUIRE(r.s_m == w.s_m);
+    REQUIRE(r.ceiling_z_m == 2.6);
+    REQUIRE(r.ft_z == w.ft_z);
+    REQUIRE(r.clearance_bottom_m == w.clearance_bottom_m);
+    REQUIRE(r.speed_limit_m_s == w.speed_limit_m_s);
+    REQUIRE(r.safety_level == w.safety_level);
+    REQUIRE(r.worst_point_id == w.worst_point_id);
+    ++n;
+  }
+  REQUIRE(reader.good());
+  REQUIRE(n == written.size());
+
+  REQUIRE(isBinaryLog(path));
+  std::remove(path.c_str());
+}
+
+TEST_CASE("BinaryLogger falls back to uncompressed blocks when a codec is unavailable") {
+  const std::string path = tempLogPath("tlf_test_codec.tlfb");
+  for (LogCodec codec : {LogCodec::LZ4, LogCodec::Zstd}) {
+    {
+      BinaryLogger log(path, codec, 16);
+      REQUIRE(log.codec() == (logCodecAvailable(codec) ? codec : LogCodec::None));
+      for (int k = 0; k < 40; ++k) {
+        LogRecord r;
+        r.time_s = 0.1 * k;
+        r.terrain_state = k % 5;
+        log.writeRecord(r);
+      }
+    }
+    BinaryLogReader reader(path);
+    LogRecord r;
+    int n = 0;
+    while (reader.next(&r)) {
+      REQUIRE(r.time_s == 0.1 * n);
+      REQUIRE(r.terrain_state == n % 5);
+      ++n;
+    }
+    REQUIRE(reader.good());
+    REQUIRE(n == 40);
+  }
+  std::remove(path.c_str());
+}
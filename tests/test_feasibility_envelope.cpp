@@ -0,0 +1,116 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "controller/Controller.hpp"
+#include "model/FeasibilityEnvelope.hpp"
+#include "sim/Simulation.hpp"
+
+using namespace tlf;
+
+namespace {
+
+std::string tempPath(const char* name) { return (std::filesystem::temp_directory_path() / name).string(); }
+
+// Coarser than the defaults to keep the build quick; still covers the whole docking demo.
+EnvelopeSpec demoSpec(const ControllerConfig& cfg) {
+  EnvelopeSpec spec;
+  spec.s_bins = 120;
+  spec.pitch_bins = 20;
+  spec.lift_samples = 41;
+  spec.tilt_samples = 41;
+  spec.margin_top_m = cfg.margin_top_m;
+  spec.margin_bottom_m = cfg.margin_bottom_m;
+  return spec;
+}
+
+std::shared_ptr<const FeasibilityEnvelope> demoEnvelope(const sim::Scenario& sc, const ControllerConfig& cfg) {
+  EnvironmentGeometry env;
+  env.profile = std::make_shared<const TerrainProfile>(sim::buildTerrainProfile(sc.env));
+  return std::make_shared<const FeasibilityEnvelope>(
+      FeasibilityEnvelope::build(env, sc.rack, sc.forklift, demoSpec(cfg), 2));
+}
+
+}  // namespace
+
+TEST_CASE("Feasibility envelope round-trips through its mapped file", "[envelope]") {
+  const sim::Scenario sc = sim::dockingDemoScenario();
+  const ControllerConfig cfg = sim::dockingDemoConfig(ControllerKind::GridSearch);
+  const auto built = demoEnvelope(sc, cfg);
+
+  const std::string path = tempPath("tlf_test_envelope.tlfe");
+  REQUIRE(built->save(path));
+  std::string error;
+  const auto loaded = FeasibilityEnvelope::load(path, &error);
+  REQUIRE(loaded);
+  CHECK(error.empty());
+
+  REQUIRE(loaded->cellCount() == built->cellCount());
+  CHECK(loaded->spec().s_bins == built->spec().s_bins);
+  CHECK(loaded->spec().margin_top_m == built->spec().margin_top_m);
+  CHECK(loaded->rack().height_m == sc.rack.height_m);
+  for (int is = 0; is < built->spec().s_bins; ++is) {
+    for (int ip = 0; ip < built->spec().pitch_bins; ++ip) {
+      REQUIRE(std::memcmp(&loaded->cell(is, ip), &built->cell(is, ip), sizeof(EnvelopeCell)) == 0);
+    }
+  }
+
+  // Coverage and applicability.
+  CHECK(loaded->lookup(0.0, 0.0) != nullptr);
+  CHECK(loaded->lookup(built->spec().s_max_m + 0.1, 0.0) == nullptr);
+  CHECK(loaded->lookup(0.0, built->spec().pitch_min_rad - 0.01) == nullptr);
+  CHECK(loaded->accepts(sc.rack, sc.forklift, cfg.margin_top_m, cfg.margin_bottom_m));
+  CHECK_FALSE(loaded->accepts(sc.rack, sc.forklift, cfg.margin_top_m - 0.01, cfg.margin_bottom_m));
+  RackParams taller = sc.rack;
+  taller.height_m += 0.05;
+  CHECK_FALSE(loaded->accepts(taller, sc.forklift, cfg.margin_top_m, cfg.margin_bottom_m));
+
+  // Truncated and foreign files are rejected.
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - sizeof(EnvelopeCell));
+  CHECK_FALSE(FeasibilityEnvelope::load(path, &error));
+  CHECK_FALSE(error.empty());
+  std::remove(path.c_str());
+  CHECK_FALSE(FeasibilityEnvelope::load(path));
+}
+
+TEST_CASE("Envelope-clamped window lets a coarse grid finish the docking demo", "[envelope]") {
+  const sim::Scenario sc = sim::dockingDemoScenario();
+  ControllerConfig cfg = sim::dockingDemoConfig(ControllerKind::GridSearch);
+  cfg.grid_lift_steps = 15;
+  cfg.grid_tilt_steps = 15;
+  const auto envelope = demoEnvelope(sc, cfg);
+
+  // The full 15x15 window misses the thin feasible band near the door.
+  Controller plain(cfg);
+  const sim::RunSummary r_plain = sim::runScenario(plain, sc);
+  CHECK_FALSE(r_plain.completed);
+
+  Controller clamped(cfg);
+  clamped.setFeasibilityEnvelope(envelope);
+  int used = 0, steps = 0;
+  const sim::RunSummary r = sim::runScenario(clamped, sc, [&](const DebugFrame& f) {
+    ++steps;
+    used += f.envelope_used ? 1 : 0;
+  });
+  CHECK(r.completed);
+  CHECK(r.stop_steps == 0);
+  CHECK(used == steps);
+
+  // Outside the table (here: other margins) the controller falls back to the full window unchanged.
+  ControllerConfig other = cfg;
+  other.margin_top_m = 0.04;
+  Controller fallback(other);
+  fallback.setFeasibilityEnvelope(envelope);
+  Controller reference(other);
+  used = 0;
+  const sim::RunSummary r_fb = sim::runScenario(fallback, sc, [&](const DebugFrame& f) { used += f.envelope_used ? 1 : 0; });
+  const sim::RunSummary r_ref = sim::runScenario(reference, sc);
+  CHECK(used == 0);
+  CHECK(r_fb.steps == r_ref.steps);
+  CHECK(r_fb.min_clearance_top_m == r_ref.min_clearance_top_m);
+}
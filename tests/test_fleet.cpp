@@ -0,0 +1,119 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "controller/ControllerFleet.hpp"
+#include "sim/Scenario.hpp"
+#include "utils/LogRecord.hpp"
+
+using namespace tlf;
+
+namespace {
+
+EnvironmentGeometry siteEnv(double ramp_slope_deg) {
+  sim::DockingEnv e;
+  e.ramp_slope_deg = ramp_slope_deg;
+  EnvironmentGeometry env;
+  env.profile = std::make_shared<const TerrainProfile>(sim::buildTerrainProfile(e));
+  return env;
+}
+
+// Measured state of truck i at tick k (deterministic, different per truck).
+void fillState(ControlInput& in, std::size_t i, int k) {
+  in.dt_s = 0.05;
+  in.s_m = -3.0 + 0.02 * k + 0.3 * static_cast<double>(i);
+  in.pitch_rad = 0.01 * static_cast<double>(i % 3);
+  in.lift_pos_m = 0.05 + 0.01 * static_cast<double>(i);
+  in.tilt_rad = -0.01 * static_cast<double>(i % 2);
+  in.rack.height_m = 2.2;
+  in.rack.length_m = 2.2;
+}
+
+}  // namespace
+
+TEST_CASE("ControllerFleet matches independently stepped controllers") {
+  const std::size_t trucks = 7;
+  for (auto kind : {ControllerKind::GridSearch, ControllerKind::MPC}) {
+    ControllerConfig cfg;
+    cfg.mpc_assumed_forward_speed_m_s = 0.1;
+
+    ControllerFleet fleet(kind, cfg, trucks, 3);
+    REQUIRE(fleet.size() == trucks);
+    REQUIRE(fleet.threads() == 3);
+    const std::size_t site_a = fleet.addSite(siteEnv(4.0));
+    const std::size_t site_b = fleet.addSite(siteEnv(6.0));
+    for (std::size_t i = 0; i < trucks; ++i) fleet.assignSite(i, (i % 2) ? site_b : site_a);
+
+    // Trucks at the same container share one read-only profile.
+    REQUIRE(fleet.input(0).env.profile == fleet.input(2).env.profile);
+    REQUIRE(fleet.input(0).env.profile != fleet.input(1).env.profile);
+
+    std::vector<std::unique_ptr<IController>> solo;
+    std::vector<ControlInput> solo_in(trucks);
+    for (std::size_t i = 0; i < trucks; ++i) {
+      solo.push_back(makeController(kind, cfg));
+      solo_in[i].env = fleet.input(i).env;
+    }
+
+    for (int k = 0; k < 20; ++k) {
+      for (std::size_t i = 0; i < trucks; ++i) {
+        fillState(fleet.input(i), i, k);
+        fillState(solo_in[i], i, k);
+      }
+      fleet.step();
+
+      for (std::size_t i = 0; i < trucks; ++i) {
+        ControlOutput expected;
+        solo[i]->step(solo_in[i], expected);
+        const ControlOutput& got = fleet.output(i);
+        REQUIRE(got.cmd.lift_target_m == expected.cmd.lift_target_m);
+        REQUIRE(got.cmd.tilt_target_rad == expected.cmd.tilt_target_rad);
+        REQUIRE(got.cmd.speed_limit_m_s == expected.cmd.speed_limit_m_s);
+        REQUIRE(got.safety.level == expected.safety.level);
+        REQUIRE(got.selected_cost == expected.selected_cost);
+        REQUIRE(fleet.commands()[i].lift_target_m == got.cmd.lift_target_m);
+        REQUIRE(fleet.commands()[i].tilt_target_rad == got.cmd.tilt_target_rad);
+      }
+    }
+
+    // A caller-owned batch gives the same commands as the slots.
+    ControllerFleet batch_fleet(kind, cfg, trucks, 2);
+    batch_fleet.step(solo_in.data());
+    fleet.reset();
+    for (std::size_t i = 0; i < trucks; ++i) fleet.input(i) = solo_in[i];
+    fleet.step();
+    for (std::size_t i = 0; i < trucks; ++i) {
+      REQUIRE(batch_fleet.commands()[i].lift_target_m == fleet.commands()[i].lift_target_m);
+      REQUIRE(batch_fleet.commands()[i].speed_limit_m_s == fleet.commands()[i].speed_limit_m_s);
+    }
+  }
+}
+
+TEST_CASE("Fleet outputs log the same records as DebugFrames") {
+  const std::size_t trucks = 4;
+  ControllerConfig cfg;
+  ControllerFleet fleet(ControllerKind::GridSearch, cfg, trucks, 2);
+  const std::size_t site = fleet.addSite(siteEnv(4.0));
+  std::vector<std::unique_ptr<IController>> solo;
+  for (std::size_t i = 0; i < trucks; ++i) {
+    fleet.assignSite(i, site);
+    solo.push_back(makeController(ControllerKind::GridSearch, cfg));
+  }
+
+  for (int k = 0; k < 10; ++k) {
+    for (std::size_t i = 0; i < trucks; ++i) fillState(fleet.input(i), i, k);
+    fleet.step();
+    for (std::size_t i = 0; i < trucks; ++i) {
+      const LogRecord got = toLogRecord(fleet.input(i), fleet.output(i));
+      const LogRecord expected = toLogRecord(solo[i]->step(fleet.input(i)));
+      for (const LogColumn& col : kLogColumns) {
+        const auto* a = reinterpret_cast<const unsigned char*>(&got) + col.offset;
+        const auto* b = reinterpret_cast<const unsigned char*>(&expected) + col.offset;
+        INFO(col.name);
+        REQUIRE(std::memcmp(a, b, col.type == LogColumnType::F64 ? sizeof(double) : sizeof(std::int32_t)) == 0);
+      }
+    }
+  }
+}
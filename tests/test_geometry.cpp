@@ -1,7 +1,12 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
 
+#include <cmath>
+#include <memory>
+
+#include "model/ClearanceCache.hpp"
 #include "model/Geometry.hpp"
+#include "model/GeometryKernels.hpp"
 
 using namespace tlf;
 
@@ -44,3 +49,189 @@ TEST_CASE("computeClearances scalar env") {
   REQUIRE(clr.clearance_top_m == Catch::Approx(0.2));  // 2.5-2.2-0.1
   REQUIRE(clr.clearance_bottom_m == Catch::Approx(0.1));  // 0.2-0.0-0.1
 }
+
+TEST_CASE("computeClearancesBatch matches per-candidate evaluation") {
+  RackParams rack;
+  rack.height_m = 2.3;
+  rack.length_m = 2.2;
+  rack.mount_offset_m = {0.25, -0.05};
+
+  ForkliftParams fl;
+  fl.mast_pivot_height_m = 0.15;
+
+  EnvironmentGeometry scalar;
+  scalar.floor_z_m = 0.0;
+  scalar.ceiling_z_m = 2.5;
+
+  EnvironmentGeometry planes;
+  planes.floor_plane = Plane{-0.07, 0.0, 1.0, 0.0};
+  planes.ceiling_plane = Plane{0.0, 0.0, 1.0, -2.5};
+
+  EnvironmentGeometry callbacks;
+  callbacks.floor_z_at_x_m = [](double x) { return (x < 0.0) ? 0.07 * x : 0.0; };
+  callbacks.ceiling_z_at_x_m = [](double x) { return (x < 0.5) ? 2.6 : 2.5; };
+
+  EnvironmentGeometry mixed;
+  mixed.floor_plane = Plane{-0.07, 0.0, 1.0, 0.0};
+  mixed.ceiling_z_at_x_m = [](double x) { return (x < 0.5) ? 2.6 : 2.5; };
+
+  const double lifts[] = {-0.1, 0.0, 0.05, 0.12, 0.3};
+  const double tilts[] = {-0.2, -0.05, 0.0, 0.1};
+
+  for (const EnvironmentGeometry* env : {&scalar, &planes, &callbacks, &mixed}) {
+    ClearanceBatch batch;
+    computeClearancesBatch(-0.4, lifts, 5, tilts, 4, 0.03, *env, rack, fl, 0.04, 0.05, &batch);
+    REQUIRE(batch.n_lift == 5);
+    REQUIRE(batch.n_tilt == 4);
+
+    for (size_t i = 0; i < 5; ++i) {
+      for (size_t j = 0; j < 4; ++j) {
+        const auto corners = computeRackCorners2D(-0.4, lifts[i], 0.03, tilts[j], *env, rack, fl);
+        const auto ref = computeClearances(corners, *env, 0.04, 0.05);
+        const auto got = batch.at(i, j);
+        REQUIRE(got.clearance_top_m == ref.clearance_top_m);
+        REQUIRE(got.clearance_bottom_m == ref.clearance_bottom_m);
+        REQUIRE(got.top_worst_point == ref.top_worst_point);
+        REQUIRE(got.bottom_worst_point == ref.bottom_worst_point);
+        REQUIRE(got.worst_point == ref.worst_point);
+      }
+    }
+  }
+}
+
+TEST_CASE("Float32 clearance batch stays within its tolerance of the double batch") {
+  RackParams rack;
+  rack.height_m = 2.3;
+  rack.length_m = 2.2;
+  rack.mount_offset_m = {0.25, -0.05};
+
+  ForkliftParams fl;
+  fl.mast_pivot_height_m = 0.15;
+
+  EnvironmentGeometry scalar;
+  scalar.floor_z_m = 0.0;
+  scalar.ceiling_z_m = 2.5;
+
+  EnvironmentGeometry planes;
+  planes.floor_plane = Plane{-0.07, 0.0, 1.0, 0.0};
+  planes.ceiling_plane = Plane{0.0, 0.0, 1.0, -2.5};
+
+  EnvironmentGeometry callbacks;
+  callbacks.floor_z_at_x_m = [](double x) { return (x < 0.0) ? 0.07 * x : 0.0; };
+  callbacks.ceiling_z_at_x_m = [](double x) { return 2.6 - 0.02 * x; };
+
+  EnvironmentGeometry profiled;
+  auto profile = std::make_shared<TerrainProfile>();
+  profile->floor = PiecewiseLinear({-5.0, 0.0, 20.0}, {-0.35, 0.0, 0.0});
+  profile->ceiling = PiecewiseLinear({-5.0, 0.5, 20.0}, {2.6, 2.6, 2.5});
+  profiled.profile = profile;
+
+  const double lifts[] = {-0.1, 0.0, 0.05, 0.12, 0.3, 0.41, 0.5};
+  const double tilts[] = {-0.2, -0.05, 0.0, 0.1, 0.17};
+
+  // Far from the origin too: the float kernel works relative to the mast base.
+  for (double s : {-0.4, 12.3}) {
+    for (const EnvironmentGeometry* env : {&scalar, &planes, &callbacks, &profiled}) {
+      ClearanceBatch ref;
+      computeClearancesBatch(s, lifts, 7, tilts, 5, 0.03, *env, rack, fl, 0.04, 0.05, &ref);
+      ClearanceBatchF got;
+      visitEnvironment(*env, [&](const auto& ceiling, const auto& floor) {
+        clearancesBatchWithF(s, lifts, 7, tilts, 5, 0.03, ceiling, floor, rack, fl, 0.04, 0.05, &got);
+      });
+      for (size_t i = 0; i < 7; ++i) {
+        for (size_t j = 0; j < 5; ++j) {
+          const auto r = ref.at(i, j);
+          REQUIRE(std::abs(got.clearance_top_m[got.index(i, j)] - r.clearance_top_m) < kFloatClearanceTolM / 10);
+          REQUIRE(std::abs(got.clearance_bottom_m[got.index(i, j)] - r.clearance_bottom_m) < kFloatClearanceTolM / 10);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("ClearanceCache reproduces direct evaluation and counts hits") {
+  RackParams rack;
+  rack.mount_offset_m = {0.0, 0.0};
+  ForkliftParams fl;
+
+  EnvironmentGeometry env;
+  env.ceiling_plane = Plane{0.02, 0.0, 1.0, -2.6};
+  env.floor_z_m = 0.0;
+
+  ClearanceCache cache;
+  cache.configure(64, 0.0, 0.0);
+  cache.beginStep(env, rack, fl, false);
+
+  for (int pass = 0; pass < 2; ++pass) {
+    for (int i = 0; i < 10; ++i) {
+      const double s = 0.1 * i;
+      const double lift = 0.05 + 0.01 * i;
+      const double margin = (pass == 0) ? 0.05 : 0.10;  // margins may change between lookups
+      const auto direct = computeClearances(computeRackCorners2D(s, lift, 0.01, -0.02, env, rack, fl), env, margin, margin);
+      const auto cached = cache.evaluate(s, lift, 0.01, -0.02, env, rack, fl, margin, margin);
+      REQUIRE(cached.clearance_top_m == direct.clearance_top_m);
+      REQUIRE(cached.clearance_bottom_m == direct.clearance_bottom_m);
+      REQUIRE(cached.worst_point == direct.worst_point);
+    }
+  }
+  REQUIRE(cache.misses() == 10);
+  REQUIRE(cache.hits() == 10);
+
+  // Entries survive a step only when asked to and the environment is unchanged.
+  cache.beginStep(env, rack, fl, true);
+  cache.evaluate(0.0, 0.05, 0.01, -0.02, env, rack, fl, 0.05, 0.05);
+  REQUIRE(cache.hits() == 11);
+
+  env.floor_z_m = 0.01;
+  cache.beginStep(env, rack, fl, true);
+  cache.evaluate(0.0, 0.05, 0.01, -0.02, env, rack, fl, 0.05, 0.05);
+  REQUIRE(cache.misses() == 11);
+
+  // A profile rebuilt every tick is a new environment, even if the allocator could reuse the address.
+  for (int tick = 0; tick < 3; ++tick) {
+    auto profile = std::make_shared<TerrainProfile>();
+    profile->floor = PiecewiseLinear({0.0, 1.0}, {0.0, 0.01 * tick});
+    profile->ceiling = PiecewiseLinear({0.0, 1.0}, {2.5, 2.5});
+    EnvironmentGeometry rebuilt;
+    rebuilt.profile = std::move(profile);
+    cache.beginStep(rebuilt, rack, fl, true);
+    if (tick > 0) REQUIRE_FALSE(cache.geometryUnchanged());
+  }
+  cache.beginStep(env, rack, fl, true);
+
+  // A positive quantum merges nearby poses.
+  cache.configure(64, 1e-3, 1e-3);
+  cache.beginStep(env, rack, fl, false);
+  cache.evaluate(0.5, 0.1, 0.0, 0.0, env, rack, fl, 0.05, 0.05);
+  cache.evaluate(0.5 + 1e-5, 0.1, 0.0, 1e-5, env, rack, fl, 0.05, 0.05);
+  REQUIRE(cache.hits() == 12);
+}
+
+TEST_CASE("visitEnvironment resolves the documented surface precedence") {
+  EnvironmentGeometry env;
+  env.ceiling_z_m = 2.4;
+  env.floor_z_m = 0.1;
+  env.ceiling_plane = Plane{0.0, 0.0, 1.0, -2.5};
+  env.floor_z_at_x_m = [](double x) { return 0.05 * x; };
+
+  auto check = [&](const EnvironmentGeometry& e) {
+    visitEnvironment(e, [&](const auto& ceiling, const auto& floor) {
+      for (double x : {-1.0, 0.0, 0.7, 3.0}) {
+        REQUIRE(ceiling(x) == envCeilingZAtX(e, x));
+        REQUIRE(floor(x) == envFloorZAtX(e, x));
+      }
+    });
+  };
+
+  check(env);  // plane ceiling over scalar, callback floor over scalar
+  env.ceiling_z_at_x_m = [](double x) { return 2.6 - 0.01 * x; };
+  env.floor_plane = Plane{-0.07, 0.0, 1.0, 0.0};
+  check(env);  // callbacks over planes
+
+  auto profile = std::make_shared<TerrainProfile>();
+  profile->floor = PiecewiseLinear({0.0, 1.0}, {0.0, 0.2});
+  profile->ceiling = PiecewiseLinear({0.0, 1.0}, {2.5, 2.4});
+  env.profile = profile;
+  check(env);  // profile over everything
+  check(EnvironmentGeometry{});  // defaults
+}
@@ -0,0 +1,77 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <thread>
+
+#include "controller/Controller.hpp"
+#include "controller/ControllerMPC.hpp"
+#include "utils/Instrumentation.hpp"
+
+using namespace tlf;
+
+TEST_CASE("Histogram buckets by powers of two") {
+  Histogram h;
+  for (std::uint64_t v : {0ull, 1ull, 3ull, 100ull, 1000ull}) h.record(v);
+  const auto s = h.snapshot();
+
+  if (!kInstrumentationEnabled) {
+    REQUIRE(s.count == 0);
+    return;
+  }
+  REQUIRE(s.count == 5);
+  REQUIRE(s.sum == 1104);
+  REQUIRE(s.max == 1000);
+  REQUIRE(s.buckets[0] == 1);
+  REQUIRE(s.buckets[1] == 1);
+  REQUIRE(s.buckets[2] == 1);
+  REQUIRE(s.buckets[7] == 1);   // 64..127
+  REQUIRE(s.buckets[10] == 1);  // 512..1023
+  REQUIRE(s.percentile(0.5) == 3);
+  REQUIRE(s.percentile(1.0) == 1000);
+}
+
+TEST_CASE("Controllers record per-step metrics readable from another thread") {
+  ControlInput in;
+  in.lift_pos_m = 0.10;
+  in.env.floor_z_m = 0.0;
+  in.env.ceiling_z_m = 2.6;
+  in.rack.height_m = 2.3;
+  in.rack.length_m = 2.3;
+  in.rack.mount_offset_m = {0.0, 0.0};
+
+  ControllerMPC mpc;
+  Controller grid;
+
+  std::atomic<bool> done{false};
+  std::thread reader([&] {
+    while (!done.load()) (void)mpc.instrumentation().snapshot();
+  });
+  ControlOutput out;
+  for (int k = 0; k < 10; ++k) {
+    mpc.step(in, out);
+    grid.step(in, out);
+  }
+  done.store(true);
+  reader.join();
+
+  const auto m = mpc.instrumentation().snapshot();
+  const auto g = grid.instrumentation().snapshot();
+  if (!kInstrumentationEnabled) {
+    REQUIRE(m.step_latency_ns.count == 0);
+    return;
+  }
+  REQUIRE(m.step_latency_ns.count == 10);
+  REQUIRE(m.step_latency_ns.max > 0);
+  REQUIRE(m.beam_nodes_expanded.sum > 0);
+  REQUIRE(m.beam_nodes_pruned.sum > 0);
+  REQUIRE(m.candidates_feasible.sum <= m.candidates_evaluated.sum);
+  REQUIRE(m.fallback_grid_steps == 0);
+
+  REQUIRE(g.candidates_evaluated.sum == 10 * 81);
+  REQUIRE(g.candidates_feasible.max <= 81);
+  REQUIRE(g.beam_nodes_expanded.count == 10);
+  REQUIRE(g.beam_nodes_expanded.sum == 0);
+
+  grid.instrumentation().reset();
+  REQUIRE(grid.instrumentation().snapshot().step_latency_ns.count == 0);
+}
@@ -0,0 +1,75 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "controller/Types.hpp"
+#include "utils/LodIndex.hpp"
+
+using namespace tlf;
+
+TEST_CASE("LodIndex keeps every bucket's extrema and all STOP entries") {
+  std::mt19937 rng(7);
+  std::normal_distribution<double> noise(0.0, 0.01);
+
+  LodIndex lod(2);
+  double v[2] = {0.2, 0.3};
+  std::vector<std::int32_t> level;
+  const int n = 5000;
+  for (int i = 0; i < n; ++i) {
+    v[0] += noise(rng);
+    v[1] = std::sin(0.01 * i) + noise(rng);
+    const bool stop = (i / 37) % 29 == 3;  // short STOP episodes
+    level.push_back(static_cast<std::int32_t>(stop ? SafetyLevel::STOP : SafetyLevel::WARN));
+    lod.append(v, level.back());
+  }
+  REQUIRE(lod.frames() == static_cast<std::size_t>(n));
+  REQUIRE(!lod.stopEntries().empty());
+
+  std::vector<std::uint32_t> sel;
+  lod.select(10, 200, 400, &sel);
+  REQUIRE(sel.size() == 190);  // fits: every frame
+
+  const std::size_t ranges[][2] = {{0, 5000}, {0, 4999}, {123, 4567}, {1000, 1100}, {4090, 5000}, {17, 18}};
+  for (const auto& r : ranges) {
+    for (const std::size_t buckets : {1, 7, 64, 300}) {
+      lod.select(r[0], r[1], buckets, &sel);
+      REQUIRE(!sel.empty());
+      REQUIRE(std::is_sorted(sel.begin(), sel.end()));
+      REQUIRE(std::adjacent_find(sel.begin(), sel.end()) == sel.end());
+      REQUIRE(sel.front() == r[0]);
+      REQUIRE(sel.back() == r[1] - 1);
+      std::size_t stops_in_range = 0;
+      for (const auto f : lod.stopEntries()) {
+        if (f < r[0] || f >= r[1]) continue;
+        ++stops_in_range;
+        REQUIRE(std::binary_search(sel.begin(), sel.end(), f));
+      }
+      REQUIRE(sel.size() <= 2 * 2 * (buckets + 2) + 2 + stops_in_range);
+
+      // The range minimum / maximum of every channel are among the selected frames.
+      for (std::size_t c = 0; c < 2; ++c) {
+        const auto& ch = lod.channel(c);
+        const auto lo = std::min_element(ch.begin() + r[0], ch.begin() + r[1]);
+        const auto hi = std::max_element(ch.begin() + r[0], ch.begin() + r[1]);
+        double sel_lo = ch[sel[0]];
+        double sel_hi = ch[sel[0]];
+        for (const auto f : sel) {
+          sel_lo = std::min(sel_lo, ch[f]);
+          sel_hi = std::max(sel_hi, ch[f]);
+        }
+        REQUIRE(sel_lo == *lo);
+        REQUIRE(sel_hi == *hi);
+      }
+    }
+  }
+
+  // Appending after a query extends the open buckets.
+  v[0] = -1.0;
+  lod.append(v, static_cast<std::int32_t>(SafetyLevel::OK));
+  lod.select(0, lod.frames(), 16, &sel);
+  REQUIRE(std::binary_search(sel.begin(), sel.end(), static_cast<std::uint32_t>(n)));
+}
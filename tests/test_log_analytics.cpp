@@ -0,0 +1,119 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "utils/BinaryLog.hpp"
+#include "utils/CsvLog.hpp"
+#include "utils/LogAnalytics.hpp"
+
+using namespace tlf;
+
+namespace {
+
+struct Frame {
+  SafetyLevel level;
+  TerrainState terrain;
+  double top;
+  double bottom;
+  CornerId worst;
+};
+
+std::vector<LogRecord> scriptedRun() {
+  const Frame frames[] = {
+      {SafetyLevel::OK, TerrainState::Ground, 0.20, 0.20, CornerId::RearBottom},
+      {SafetyLevel::WARN, TerrainState::Ground, 0.04, 0.30, CornerId::RearTop},  // near miss starts
+      {SafetyLevel::STOP, TerrainState::OnRamp, 0.01, 0.30, CornerId::RearTop},  // STOP entry
+      {SafetyLevel::STOP, TerrainState::OnRamp, 0.30, 0.02, CornerId::FrontBottom},
+      {SafetyLevel::OK, TerrainState::OnRamp, 0.20, 0.20, CornerId::RearBottom},
+      {SafetyLevel::WARN, TerrainState::InContainer, 0.20, 0.03, CornerId::FrontBottom},  // near miss starts
+      {SafetyLevel::STOP, TerrainState::InContainer, -0.20, 0.10, CornerId::RearTop},     // STOP entry
+      {SafetyLevel::OK, TerrainState::InContainer, 0.30, 0.30, CornerId::RearBottom},
+      {SafetyLevel::OK, TerrainState::InContainer, 0.30, 0.30, CornerId::RearBottom},
+      {SafetyLevel::OK, TerrainState::InContainer, 0.90, 0.90, CornerId::RearBottom},
+  };
+  std::vector<LogRecord> out;
+  int k = 0;
+  for (const auto& f : frames) {
+    LogRecord r;
+    r.time_s = 0.1 * k++;
+    r.clearance_top_m = f.top;
+    r.clearance_bottom_m = f.bottom;
+    r.safety_level = static_cast<std::int32_t>(f.level);
+    r.terrain_state = static_cast<std::int32_t>(f.terrain);
+    r.worst_point_id = static_cast<std::int32_t>(f.worst);
+    out.push_back(r);
+  }
+  return out;
+}
+
+void requireScriptedTotals(const LogStats& s, int runs) {
+  REQUIRE(s.frames == static_cast<std::uint64_t>(10 * runs));
+  REQUIRE(s.duration_s == Catch::Approx(0.9 * runs));
+  REQUIRE(s.level_time_s[0] == Catch::Approx(0.4 * runs));
+  REQUIRE(s.level_time_s[1] == Catch::Approx(0.2 * runs));
+  REQUIRE(s.level_time_s[2] == Catch::Approx(0.3 * runs));
+  REQUIRE(s.level_time_s[3] == 0.0);
+  REQUIRE(s.terrain_time_s[0] == Catch::Approx(0.2 * runs));
+  REQUIRE(s.terrain_time_s[2] == Catch::Approx(0.3 * runs));
+  REQUIRE(s.terrain_time_s[4] == Catch::Approx(0.4 * runs));
+  REQUIRE(s.stop_events == static_cast<std::uint64_t>(2 * runs));
+  REQUIRE(s.near_miss_events[static_cast<int>(CornerId::RearTop)] == static_cast<std::uint64_t>(runs));
+  REQUIRE(s.near_miss_events[static_cast<int>(CornerId::FrontBottom)] == static_cast<std::uint64_t>(runs));
+  REQUIRE(s.near_miss_events[static_cast<int>(CornerId::RearBottom)] == 0);
+  REQUIRE(s.min_clearance_top_m == Catch::Approx(-0.20));
+  REQUIRE(s.min_clearance_bottom_m == Catch::Approx(0.02));
+
+  std::uint64_t hist_total = 0;
+  for (const auto n : s.clearance_hist) hist_total += n;
+  REQUIRE(hist_total == s.frames);
+  REQUIRE(s.clearance_hist.front() == static_cast<std::uint64_t>(runs));  // -0.20 clamps into the first bin
+  REQUIRE(s.clearance_hist.back() == static_cast<std::uint64_t>(runs));   // 0.90 clamps into the last bin
+}
+
+}  // namespace
+
+TEST_CASE("Log analytics aggregates dwell times, events and histograms in one pass") {
+  const auto records = scriptedRun();
+
+  LogStatsAccumulator acc;
+  for (const auto& r : records) acc.add(r);
+  requireScriptedTotals(acc.stats(), 1);
+
+  const auto dir = std::filesystem::temp_directory_path() / "tlf_test_log_analytics";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir / "day2");
+  {
+    CsvLogger csv((dir / "run_a.csv").string());
+    BinaryLogger bin((dir / "day2" / "run_b.tlfb").string(), LogCodec::None, 4);
+    csv.writeHeader();
+    for (const auto& r : records) {
+      csv.writeRecord(r);
+      bin.writeRecord(r);
+    }
+  }
+
+  const auto paths = listLogFiles(dir.string());
+  REQUIRE(paths.size() == 2);
+
+  const auto one = analyzeLogFiles(paths, {}, 1);
+  const auto two = analyzeLogFiles(paths, {}, 2);
+  REQUIRE(one.runs.size() == 2);
+  for (const auto& run : one.runs) {
+    REQUIRE(run.error.empty());
+    requireScriptedTotals(run, 1);
+  }
+  requireScriptedTotals(one.fleet, 2);
+  REQUIRE(two.fleet.duration_s == one.fleet.duration_s);
+  REQUIRE(two.fleet.clearance_hist == one.fleet.clearance_hist);
+  REQUIRE(logSummaryToJson(two) == logSummaryToJson(one));
+
+  const std::string json = logSummaryToJson(one);
+  REQUIRE(json.find("\"format\":\"tlf_log_summary\"") != std::string::npos);
+  REQUIRE(json.find("\"stop_events\":4") != std::string::npos);
+  REQUIRE(json.find("\"FrontInContainerRearOnRamp\":0") != std::string::npos);
+
+  std::filesystem::remove_all(dir);
+}
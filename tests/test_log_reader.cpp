@@ -0,0 +1,111 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "controller/Controller.hpp"
+#include "utils/BinaryLog.hpp"
+#include "utils/CsvLog.hpp"
+#include "utils/LogReader.hpp"
+
+using namespace tlf;
+
+static std::string tempLogPath(const char* name) { return (std::filesystem::temp_directory_path() / name).string(); }
+
+static std::vector<LogRecord> sampleRecords() {
+  Controller c;
+  ControlInput in;
+  in.env.floor_z_m = 0.0;
+  in.env.ceiling_z_m = 2.6;
+  in.rack.mount_offset_m = {0.0, 0.0};
+
+  std::vector<LogRecord> out;
+  for (int k = 0; k < 40; ++k) {
+    in.s_m = -1.0 + 0.05 * k;
+    out.push_back(toLogRecord(c.step(in)));
+  }
+  return out;
+}
+
+TEST_CASE("LogReader reads CsvLogger and BinaryLogger output") {
+  const auto records = sampleRecords();
+  const std::string csv_path = tempLogPath("tlf_test_reader.csv");
+  const std::string bin_path = tempLogPath("tlf_test_reader.tlfb");
+  {
+    CsvLogger csv(csv_path);
+    BinaryLogger bin(bin_path, LogCodec::None, 16);
+    csv.writeHeader();
+    for (const auto& r : records) {
+      csv.writeRecord(r);
+      bin.writeRecord(r);
+    }
+  }
+
+  LogReader csv(csv_path);
+  REQUIRE(csv.good());
+  REQUIRE(csv.format() == LogReader::Format::Csv);
+  REQUIRE(csv.columnNames().size() == kLogColumnCount);
+  std::size_t i = 0;
+  for (const LogRecord& r : csv) {
+    REQUIRE(i < records.size());
+    // CSV stores 6 decimals.
+    REQUIRE(std::abs(r.s_m - records[i].s_m) < 1e-6);
+    REQUIRE(std::abs(r.clearance_top_m - records[i].clearance_top_m) < 1e-6);
+    REQUIRE(std::abs(r.lift_cmd_m - records[i].lift_cmd_m) < 1e-6);
+    REQUIRE(r.safety_level == records[i].safety_level);
+    REQUIRE(r.worst_point_id == records[i].worst_point_id);
+    ++i;
+  }
+  REQUIRE(i == records.size());
+  REQUIRE(csv.skippedLines() == 0);
+
+  LogReader bin(bin_path);
+  REQUIRE(bin.good());
+  REQUIRE(bin.format() == LogReader::Format::Binary);
+  const LogColumnData cols = bin.readColumns();
+  REQUIRE(cols.rows == records.size());
+  const auto* top = cols.column("clearance_top");
+  REQUIRE(top != nullptr);
+  for (std::size_t k = 0; k < records.size(); ++k) {
+    REQUIRE((*top)[k] == records[k].clearance_top_m);
+    REQUIRE(cols.column(21)[k] == records[k].safety_level);
+  }
+
+  std::remove(csv_path.c_str());
+  std::remove(bin_path.c_str());
+}
+
+TEST_CASE("LogReader matches CSV columns by name and skips malformed lines") {
+  const std::string path = tempLogPath("tlf_test_reader_custom.csv");
+  {
+    std::ofstream out(path);
+    out << "s,extra,clearance_top,safety_level\r\n";
+    out << "1.5,abc,0.25,2\r\n";
+    out << "\n";
+    out << "2.0,x,oops,1\n";
+    out << "2.5,y,-0.125,3\n";
+    out << "3.0,z,0.5\n";
+  }
+
+  LogReader reader(path);
+  REQUIRE(reader.good());
+  std::vector<LogRecord> rows;
+  LogRecord r;
+  while (reader.next(&r)) rows.push_back(r);
+
+  REQUIRE(rows.size() == 2);
+  REQUIRE(rows[0].s_m == 1.5);
+  REQUIRE(rows[0].clearance_top_m == 0.25);
+  REQUIRE(rows[0].safety_level == 2);
+  REQUIRE(rows[0].lift_m == 0.0);  // column not present
+  REQUIRE(rows[1].s_m == 2.5);
+  REQUIRE(rows[1].clearance_top_m == -0.125);
+  REQUIRE(reader.skippedLines() == 2);
+
+  REQUIRE_FALSE(LogReader(tempLogPath("tlf_test_reader_missing.csv")).good());
+  std::remove(path.c_str());
+}
@@ -0,0 +1,83 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "utils/BinaryLog.hpp"
+#include "utils/Replay.hpp"
+
+using namespace tlf;
+
+static std::string tempLogPath(const std::string& name) { return (std::filesystem::temp_directory_path() / name).string(); }
+
+// Drives a controller through a scalar-ceiling pass and returns the log it would have written.
+static std::vector<LogRecord> recordRun(ControllerKind kind, const ControllerConfig& cfg, const RackParams& rack) {
+  auto c = makeController(kind, cfg);
+  ControlInput in;
+  in.dt_s = 0.1;
+  in.rack = rack;
+  in.lift_pos_m = 0.1;
+  std::vector<LogRecord> out;
+  for (int k = 0; k < 60; ++k) {
+    in.s_m = -2.0 + 0.05 * k;
+    in.pitch_rad = (in.s_m < 0.0) ? 0.04 : 0.0;
+    in.env.floor_z_m = 0.0;
+    in.env.ceiling_z_m = (in.s_m < -0.5) ? 3.0 : 2.55;
+    const DebugFrame f = c->step(in);
+    out.push_back(toLogRecord(f));
+    in.lift_pos_m += 0.5 * (f.cmd.lift_target_m - in.lift_pos_m);
+    in.tilt_rad += 0.5 * (f.cmd.tilt_target_rad - in.tilt_rad);
+  }
+  return out;
+}
+
+TEST_CASE("Replaying a log with the recording config reproduces it") {
+  ReplayOptions opt;
+  opt.rack.height_m = 2.3;
+  opt.rack.mount_offset_m = {0.0, 0.0};
+
+  for (auto kind : {ControllerKind::GridSearch, ControllerKind::MPC}) {
+    opt.kind = kind;
+    const auto records = recordRun(kind, opt.config, opt.rack);
+    const ReplayResult r = replayRecords(records, opt);
+    REQUIRE(r.ok);
+    REQUIRE(r.frames == records.size());
+    REQUIRE(r.identical());
+    REQUIRE(r.first_diff_frame == -1);
+    REQUIRE(r.max_lift_diff_m < 1e-9);
+  }
+}
+
+TEST_CASE("Replay flags a changed config and runs files in parallel") {
+  ReplayOptions opt;
+  opt.rack.height_m = 2.3;
+  opt.rack.mount_offset_m = {0.0, 0.0};
+  const auto records = recordRun(ControllerKind::GridSearch, opt.config, opt.rack);
+
+  std::vector<std::string> paths;
+  for (int i = 0; i < 4; ++i) {
+    paths.push_back(tempLogPath("tlf_test_replay_" + std::to_string(i) + ".tlfb"));
+    BinaryLogger log(paths.back());
+    for (const auto& r : records) log.writeRecord(r);
+  }
+  paths.push_back(tempLogPath("tlf_test_replay_missing.tlfb"));
+
+  const auto same = replayFiles(paths, opt, 3);
+  REQUIRE(same.size() == paths.size());
+  for (int i = 0; i < 4; ++i) {
+    REQUIRE(same[static_cast<size_t>(i)].path == paths[static_cast<size_t>(i)]);
+    REQUIRE(same[static_cast<size_t>(i)].identical());
+  }
+  REQUIRE_FALSE(same.back().ok);
+
+  opt.config.margin_top_m += 0.15;
+  const auto changed = replayFiles(paths, opt, 2);
+  REQUIRE(changed[0].ok);
+  REQUIRE_FALSE(changed[0].identical());
+  REQUIRE(changed[0].first_diff_frame >= 0);
+  REQUIRE(changed[0].command_diff_frames == changed[3].command_diff_frames);
+
+  for (const auto& p : paths) std::remove(p.c_str());
+}
@@ -1,6 +1,16 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <cmath>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "controller/Controller.hpp"
+#include "controller/ControllerFactory.hpp"
+#include "controller/ControllerMPC.hpp"
+#include "controller/SearchCore.hpp"
+#include "sim/Simulation.hpp"
 
 using namespace tlf;
 
@@ -46,3 +56,695 @@ TEST_CASE("Controller enters DEGRADED on invalid inputs") {
   const auto f = c.step(in);
   REQUIRE(f.safety.level == SafetyLevel::DEGRADED);
 }
+
+TEST_CASE("Shared search core: step limits and the max-min clearance grid") {
+  ControllerConfig cfg;
+  cfg.lookahead_s_m = 0.5;
+
+  ControlInput in;
+  in.env.floor_z_m = 0.0;
+  in.env.ceiling_z_m = 2.5;
+  in.rack.height_m = 2.3;
+  in.rack.length_m = 2.3;
+  in.lift_pos_m = 0.15;
+
+  const StepLimits ok = makeStepLimits(cfg, in);
+  REQUIRE_FALSE(ok.degraded);
+  REQUIRE(ok.use_lookahead);
+  REQUIRE(ok.margin_top_m == cfg.margin_top_m);
+
+  ControlInput jitter = in;
+  jitter.pitch_rate_rad_s = 2.0 * cfg.pitch_rate_jitter_threshold_rad_s;
+  const StepLimits deg = makeStepLimits(cfg, jitter);
+  REQUIRE(deg.degraded);
+  REQUIRE(deg.degraded_code == SafetyCode::PitchJitter);
+  REQUIRE(deg.margin_top_m == cfg.margin_top_m * cfg.degraded_margin_multiplier);
+  REQUIRE(deg.speed_mult == cfg.degraded_speed_multiplier);
+
+  ControlInput bad = in;
+  bad.s_m = std::nan("");
+  REQUIRE(makeStepLimits(cfg, bad).degraded_code == SafetyCode::InputInvalid);
+
+  // Row-wise evaluation under a budget it never exhausts picks what the full pass picks.
+  std::vector<double> lifts;
+  std::vector<double> tilts;
+  fillAxis(lifts, 9, 0.0, 0.4);
+  fillAxis(tilts, 7, -0.1, 0.1);
+  REQUIRE(lifts.front() == 0.0);
+  REQUIRE(lifts.back() == 0.4);
+
+  ClearanceBatch batch;
+  ClearanceBatch batch_ahead;
+  Deadline none(0);
+  const auto full = maxMinClearanceGrid(in, ok, lifts, tilts, in.lift_pos_m, in.tilt_rad, none, &batch, &batch_ahead);
+  Deadline generous(10 * 1000 * 1000);
+  const auto rows = maxMinClearanceGrid(in, ok, lifts, tilts, in.lift_pos_m, in.tilt_rad, generous, &batch, &batch_ahead);
+  REQUIRE(full.evaluated == 9 * 7);
+  REQUIRE(rows.evaluated == full.evaluated);
+  REQUIRE(rows.lift_m == full.lift_m);
+  REQUIRE(rows.tilt_rad == full.tilt_rad);
+  REQUIRE(rows.min_clearance_m == full.min_clearance_m);
+}
+
+TEST_CASE("Slim ControlOutput step matches DebugFrame step") {
+  ControllerConfig cfg;
+  cfg.mpc_assumed_forward_speed_m_s = 0.1;
+
+  ControlInput in;
+  in.dt_s = 0.02;
+  in.lift_pos_m = 0.10;
+  in.env.floor_z_m = 0.0;
+  in.env.ceiling_z_m = 2.5;
+  in.rack.height_m = 2.3;
+  in.rack.length_m = 2.3;
+  in.rack.mount_offset_m = {0.0, 0.0};
+
+  Controller grid_full(cfg), grid_slim(cfg);
+  ControllerMPC mpc_full(cfg), mpc_slim(cfg);
+  std::pair<IController*, IController*> pairs[] = {{&grid_full, &grid_slim}, {&mpc_full, &mpc_slim}};
+
+  for (auto& [full, slim] : pairs) {
+    for (int k = 0; k < 5; ++k) {
+      const DebugFrame f = full->step(in);
+      ControlOutput out;
+      slim->step(in, out);
+
+      REQUIRE(out.time_s == f.time_s);
+      REQUIRE(out.cmd.lift_target_m == f.cmd.lift_target_m);
+      REQUIRE(out.cmd.tilt_target_rad == f.cmd.tilt_target_rad);
+      REQUIRE(out.cmd.speed_limit_m_s == f.cmd.speed_limit_m_s);
+      REQUIRE(out.safety.level == f.safety.level);
+      REQUIRE(out.safety.code == f.safety.code);
+      REQUIRE(out.safety.message == toString(out.safety.code));
+      REQUIRE(out.safety.clearance_top_m == f.safety.clearance_top_m);
+      REQUIRE(out.had_feasible_solution == f.had_feasible_solution);
+
+      in.lift_pos_m = f.cmd.lift_target_m;
+      in.tilt_rad = f.cmd.tilt_target_rad;
+    }
+  }
+}
+
+TEST_CASE("Coarse-to-fine search tracks the dense grid with fewer evaluations") {
+  ControllerConfig dense_cfg;
+  dense_cfg.margin_top_m = 0.12;
+  dense_cfg.search_lift_half_range_m = 0.2;
+  dense_cfg.search_tilt_half_range_rad = 0.25;
+  dense_cfg.grid_lift_steps = 41;
+  dense_cfg.grid_tilt_steps = 41;
+
+  ControllerConfig ctf_cfg = dense_cfg;
+  ctf_cfg.search_mode = SearchMode::CoarseToFine;
+
+  const double lift_cell = 2.0 * dense_cfg.search_lift_half_range_m / 40.0;
+  const double tilt_cell = 2.0 * dense_cfg.search_tilt_half_range_rad / 40.0;
+
+  for (double pitch : {0.0, 0.03, 0.07}) {
+    for (double lift : {0.0, 0.1, 0.2}) {
+      Controller dense(dense_cfg);
+      Controller ctf(ctf_cfg);
+
+      ControlInput in;
+      in.s_m = 0.3;
+      in.pitch_rad = pitch;
+      in.lift_pos_m = lift;
+      in.env.floor_z_m = 0.0;
+      in.env.ceiling_z_m = 2.5;
+      in.rack.height_m = 2.2;
+      in.rack.length_m = 2.2;
+      in.rack.mount_offset_m = {0.25, 0.0};
+      in.forklift.mast_pivot_height_m = 0.1;
+
+      const auto fd = dense.step(in);
+      const auto fc = ctf.step(in);
+
+      REQUIRE(fc.had_feasible_solution == fd.had_feasible_solution);
+      REQUIRE(std::abs(fc.cmd.lift_target_m - fd.cmd.lift_target_m) <= 2.0 * lift_cell);
+      REQUIRE(std::abs(fc.cmd.tilt_target_rad - fd.cmd.tilt_target_rad) <= 2.0 * tilt_cell);
+      REQUIRE(fd.candidates_evaluated == 41 * 41);
+      REQUIRE(fc.candidates_evaluated * 4 < fd.candidates_evaluated);
+    }
+  }
+}
+
+TEST_CASE("Local refinement lets a 9x9 grid match the 41x41 grid") {
+  ControllerConfig dense_cfg;
+  dense_cfg.margin_top_m = 0.12;
+  dense_cfg.search_lift_half_range_m = 0.2;
+  dense_cfg.search_tilt_half_range_rad = 0.25;
+  dense_cfg.grid_lift_steps = 41;
+  dense_cfg.grid_tilt_steps = 41;
+
+  ControllerConfig coarse_cfg = dense_cfg;
+  coarse_cfg.grid_lift_steps = 9;
+  coarse_cfg.grid_tilt_steps = 9;
+
+  ControllerConfig refined_cfg = coarse_cfg;
+  refined_cfg.local_refine_iterations = 2;
+  refined_cfg.local_refine_evals = 8;
+
+  // A 2.32 m rack under a 2.5 m ceiling leaves a feasible band thinner than one 9x9 cell.
+  for (double rack_h : {2.2, 2.32}) {
+    for (double pitch : {0.0, 0.03, 0.07}) {
+      for (double lift : {0.0, 0.1, 0.2}) {
+        Controller dense(dense_cfg);
+        Controller coarse(coarse_cfg);
+        Controller refined(refined_cfg);
+
+        ControlInput in;
+        in.s_m = 0.3;
+        in.pitch_rad = pitch;
+        in.lift_pos_m = lift;
+        in.env.floor_z_m = 0.0;
+        in.env.ceiling_z_m = 2.5;
+        in.rack.height_m = rack_h;
+        in.rack.length_m = 2.2;
+        in.rack.mount_offset_m = {0.25, 0.0};
+        in.forklift.mast_pivot_height_m = 0.1;
+
+        const auto fd = dense.step(in);
+        const auto fc = coarse.step(in);
+        const auto fr = refined.step(in);
+
+        REQUIRE(fr.had_feasible_solution == fd.had_feasible_solution);
+        if (fc.had_feasible_solution) REQUIRE(fr.selected_cost <= fc.selected_cost);
+        if (fd.had_feasible_solution) REQUIRE(fr.selected_cost <= fd.selected_cost * 1.15 + 1e-9);
+        REQUIRE(fr.candidates_evaluated * 10 < fd.candidates_evaluated);
+      }
+    }
+  }
+}
+
+TEST_CASE("Float32 candidate scoring selects exactly what the double grid selects") {
+  // Scalar surfaces sampled at s: profiles always take the double kernel, which would not test anything.
+  sim::Scenario sc = sim::dockingDemoScenario();
+  sc.use_profile = false;
+  ControllerConfig base = sim::dockingDemoConfig(ControllerKind::GridSearch);
+  ControllerConfig lookahead = base;
+  lookahead.lookahead_s_m = 0.3;
+  ControllerConfig ctf = base;
+  ctf.search_mode = SearchMode::CoarseToFine;
+  ControllerConfig refine = base;
+  refine.local_refine_iterations = 2;
+
+  for (const ControllerConfig& cfg : {base, lookahead, ctf, refine}) {
+    std::vector<DebugFrame> ref, got;
+    Controller dbl(cfg);
+    sim::runScenario(dbl, sc, [&](const DebugFrame& f) { ref.push_back(f); });
+
+    ControllerConfig f32_cfg = cfg;
+    f32_cfg.float32_candidates = true;
+    Controller f32(f32_cfg);
+    long rechecks = 0, evaluated = 0;
+    sim::runScenario(f32, sc, [&](const DebugFrame& f) {
+      got.push_back(f);
+      rechecks += f.float32_rechecks;
+      evaluated += f.candidates_evaluated;
+    });
+
+    REQUIRE(got.size() == ref.size());
+    for (size_t k = 0; k < ref.size(); ++k) {
+      REQUIRE(got[k].cmd.lift_target_m == ref[k].cmd.lift_target_m);
+      REQUIRE(got[k].cmd.tilt_target_rad == ref[k].cmd.tilt_target_rad);
+      REQUIRE(got[k].cmd.speed_limit_m_s == ref[k].cmd.speed_limit_m_s);
+      REQUIRE(got[k].safety.level == ref[k].safety.level);
+      REQUIRE(got[k].safety.clearance_top_m == ref[k].safety.clearance_top_m);
+      REQUIRE(got[k].selected_cost == ref[k].selected_cost);
+    }
+    REQUIRE(dbl.instrumentation().snapshot().candidates_feasible.sum ==
+            f32.instrumentation().snapshot().candidates_feasible.sum);
+    REQUIRE(rechecks > 0);  // the float path ran
+    REQUIRE(rechecks * 10 < evaluated);
+  }
+}
+
+TEST_CASE("Float32 candidate scoring falls back to double on a stepped ceiling") {
+  ControllerConfig cfg;
+  cfg.grid_lift_steps = 21;
+  cfg.grid_tilt_steps = 21;
+  ControllerConfig f32_cfg = cfg;
+  f32_cfg.float32_candidates = true;
+
+  ControlInput flat;
+  flat.lift_pos_m = 0.05;
+  flat.pitch_rad = 0.01;
+  flat.env.floor_z_m = 0.0;
+  flat.env.ceiling_z_m = 2.6;
+  flat.rack.height_m = 2.3;
+  flat.rack.length_m = 2.3;
+  flat.rack.mount_offset_m = {0.1, 0.0};
+
+  // The ceiling drops right at the front-top corner of the pose chosen under the flat ceiling: in double
+  // that pose reads the low side, while a float corner rounded left of the step would read it as free.
+  for (int k = 0; k < 40; ++k) {
+    flat.s_m = 0.3 + 0.0137 * k;
+    Controller probe(cfg);
+    const DebugFrame chosen = probe.step(flat);
+    const auto corners = computeRackCorners2D(flat.s_m, chosen.cmd.lift_target_m, flat.pitch_rad,
+                                              chosen.cmd.tilt_target_rad, flat.env, flat.rack, flat.forklift);
+    const double x_step = corners.p[static_cast<int>(CornerId::FrontTop)].x;
+
+    auto profile = std::make_shared<TerrainProfile>();
+    profile->floor = PiecewiseLinear(0.0);
+    profile->ceiling = PiecewiseLinear({-10.0, x_step, x_step, 20.0}, {2.6, 2.6, 2.0, 2.0});
+    ControlInput stepped = flat;
+    stepped.env = EnvironmentGeometry{};
+    stepped.env.profile = profile;
+
+    Controller dbl(cfg);
+    Controller f32(f32_cfg);
+    const DebugFrame a = dbl.step(stepped);
+    const DebugFrame b = f32.step(stepped);
+    REQUIRE(b.cmd.lift_target_m == a.cmd.lift_target_m);
+    REQUIRE(b.cmd.tilt_target_rad == a.cmd.tilt_target_rad);
+    REQUIRE(b.selected_cost == a.selected_cost);
+    REQUIRE(b.safety.level == a.safety.level);
+    REQUIRE(f32.instrumentation().snapshot().candidates_feasible.sum ==
+            dbl.instrumentation().snapshot().candidates_feasible.sum);
+    REQUIRE(b.float32_rechecks == 0);  // profiles are scored in double
+  }
+}
+
+TEST_CASE("Unchanged inputs reuse the previous command until a threshold is crossed") {
+  ControlInput in;
+  in.dt_s = 0.02;
+  in.lift_pos_m = 0.40;
+  in.env.floor_z_m = 0.0;
+  in.env.ceiling_z_m = 3.2;
+  in.rack.height_m = 2.3;
+  in.rack.length_m = 2.3;
+
+  for (bool mpc : {false, true}) {
+    ControllerConfig cfg;
+    cfg.reuse_unchanged_input = true;
+    ControllerConfig ref_cfg = cfg;
+    ref_cfg.reuse_unchanged_input = false;
+    std::unique_ptr<IController> c, ref;
+    if (mpc) {
+      c = std::make_unique<ControllerMPC>(cfg);
+      ref = std::make_unique<ControllerMPC>(ref_cfg);
+    } else {
+      c = std::make_unique<Controller>(cfg);
+      ref = std::make_unique<Controller>(ref_cfg);
+    }
+
+    ControlInput x = in;
+    const auto f0 = c->step(x);
+    REQUIRE_FALSE(f0.search_reused);
+    REQUIRE(f0.safety.level == SafetyLevel::OK);
+
+    // Creeping within the thresholds: one re-check per step, and the same current-pose safety and speed
+    // as a full search.
+    for (int k = 0; k < 5; ++k) {
+      x.s_m += 1e-5;
+      const auto f = c->step(x);
+      const auto r = ref->step(x);
+      REQUIRE(f.search_reused);
+      REQUIRE(f.candidates_evaluated == 1);
+      REQUIRE(f.had_feasible_solution);
+      REQUIRE(f.safety.level == r.safety.level);
+      REQUIRE(f.safety.clearance_top_m == r.safety.clearance_top_m);
+      REQUIRE(f.cmd.speed_limit_m_s == r.cmd.speed_limit_m_s);
+      if (!mpc) REQUIRE(f.cmd.lift_target_m == f0.cmd.lift_target_m);
+    }
+
+    // Deltas are measured from the solved input, so the creep eventually triggers a search.
+    x.s_m = in.s_m + 2.0 * cfg.reuse_threshold_s_m;
+    REQUIRE_FALSE(c->step(x).search_reused);
+    REQUIRE(c->step(x).search_reused);
+
+    // Within the thresholds, a change of the current pose's safety level searches at once. The ceiling
+    // leaves the top clearance 5 um above the WARN threshold; a 10 um lift crosses it.
+    x.env.ceiling_z_m = 3.2 - (f0.safety.clearance_top_m - cfg.warn_threshold_m - 5e-6);
+    REQUIRE_FALSE(c->step(x).search_reused);  // new geometry
+    REQUIRE(c->step(x).search_reused);
+    x.lift_pos_m += 1e-5;
+    const auto w = c->step(x);
+    REQUIRE(w.safety.level == SafetyLevel::WARN);
+    REQUIRE_FALSE(w.search_reused);
+    REQUIRE(c->step(x).search_reused);
+
+    // Callback environments are opaque and always search.
+    const double ceiling = *x.env.ceiling_z_m;
+    x.env.ceiling_z_m.reset();
+    x.env.ceiling_z_at_x_m = [ceiling](double) { return ceiling; };
+    REQUIRE_FALSE(c->step(x).search_reused);
+    REQUIRE_FALSE(c->step(x).search_reused);
+
+    // A config change between two identical inputs searches again under the new config, whether it is
+    // edited through config() or applied with configure().
+    ControlInput y = in;
+    REQUIRE_FALSE(c->step(y).search_reused);
+    REQUIRE(c->step(y).search_reused);
+    c->config().search_lift_half_range_m = 0.01;
+    c->config().w_dl = 1000.0;
+    const auto g = c->step(y);
+    REQUIRE_FALSE(g.search_reused);
+    REQUIRE(g.candidates_evaluated > 1);
+    REQUIRE(std::abs(g.cmd.lift_target_m - y.lift_pos_m) <= 0.01 + 1e-12);
+    REQUIRE(c->step(y).search_reused);
+    ControllerConfig changed = c->config();
+    changed.w_dl = 2.0;
+    REQUIRE(c->configure(changed));
+    REQUIRE_FALSE(c->step(y).search_reused);
+  }
+}
+
+TEST_CASE("ControllerMPC warm start seeds from the previous plan") {
+  ControllerConfig cfg;
+  cfg.mpc_warm_start = true;
+  cfg.mpc_beam_width = 8;
+  cfg.mpc_assumed_forward_speed_m_s = 0.1;
+  ControllerMPC c(cfg);
+
+  ControlInput in;
+  in.lift_pos_m = 0.10;
+  in.env.floor_z_m = 0.0;
+  in.env.ceiling_z_m = 2.5;
+  in.rack.height_m = 2.3;
+  in.rack.length_m = 2.3;
+  in.rack.mount_offset_m = {0.0, 0.0};
+
+  const auto f0 = c.step(in);
+  REQUIRE(f0.had_feasible_solution);
+  REQUIRE_FALSE(f0.warm_start_used);
+
+  for (int k = 0; k < 5; ++k) {
+    in.lift_pos_m = f0.cmd.lift_target_m;
+    const auto f = c.step(in);
+    REQUIRE(f.had_feasible_solution);
+    REQUIRE(f.warm_start_used);
+  }
+
+  c.reset();
+  REQUIRE_FALSE(c.step(in).warm_start_used);
+
+  c.config().mpc_warm_start = false;
+  c.step(in);
+  REQUIRE_FALSE(c.step(in).warm_start_used);
+}
+
+TEST_CASE("ControllerMPC parallel expansion matches the serial path") {
+  ControllerConfig cfg;
+  cfg.mpc_horizon_steps = 6;
+  cfg.mpc_beam_width = 30;
+  cfg.mpc_warm_start = true;
+  cfg.mpc_assumed_forward_speed_m_s = 0.2;
+  cfg.lookahead_s_m = 0.1;
+
+  ControllerConfig cfg_par = cfg;
+  cfg_par.mpc_num_threads = 4;
+
+  ControllerMPC serial(cfg);
+  ControllerMPC parallel(cfg_par);
+
+  ControlInput in;
+  in.lift_pos_m = 0.10;
+  in.pitch_rate_rad_s = 0.01;
+  in.env.floor_z_m = 0.0;
+  in.env.ceiling_z_m = 2.6;
+  in.rack.height_m = 2.3;
+  in.rack.length_m = 2.3;
+  in.rack.mount_offset_m = {0.0, 0.0};
+
+  for (int k = 0; k < 30; ++k) {
+    ControlOutput a;
+    ControlOutput b;
+    serial.step(in, a);
+    parallel.step(in, b);
+
+    REQUIRE(a.cmd.lift_target_m == b.cmd.lift_target_m);
+    REQUIRE(a.cmd.tilt_target_rad == b.cmd.tilt_target_rad);
+    REQUIRE(a.cmd.speed_limit_m_s == b.cmd.speed_limit_m_s);
+    REQUIRE(a.selected_cost == b.selected_cost);
+    REQUIRE(a.candidates_evaluated == b.candidates_evaluated);
+    REQUIRE(a.warm_start_used == b.warm_start_used);
+
+    in.lift_pos_m = a.cmd.lift_target_m;
+    in.tilt_rad = a.cmd.tilt_target_rad;
+    in.pitch_rad += 0.002;
+    in.s_m += 0.004;
+  }
+}
+
+TEST_CASE("ControllerMPC duplicate-state pruning evaluates each lattice point once") {
+  ControllerConfig cfg;
+  cfg.mpc_horizon_steps = 8;
+  cfg.mpc_beam_width = 40;
+  cfg.mpc_assumed_forward_speed_m_s = 0.2;
+
+  ControlInput in;
+  in.lift_pos_m = 0.10;
+  in.env.floor_z_m = 0.0;
+  in.env.ceiling_z_m = 2.6;
+  in.rack.height_m = 2.3;
+  in.rack.length_m = 2.3;
+  in.rack.mount_offset_m = {0.0, 0.0};
+
+  ControllerMPC plain(cfg);
+  const auto f_plain = plain.step(in);
+  REQUIRE(f_plain.had_feasible_solution);
+  REQUIRE(f_plain.mpc_nodes_deduplicated == 0);
+  REQUIRE(f_plain.mpc_nodes_expanded == f_plain.candidates_evaluated);
+
+  cfg.mpc_dedup_states = true;
+  ControllerMPC dedup(cfg);
+  const auto f_dedup = dedup.step(in);
+  REQUIRE(f_dedup.had_feasible_solution);
+  REQUIRE(f_dedup.mpc_nodes_deduplicated > 0);
+  REQUIRE(f_dedup.candidates_evaluated < f_plain.candidates_evaluated / 2);
+  REQUIRE(std::abs(f_dedup.cmd.lift_target_m - f_plain.cmd.lift_target_m) <= cfg.base_lift_rate_limit_m_s * in.dt_s + 1e-12);
+
+  // Parallel expansion stays identical with deduplication enabled.
+  cfg.mpc_num_threads = 3;
+  ControllerMPC dedup_par(cfg);
+  const auto f_par = dedup_par.step(in);
+  REQUIRE(f_par.cmd.lift_target_m == f_dedup.cmd.lift_target_m);
+  REQUIRE(f_par.cmd.tilt_target_rad == f_dedup.cmd.tilt_target_rad);
+  REQUIRE(f_par.selected_cost == f_dedup.selected_cost);
+  REQUIRE(f_par.candidates_evaluated == f_dedup.candidates_evaluated);
+  REQUIRE(f_par.mpc_nodes_deduplicated == f_dedup.mpc_nodes_deduplicated);
+}
+
+TEST_CASE("Exact clearance cache leaves ControllerMPC decisions unchanged") {
+  ControllerConfig cfg;
+  cfg.mpc_horizon_steps = 6;
+  cfg.mpc_beam_width = 30;
+  cfg.lookahead_s_m = 0.1;
+
+  ControllerConfig cfg_cached = cfg;
+  cfg_cached.clearance_cache_capacity = 4096;
+  cfg_cached.clearance_cache_across_steps = true;
+
+  ControllerMPC plain(cfg);
+  ControllerMPC cached(cfg_cached);
+
+  ControlInput in;
+  in.lift_pos_m = 0.10;
+  in.env.floor_z_m = 0.0;
+  in.env.ceiling_z_m = 2.6;
+  in.rack.height_m = 2.3;
+  in.rack.length_m = 2.3;
+  in.rack.mount_offset_m = {0.0, 0.0};
+
+  int hits = 0;
+  for (int k = 0; k < 5; ++k) {
+    const auto a = plain.step(in);
+    const auto b = cached.step(in);
+    REQUIRE(a.cmd.lift_target_m == b.cmd.lift_target_m);
+    REQUIRE(a.cmd.tilt_target_rad == b.cmd.tilt_target_rad);
+    REQUIRE(a.selected_cost == b.selected_cost);
+    REQUIRE(a.safety.clearance_top_m == b.safety.clearance_top_m);
+    hits += b.clearance_cache_hits;
+  }
+  REQUIRE(hits > 0);
+  REQUIRE(cached.clearanceCache().hits() == static_cast<std::uint64_t>(hits));
+}
+
+TEST_CASE("A quantizing clearance cache never approximates the current pose") {
+  ControllerConfig cfg;
+  cfg.lookahead_s_m = 0.1;
+  cfg.mpc_horizon_steps = 4;
+  cfg.mpc_beam_width = 20;
+
+  ControllerConfig cfg_cached = cfg;
+  cfg_cached.clearance_cache_capacity = 4096;
+  cfg_cached.clearance_cache_quantum_m = 0.5;  // coarse enough that every lift below lands on one key
+  cfg_cached.clearance_cache_quantum_rad = 0.5;
+  cfg_cached.clearance_cache_across_steps = true;
+
+  ControlInput in;
+  in.env.floor_z_m = 0.0;
+  in.env.ceiling_z_m = 2.6;
+  in.rack.height_m = 2.3;
+  in.rack.length_m = 2.3;
+  in.rack.mount_offset_m = {0.0, 0.0};
+
+  Controller plain(cfg);
+  Controller cached(cfg_cached);
+  ControllerMPC plain_mpc(cfg);
+  ControllerMPC cached_mpc(cfg_cached);
+  for (double lift : {0.10, 0.20, 0.05}) {
+    in.lift_pos_m = lift;
+    const auto a = plain.step(in);
+    const auto b = cached.step(in);
+    REQUIRE(b.safety.clearance_top_m == a.safety.clearance_top_m);
+    REQUIRE(b.safety.clearance_bottom_m == a.safety.clearance_bottom_m);
+    REQUIRE(b.safety.level == a.safety.level);
+
+    const auto c = plain_mpc.step(in);
+    const auto d = cached_mpc.step(in);
+    REQUIRE(d.safety.clearance_top_m == c.safety.clearance_top_m);
+    REQUIRE(d.safety.clearance_bottom_m == c.safety.clearance_bottom_m);
+    REQUIRE(d.safety.level == c.safety.level);
+  }
+}
+
+TEST_CASE("Step time budget cuts the search short and matches the unlimited search when met") {
+  const sim::Scenario sc = sim::dockingDemoScenario();
+
+  // A budget that is never reached selects exactly what the unlimited search selects, including the
+  // row-by-row fallback grid.
+  for (ControllerKind kind : {ControllerKind::MPC, ControllerKind::GridSearch}) {
+    ControllerConfig cfg = sim::dockingDemoConfig(kind);
+    cfg.search_mode = SearchMode::CoarseToFine;  // grid only
+    cfg.local_refine_iterations = 2;
+    ControllerConfig budget_cfg = cfg;
+    budget_cfg.step_time_budget_us = 1000000000;
+    std::vector<DebugFrame> ref, got;
+    const auto unlimited = makeController(kind, cfg);
+    const auto budgeted = makeController(kind, budget_cfg);
+    sim::runScenario(*unlimited, sc, [&](const DebugFrame& f) { ref.push_back(f); });
+    sim::runScenario(*budgeted, sc, [&](const DebugFrame& f) { got.push_back(f); });
+    REQUIRE(got.size() == ref.size());
+    for (size_t k = 0; k < ref.size(); ++k) {
+      REQUIRE_FALSE(got[k].budget_exhausted);
+      REQUIRE(got[k].cmd.lift_target_m == ref[k].cmd.lift_target_m);
+      REQUIRE(got[k].cmd.tilt_target_rad == ref[k].cmd.tilt_target_rad);
+      REQUIRE(got[k].selected_cost == ref[k].selected_cost);
+      REQUIRE(got[k].candidates_evaluated == ref[k].candidates_evaluated);
+    }
+  }
+
+  // No feasible horizon: the fallback grid runs, row by row when budgeted.
+  ControlInput tight;
+  tight.lift_pos_m = 0.10;
+  tight.env.floor_z_m = 0.0;
+  tight.env.ceiling_z_m = 2.35;
+  tight.rack.height_m = 2.3;
+  tight.rack.length_m = 2.3;
+  const ControllerConfig mpc_cfg = sim::dockingDemoConfig(ControllerKind::MPC);
+  {
+    ControllerConfig cfg = mpc_cfg;
+    ControllerMPC unlimited(cfg);
+    cfg.step_time_budget_us = 1000000000;
+    ControllerMPC budgeted(cfg);
+    const auto r = unlimited.step(tight);
+    const auto g = budgeted.step(tight);
+    REQUIRE_FALSE(r.had_feasible_solution);
+    REQUIRE(g.cmd.lift_target_m == r.cmd.lift_target_m);
+    REQUIRE(g.cmd.tilt_target_rad == r.cmd.tilt_target_rad);
+  }
+
+  // A 1 us budget: the first horizon level still completes and the current-pose safety is unchanged.
+  ControllerConfig deep = mpc_cfg;
+  deep.mpc_horizon_steps = 12;
+  deep.mpc_beam_width = 120;
+  ControllerMPC unlimited(deep);
+  deep.step_time_budget_us = 1;
+  ControllerMPC budgeted(deep);
+  ControlInput in;
+  in.lift_pos_m = 0.10;
+  in.env.floor_z_m = 0.0;
+  in.env.ceiling_z_m = 2.6;
+  in.rack.height_m = 2.3;
+  in.rack.length_m = 2.3;
+  const auto r = unlimited.step(in);
+  const auto g = budgeted.step(in);
+  REQUIRE(g.budget_exhausted);
+  REQUIRE(g.had_feasible_solution);
+  REQUIRE(g.candidates_evaluated * 4 < r.candidates_evaluated);
+  REQUIRE(g.safety.level == r.safety.level);
+  REQUIRE(g.safety.clearance_top_m == r.safety.clearance_top_m);
+  REQUIRE(g.cmd.speed_limit_m_s == r.cmd.speed_limit_m_s);
+  REQUIRE(budgeted.instrumentation().snapshot().budget_exhausted_steps == 1);
+}
+
+TEST_CASE("configure() validates and precomputes; warmup() leaves no trace") {
+  ControllerConfig bad;
+  bad.base_lift_rate_limit_m_s = 0.0;
+  std::string error;
+  REQUIRE_FALSE(validateConfig(bad, &error));
+  REQUIRE(error.find("base_lift_rate_limit_m_s") != std::string::npos);
+  bad = ControllerConfig{};
+  bad.margin_top_m = std::nan("");
+  REQUIRE_FALSE(validateConfig(bad));
+  bad = ControllerConfig{};
+  bad.coarse_grid_steps = 3;  // the CoarseToFine window would never narrow
+  REQUIRE_FALSE(validateConfig(bad, &error));
+  REQUIRE(error.find("coarse_grid_steps") != std::string::npos);
+  bad = ControllerConfig{};
+  bad.local_refine_evals = 1;  // each line search evaluates two points regardless
+  REQUIRE_FALSE(validateConfig(bad, &error));
+  REQUIRE(error.find("local_refine_evals") != std::string::npos);
+  REQUIRE(validateConfig(ControllerConfig{}));
+
+  // Precomputed limits match the per-input derivation, nominal and degraded.
+  ControllerConfig cfg;
+  cfg.lookahead_s_m = 0.3;
+  ConfigTables tables;
+  makeConfigTables(cfg, &tables);
+  ControlInput in;
+  in.lift_pos_m = 0.40;
+  in.env.floor_z_m = 0.0;
+  in.env.ceiling_z_m = 2.8;
+  in.rack.height_m = 2.3;
+  in.rack.length_m = 2.3;
+  ControlInput jitter = in;
+  jitter.pitch_rate_rad_s = 2.0 * cfg.pitch_rate_jitter_threshold_rad_s;
+  for (const ControlInput& x : {in, jitter}) {
+    const StepLimits a = makeStepLimits(tables, x);
+    const StepLimits b = makeStepLimits(cfg, x);
+    REQUIRE(a.degraded == b.degraded);
+    REQUIRE(a.margin_top_m == b.margin_top_m);
+    REQUIRE(a.lift_rate_limit_m_s == b.lift_rate_limit_m_s);
+    REQUIRE(a.speed_mult == b.speed_mult);
+    REQUIRE(a.s_look_m == b.s_look_m);
+  }
+  std::vector<double> direct;
+  std::vector<double> from_tables;
+  fillAxis(direct, tables.grid_lift_steps, -0.12, 0.31);
+  fillAxis(from_tables, tables.grid_lift_t, -0.12, 0.31);
+  REQUIRE(direct == from_tables);
+
+  ControllerConfig tuned = sim::dockingDemoConfig(ControllerKind::MPC);
+  tuned.search_mode = SearchMode::CoarseToFine;
+  for (ControllerKind kind : {ControllerKind::GridSearch, ControllerKind::MPC}) {
+    auto fresh = makeController(kind, tuned);
+    auto c = makeController(kind, ControllerConfig{});
+    REQUIRE_FALSE(c->configure(bad, &error));
+    REQUIRE(c->config().margin_top_m == ControllerConfig{}.margin_top_m);  // rejected: unchanged
+    REQUIRE(c->configure(tuned));
+    c->warmup(in);
+    REQUIRE(c->instrumentation().snapshot().step_latency_ns.count == 0);
+
+    // After configure() + warmup() the controller decides exactly like a freshly constructed one.
+    ControlInput x = in;
+    for (int k = 0; k < 10; ++k) {
+      const auto f = c->step(x);
+      const auto r = fresh->step(x);
+      REQUIRE(f.time_s == r.time_s);
+      REQUIRE(f.cmd.lift_target_m == r.cmd.lift_target_m);
+      REQUIRE(f.cmd.tilt_target_rad == r.cmd.tilt_target_rad);
+      REQUIRE(f.cmd.speed_limit_m_s == r.cmd.speed_limit_m_s);
+      x.s_m += 0.01;
+      x.lift_pos_m = f.cmd.lift_target_m;
+      x.tilt_rad = f.cmd.tilt_target_rad;
+    }
+
+    // Edits through config() are applied on the next step.
+    c->config().base_lift_rate_limit_m_s = 0.05;
+    const auto f = c->step(x);
+    REQUIRE(f.cmd.lift_rate_limit_m_s == 0.05);
+  }
+}
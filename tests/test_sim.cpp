@@ -0,0 +1,120 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "sim/BackgroundSim.hpp"
+#include "sim/Simulation.hpp"
+
+using namespace tlf;
+using namespace tlf::sim;
+
+static void requireSameSummary(const RunSummary& a, const RunSummary& b) {
+  REQUIRE(a.steps == b.steps);
+  REQUIRE(a.completed == b.completed);
+  REQUIRE(a.time_to_door_s == b.time_to_door_s);
+  REQUIRE(a.time_to_end_s == b.time_to_end_s);
+  REQUIRE(a.min_clearance_top_m == b.min_clearance_top_m);
+  REQUIRE(a.min_clearance_bottom_m == b.min_clearance_bottom_m);
+  REQUIRE(a.warn_steps == b.warn_steps);
+  REQUIRE(a.stop_steps == b.stop_steps);
+}
+
+static std::vector<Scenario> sampleScenarios(int n) {
+  Scenario base = dockingDemoScenario();
+  base.max_steps = 300;
+  base.start_s_m = -1.5;
+  std::vector<Scenario> out;
+  for (int i = 0; i < n; ++i) out.push_back(randomizedScenario(base, ScenarioSpread{}, 100 + static_cast<std::uint64_t>(i)));
+  out.push_back(vizRampScenario());
+  return out;
+}
+
+TEST_CASE("randomizedScenario is deterministic in the seed") {
+  const Scenario base = dockingDemoScenario();
+  const Scenario a = randomizedScenario(base, ScenarioSpread{}, 7);
+  const Scenario b = randomizedScenario(base, ScenarioSpread{}, 7);
+  const Scenario c = randomizedScenario(base, ScenarioSpread{}, 8);
+  REQUIRE(a.env.ramp_slope_deg == b.env.ramp_slope_deg);
+  REQUIRE(a.rack.height_m == b.rack.height_m);
+  REQUIRE(a.base_speed_m_s == b.base_speed_m_s);
+  REQUIRE(a.env.ramp_slope_deg != c.env.ramp_slope_deg);
+
+  const Scenario same = randomizedScenario(base, ScenarioSpread{0, 0, 0, 0, 0, 0, 0, 0}, 7);
+  REQUIRE(same.env.ramp_slope_deg == base.env.ramp_slope_deg);
+  REQUIRE(same.rack.height_m == base.rack.height_m);
+}
+
+TEST_CASE("BatchSim lockstep lanes match independent runScenario runs") {
+  const auto scenarios = sampleScenarios(5);
+  for (auto kind : {ControllerKind::GridSearch, ControllerKind::MPC}) {
+    const ControllerConfig cfg = dockingDemoConfig(kind);
+    BatchSim batch(kind, cfg, scenarios);
+    REQUIRE(batch.lanes() == scenarios.size());
+    batch.run();
+    REQUIRE(batch.activeLanes() == 0);
+
+    for (std::size_t i = 0; i < scenarios.size(); ++i) {
+      auto c = makeController(kind, cfg);
+      requireSameSummary(batch.summary(i), runScenario(*c, scenarios[i]));
+    }
+  }
+}
+
+TEST_CASE("runScenarios gives the same results for any threading and batching") {
+  const auto scenarios = sampleScenarios(7);
+  const ControllerConfig cfg = dockingDemoConfig(ControllerKind::GridSearch);
+  const auto serial = runScenarios(ControllerKind::GridSearch, cfg, scenarios, 1, scenarios.size());
+  const auto parallel = runScenarios(ControllerKind::GridSearch, cfg, scenarios, 3, 2);
+  REQUIRE(serial.size() == scenarios.size());
+  REQUIRE(parallel.size() == scenarios.size());
+  for (std::size_t i = 0; i < scenarios.size(); ++i) requireSameSummary(serial[i], parallel[i]);
+}
+
+TEST_CASE("runScenario reports every frame it steps") {
+  auto c = makeController(ControllerKind::GridSearch, ControllerConfig{});
+  int frames = 0;
+  double last_s = 0.0;
+  const Scenario sc = vizRampScenario();
+  const RunSummary r = runScenario(*c, sc, [&](const DebugFrame& f) {
+    ++frames;
+    last_s = f.in.s_m;
+  });
+  REQUIRE(frames == r.steps);
+  REQUIRE(r.steps <= sc.max_steps);
+  REQUIRE(last_s > sc.start_s_m);
+}
+
+TEST_CASE("BackgroundSim streams the frames of the latest run only") {
+  const ControllerConfig cfg = dockingDemoConfig(ControllerKind::GridSearch);
+  Scenario sc = dockingDemoScenario();
+  sc.max_steps = 200;
+  auto c = makeController(ControllerKind::GridSearch, cfg);
+  const RunSummary expected = runScenario(*c, sc);
+
+  BackgroundSim bg;
+  std::vector<LogRecord> frames;
+  REQUIRE(bg.takeFrames(&frames) == 0);
+
+  // A run superseded right away must not leak frames into its successor.
+  const auto stale = bg.start(ControllerKind::GridSearch, cfg, sc);
+  const auto gen = bg.start(ControllerKind::GridSearch, cfg, sc);
+  REQUIRE(gen > stale);
+
+  std::uint64_t seen = 0;
+  for (;;) {
+    const bool done = !bg.running();
+    seen = bg.takeFrames(&frames);
+    if (done) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  REQUIRE(seen == gen);
+  REQUIRE(static_cast<int>(frames.size()) == expected.steps);
+  for (std::size_t i = 1; i < frames.size(); ++i) REQUIRE(frames[i].time_s > frames[i - 1].time_s);
+
+  bg.cancel();
+  frames.clear();
+  REQUIRE(bg.takeFrames(&frames) > gen);
+  REQUIRE(frames.empty());
+}
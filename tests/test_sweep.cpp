@@ -0,0 +1,87 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "sim/Sweep.hpp"
+
+using namespace tlf;
+using namespace tlf::sim;
+
+TEST_CASE("setConfigField writes named ControllerConfig fields") {
+  ControllerConfig cfg;
+  REQUIRE(setConfigField(&cfg, "margin_top_m", 0.2));
+  REQUIRE(cfg.margin_top_m == 0.2);
+  REQUIRE(setConfigField(&cfg, "mpc_beam_width", 79.6));
+  REQUIRE(cfg.mpc_beam_width == 80);
+  REQUIRE(setConfigField(&cfg, "grid_steps", 15));
+  REQUIRE(cfg.grid_lift_steps == 15);
+  REQUIRE(cfg.grid_tilt_steps == 15);
+  REQUIRE_FALSE(setConfigField(&cfg, "no_such_field", 1.0));
+}
+
+TEST_CASE("paretoFront keeps only non-dominated points") {
+  auto point = [](bool done, double t, double clear, int stops, double lat) {
+    SweepPoint p;
+    p.summary.completed = done;
+    p.summary.time_to_end_s = t;
+    p.summary.min_clearance_top_m = clear;
+    p.summary.min_clearance_bottom_m = clear;
+    p.summary.stop_steps = stops;
+    p.mean_step_latency_us = lat;
+    return p;
+  };
+  const std::vector<SweepPoint> pts = {
+      point(true, 100.0, 0.05, 0, 10.0),   // 0: front
+      point(true, 120.0, 0.10, 0, 10.0),   // 1: front (safer, slower)
+      point(true, 130.0, 0.05, 0, 10.0),   // 2: dominated by 0
+      point(false, 0.0, 0.20, 0, 1.0),     // 3: front (incomplete, but larger clearance and cheaper)
+      point(true, 100.0, 0.05, 2, 10.0),   // 4: dominated by 0
+  };
+  auto front = paretoFront(pts);
+  std::sort(front.begin(), front.end());
+  REQUIRE(front == std::vector<std::size_t>{0, 1, 3});
+}
+
+TEST_CASE("runSweep evaluates the cartesian product in parallel") {
+  Scenario sc;
+  sc.max_steps = 40;
+  const std::vector<SweepAxis> axes = {{"grid_steps", {5, 9}}, {"margin_top_m", {0.08, 0.12, 0.16}}};
+  const auto pts = runSweep(ControllerKind::GridSearch, dockingDemoConfig(ControllerKind::GridSearch), sc, axes, 3);
+  REQUIRE(pts.size() == 6);
+  REQUIRE(pts[0].values == std::vector<double>{5, 0.08});
+  REQUIRE(pts[5].values == std::vector<double>{9, 0.16});
+
+  // Same combination run serially gives the same summary.
+  ControllerConfig cfg = dockingDemoConfig(ControllerKind::GridSearch);
+  setConfigField(&cfg, "grid_steps", 9);
+  setConfigField(&cfg, "margin_top_m", 0.12);
+  auto c = makeController(ControllerKind::GridSearch, cfg);
+  const auto serial = runScenario(*c, sc);
+  REQUIRE(pts[4].summary.steps == serial.steps);
+  REQUIRE(pts[4].summary.min_clearance_top_m == serial.min_clearance_top_m);
+  REQUIRE(pts[4].summary.stop_steps == serial.stop_steps);
+}
+
+TEST_CASE("runSweep skips combinations validateConfig rejects") {
+  Scenario sc;
+  sc.max_steps = 10;
+  ControllerConfig base = dockingDemoConfig(ControllerKind::GridSearch);
+  base.search_mode = SearchMode::CoarseToFine;
+  const std::vector<SweepAxis> axes = {{"coarse_grid_steps", {3, 5}}};
+  const auto pts = runSweep(ControllerKind::GridSearch, base, sc, axes, 2);
+  REQUIRE(pts.size() == 2);
+  REQUIRE_FALSE(pts[0].valid());
+  REQUIRE(pts[0].invalid.find("coarse_grid_steps") != std::string::npos);
+  REQUIRE(pts[0].summary.steps == 0);  // never ran
+  REQUIRE(pts[1].valid());
+  REQUIRE(pts[1].summary.steps > 0);
+
+  // Even a point that would dominate stays off the front while invalid.
+  std::vector<SweepPoint> front_pts = pts;
+  front_pts[0].summary.completed = true;
+  front_pts[0].summary.time_to_end_s = 0.0;
+  front_pts[0].summary.min_clearance_top_m = front_pts[0].summary.min_clearance_bottom_m = 10.0;
+  REQUIRE(paretoFront(front_pts) == std::vector<std::size_t>{1});
+}
@@ -0,0 +1,150 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/TelemetryServer.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace tlf;
+
+TEST_CASE("logRecordToJson uses the CSV column names") {
+  LogRecord r;
+  r.time_s = 1.5;
+  r.s_m = -0.25;
+  r.safety_level = 2;
+  r.clearance_top_m = std::numeric_limits<double>::quiet_NaN();
+  const std::string json = logRecordToJson(r);
+  REQUIRE(json.front() == '{');
+  REQUIRE(json.back() == '}');
+  REQUIRE(json.find("\"time\":1.5,") != std::string::npos);
+  REQUIRE(json.find("\"s\":-0.25,") != std::string::npos);
+  REQUIRE(json.find("\"safety_level\":2,") != std::string::npos);
+  REQUIRE(json.find("\"clearance_top\":null,") != std::string::npos);
+  REQUIRE(json.find("\"worst_point_id\":0}") != std::string::npos);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST_CASE("WebSocketTelemetrySink handshakes and publishes decimated frames") {
+  TelemetryOptions opt;
+  opt.port = 0;
+  opt.decimation = 2;
+  WebSocketTelemetrySink sink(opt);
+  REQUIRE(sink.good());
+  REQUIRE(sink.port() != 0);
+
+  const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  REQUIRE(fd >= 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(sink.port());
+  ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  REQUIRE(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+
+  // Sample key and accept value from RFC 6455, section 1.3.
+  const std::string request =
+      "GET / HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+      "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+  REQUIRE(::send(fd, request.data(), request.size(), 0) == static_cast<ssize_t>(request.size()));
+
+  // Services the sink and reads from the client socket until done() holds.
+  std::string received;
+  auto pumpUntil = [&](auto done) {
+    for (int i = 0; i < 2000 && !done(); ++i) {
+      sink.flush();
+      char buf[4096];
+      const ssize_t n = ::recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+      if (n > 0) received.append(buf, static_cast<std::size_t>(n));
+      else std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  };
+  pumpUntil([&] { return received.find("\r\n\r\n") != std::string::npos; });
+  REQUIRE(received.rfind("HTTP/1.1 101", 0) == 0);
+  REQUIRE(received.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n") != std::string::npos);
+  REQUIRE(sink.clients() == 1);
+  received.erase(0, received.find("\r\n\r\n") + 4);
+
+  for (int i = 0; i < 10; ++i) {
+    LogRecord r;
+    r.time_s = i;
+    sink.writeRecord(r);
+  }
+  REQUIRE(sink.framesSent() == 5);
+
+  // Unmasked text frames; every payload is < 126 bytes or uses the 16-bit length form.
+  std::vector<std::string> payloads;
+  auto parse = [&] {
+    payloads.clear();
+    std::size_t pos = 0;
+    while (received.size() - pos >= 2) {
+      const auto* p = reinterpret_cast<const unsigned char*>(received.data() + pos);
+      REQUIRE(p[0] == 0x81);
+      std::size_t len = p[1] & 0x7F, hdr = 2;
+      if (len == 126) {
+        if (received.size() - pos < 4) break;
+        len = (std::size_t(p[2]) << 8) | p[3];
+        hdr = 4;
+      }
+      if (received.size() - pos < hdr + len) break;
+      payloads.push_back(received.substr(pos + hdr, len));
+      pos += hdr + len;
+    }
+    return payloads.size() == 5;
+  };
+  pumpUntil(parse);
+  REQUIRE(payloads.size() == 5);
+  REQUIRE(payloads[0].find("\"time\":0,") != std::string::npos);
+  REQUIRE(payloads[4].find("\"time\":8,") != std::string::npos);
+
+  ::close(fd);
+  pumpUntil([&] { return sink.clients() == 0; });
+  REQUIRE(sink.clients() == 0);
+}
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST_CASE("WebSocketTelemetrySink disconnects clients that send oversized frames") {
+  TelemetryOptions opt;
+  opt.port = 0;
+  WebSocketTelemetrySink sink(opt);
+  REQUIRE(sink.good());
+
+  const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  REQUIRE(fd >= 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(sink.port());
+  ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  REQUIRE(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+  const std::string request =
+      "GET / HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+      "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+  REQUIRE(::send(fd, request.data(), request.size(), 0) == static_cast<ssize_t>(request.size()));
+  for (int i = 0; i < 2000 && sink.clients() == 0; ++i) {
+    sink.flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  REQUIRE(sink.clients() == 1);
+
+  // A masked binary frame header declaring a 1 MiB payload (64-bit length form): never buffered.
+  std::string header = {static_cast<char>(0x82), static_cast<char>(0xFF)};
+  for (int i = 0; i < 8; ++i) header.push_back(static_cast<char>(i == 5 ? 0x10 : 0x00));
+  header.append(4, '\x01');  // masking key
+  REQUIRE(::send(fd, header.data(), header.size(), 0) == static_cast<ssize_t>(header.size()));
+  for (int i = 0; i < 2000 && sink.clients() != 0; ++i) {
+    sink.flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  REQUIRE(sink.clients() == 0);
+  ::close(fd);
+}
+#endif
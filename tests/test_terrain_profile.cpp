@@ -0,0 +1,77 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+#include <cmath>
+#include <memory>
+
+#include "model/Geometry.hpp"
+#include "model/TerrainProfile.hpp"
+
+using namespace tlf;
+
+TEST_CASE("PiecewiseLinear interpolates, clamps and steps") {
+  // Ramp from (-2, -0.2) to (0, 0), then a 0.1 m step up at x=1.
+  const PiecewiseLinear pl({-2.0, 0.0, 1.0, 1.0}, {-0.2, 0.0, 0.0, 0.1});
+  REQUIRE(pl.valid());
+
+  REQUIRE(pl.zAtX(-5.0) == Catch::Approx(-0.2));
+  REQUIRE(pl.zAtX(-1.0) == Catch::Approx(-0.1));
+  REQUIRE(pl.zAtX(0.5) == Catch::Approx(0.0));
+  REQUIRE(pl.zAtX(1.0) == Catch::Approx(0.1));
+  REQUIRE(pl.zAtX(9.0) == Catch::Approx(0.1));
+
+  // Queries in non-monotonic order must not depend on the cached segment.
+  REQUIRE(pl.zAtX(-1.5) == Catch::Approx(-0.15));
+  REQUIRE(pl.zAtX(0.99) == Catch::Approx(0.0));
+  REQUIRE(pl.zAtX(-1.5) == Catch::Approx(-0.15));
+
+  REQUIRE_FALSE(PiecewiseLinear({0.0, -1.0}, {0.0, 0.0}).valid());
+  REQUIRE_FALSE(PiecewiseLinear({0.0}, {0.0, 1.0}).valid());
+}
+
+TEST_CASE("TerrainProfile clearances match equivalent callbacks") {
+  const double ramp_len = 2.5;
+  const double h = std::tan(4.0 * M_PI / 180.0) * ramp_len;
+
+  auto floorFn = [&](double x) {
+    if (x <= -ramp_len) return -h;
+    if (x < 0.0) return -h * (-x / ramp_len);
+    return 0.0;
+  };
+
+  EnvironmentGeometry cb;
+  cb.floor_z_at_x_m = floorFn;
+  cb.ceiling_z_at_x_m = [](double) { return 2.5; };
+
+  auto profile = std::make_shared<TerrainProfile>();
+  profile->floor = PiecewiseLinear({-ramp_len, 0.0}, {-h, 0.0});
+  profile->ceiling = PiecewiseLinear(2.5);
+
+  EnvironmentGeometry env;
+  env.profile = profile;
+
+  RackParams rack;
+  rack.height_m = 2.3;
+  rack.length_m = 2.2;
+  rack.mount_offset_m = {0.25, 0.0};
+
+  ForkliftParams fl;
+  fl.mast_pivot_height_m = 0.15;
+
+  for (double s = -3.5; s <= 1.0; s += 0.37) {
+    const auto c_cb = computeRackCorners2D(s, 0.02, 0.05, -0.03, cb, rack, fl);
+    const auto c_pr = computeRackCorners2D(s, 0.02, 0.05, -0.03, *profile, rack, fl);
+    const auto c_env = computeRackCorners2D(s, 0.02, 0.05, -0.03, env, rack, fl);
+
+    for (int i = 0; i < 4; ++i) {
+      REQUIRE(c_pr.p[i].z == Catch::Approx(c_cb.p[i].z).margin(1e-12));
+      REQUIRE(c_env.p[i].z == c_pr.p[i].z);
+    }
+
+    const auto r_cb = computeClearances(c_cb, cb, 0.04, 0.04);
+    const auto r_pr = computeClearances(c_pr, *profile, 0.04, 0.04);
+    REQUIRE(r_pr.clearance_top_m == Catch::Approx(r_cb.clearance_top_m).margin(1e-12));
+    REQUIRE(r_pr.clearance_bottom_m == Catch::Approx(r_cb.clearance_bottom_m).margin(1e-12));
+    REQUIRE(r_pr.worst_point == r_cb.worst_point);
+  }
+}